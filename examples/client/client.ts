@@ -1,6 +1,140 @@
+// Minimal MessagePack codec for the negotiated binary encoding
+// (nil, bool, int, float64, str, bin, array, map)
+const MsgPack = {
+    encode(value) {
+        const bytes = [];
+        const pushUint = (n, size) => {
+            for (let shift = (size - 1) * 8; shift >= 0; shift -= 8) {
+                bytes.push(Math.floor(n / 2 ** shift) & 0xff);
+            }
+        };
+        const write = (v) => {
+            if (v === null || v === undefined) {
+                bytes.push(0xc0);
+            } else if (typeof v === 'boolean') {
+                bytes.push(v ? 0xc3 : 0xc2);
+            } else if (typeof v === 'number') {
+                if (Number.isInteger(v) && v >= 0 && v <= 0xffffffff) {
+                    if (v < 0x80) bytes.push(v);
+                    else if (v <= 0xff) bytes.push(0xcc, v);
+                    else if (v <= 0xffff) { bytes.push(0xcd); pushUint(v, 2); }
+                    else { bytes.push(0xce); pushUint(v, 4); }
+                } else if (Number.isInteger(v) && v < 0 && v >= -0x80000000) {
+                    if (v >= -32) bytes.push(v & 0xff);
+                    else { bytes.push(0xd2); pushUint(v >>> 0, 4); }
+                } else {
+                    const view = new DataView(new ArrayBuffer(8));
+                    view.setFloat64(0, v);
+                    bytes.push(0xcb, ...new Uint8Array(view.buffer));
+                }
+            } else if (typeof v === 'string') {
+                const utf8 = new TextEncoder().encode(v);
+                if (utf8.length < 32) bytes.push(0xa0 | utf8.length);
+                else if (utf8.length <= 0xff) bytes.push(0xd9, utf8.length);
+                else if (utf8.length <= 0xffff) { bytes.push(0xda); pushUint(utf8.length, 2); }
+                else { bytes.push(0xdb); pushUint(utf8.length, 4); }
+                bytes.push(...utf8);
+            } else if (v instanceof Uint8Array) {
+                if (v.length <= 0xff) bytes.push(0xc4, v.length);
+                else if (v.length <= 0xffff) { bytes.push(0xc5); pushUint(v.length, 2); }
+                else { bytes.push(0xc6); pushUint(v.length, 4); }
+                bytes.push(...v);
+            } else if (Array.isArray(v)) {
+                if (v.length < 16) bytes.push(0x90 | v.length);
+                else if (v.length <= 0xffff) { bytes.push(0xdc); pushUint(v.length, 2); }
+                else { bytes.push(0xdd); pushUint(v.length, 4); }
+                v.forEach(write);
+            } else {
+                const keys = Object.keys(v).filter((k) => v[k] !== undefined);
+                if (keys.length < 16) bytes.push(0x80 | keys.length);
+                else if (keys.length <= 0xffff) { bytes.push(0xde); pushUint(keys.length, 2); }
+                else { bytes.push(0xdf); pushUint(keys.length, 4); }
+                keys.forEach((k) => { write(k); write(v[k]); });
+            }
+        };
+        write(value);
+        return new Uint8Array(bytes);
+    },
+
+    decode(buffer) {
+        const data = new Uint8Array(buffer);
+        const view = new DataView(data.buffer, data.byteOffset, data.byteLength);
+        let pos = 0;
+        const str = (len) => {
+            const s = new TextDecoder().decode(data.subarray(pos, pos + len));
+            pos += len;
+            return s;
+        };
+        const bin = (len) => {
+            const b = data.slice(pos, pos + len);
+            pos += len;
+            return b;
+        };
+        const array = (len) => {
+            const a = [];
+            for (let i = 0; i < len; i++) a.push(read());
+            return a;
+        };
+        const map = (len) => {
+            const m = {};
+            for (let i = 0; i < len; i++) {
+                const key = read();
+                m[key] = read();
+            }
+            return m;
+        };
+        const next = (size, getter) => {
+            const v = view[getter](pos);
+            pos += size;
+            return v;
+        };
+        const read = () => {
+            const type = data[pos++];
+            if (type < 0x80) return type;
+            if (type < 0x90) return map(type & 0x0f);
+            if (type < 0xa0) return array(type & 0x0f);
+            if (type < 0xc0) return str(type & 0x1f);
+            if (type >= 0xe0) return type - 0x100;
+            switch (type) {
+                case 0xc0: return null;
+                case 0xc2: return false;
+                case 0xc3: return true;
+                case 0xc4: return bin(next(1, 'getUint8'));
+                case 0xc5: return bin(next(2, 'getUint16'));
+                case 0xc6: return bin(next(4, 'getUint32'));
+                case 0xca: return next(4, 'getFloat32');
+                case 0xcb: return next(8, 'getFloat64');
+                case 0xcc: return next(1, 'getUint8');
+                case 0xcd: return next(2, 'getUint16');
+                case 0xce: return next(4, 'getUint32');
+                case 0xcf: return Number(next(8, 'getBigUint64'));
+                case 0xd0: return next(1, 'getInt8');
+                case 0xd1: return next(2, 'getInt16');
+                case 0xd2: return next(4, 'getInt32');
+                case 0xd3: return Number(next(8, 'getBigInt64'));
+                case 0xd9: return str(next(1, 'getUint8'));
+                case 0xda: return str(next(2, 'getUint16'));
+                case 0xdb: return str(next(4, 'getUint32'));
+                case 0xdc: return array(next(2, 'getUint16'));
+                case 0xdd: return array(next(4, 'getUint32'));
+                case 0xde: return map(next(2, 'getUint16'));
+                case 0xdf: return map(next(4, 'getUint32'));
+                default: throw new Error('Unsupported MessagePack type 0x' + type.toString(16));
+            }
+        };
+        return read();
+    }
+};
+
 class MCPClient {
-    constructor(url) {
+    constructor(url, options = {}) {
         this.url = url;
+        // 'msgpack' to ask the server for binary frames; JSON otherwise
+        this.preferredEncoding = options.encoding || 'json';
+        this.encoding = 'json';
+        // Ask the server to deflate large messages (needs DecompressionStream)
+        this.compression = options.compression !== false && typeof DecompressionStream !== 'undefined';
+        this.received = Promise.resolve();
         this.ws = null;
         this.requestId = 1;
         this.callbacks = new Map();
@@ -8,12 +142,17 @@ class MCPClient {
         this.reconnectAttempts = 0;
         this.maxReconnectAttempts = 5;
         this.reconnectDelay = 1000;
+        this.requestRetries = 1;       // Resends of a request that timed out
         this.heartbeatInterval = null;
+        this.rtt = null;               // Last ping round trip in ms
+        this.onLog = null;             // Called with (level, lines) after setLogLevel()
     }
     
     connect() {
         return new Promise((resolve, reject) => {
             this.ws = new WebSocket(this.url);
+            this.ws.binaryType = 'arraybuffer';
+            this.encoding = 'json';
             
             this.ws.onopen = () => {
                 console.log('Connected to MCP server');
@@ -23,12 +162,11 @@ class MCPClient {
             };
             
             this.ws.onmessage = (event) => {
-                try {
-                    const message = JSON.parse(event.data);
-                    this.handleMessage(message);
-                } catch (error) {
-                    console.error('Error parsing message:', error);
-                }
+                // Inflating is asynchronous; chain frames to keep their order
+                this.received = this.received
+                    .then(() => this.decodeFrame(event.data))
+                    .then((message) => this.handleMessage(message))
+                    .catch((error) => console.error('Error parsing message:', error));
             };
             
             this.ws.onclose = () => {
@@ -44,6 +182,24 @@ class MCPClient {
         });
     }
     
+    // Text frames are JSON and binary frames MessagePack, unless the first
+    // byte marks a deflated frame: 0x01 deflated JSON, 0x02 deflated MessagePack
+    async decodeFrame(data) {
+        if (typeof data === 'string') {
+            return JSON.parse(data);
+        }
+        const bytes = new Uint8Array(data);
+        if (bytes[0] !== 0x01 && bytes[0] !== 0x02) {
+            return MsgPack.decode(data);
+        }
+        const stream = new Blob([bytes.subarray(1)]).stream()
+            .pipeThrough(new DecompressionStream('deflate-raw'));
+        const inflated = await new Response(stream).arrayBuffer();
+        return bytes[0] === 0x01
+            ? JSON.parse(new TextDecoder().decode(inflated))
+            : MsgPack.decode(inflated);
+    }
+    
     disconnect() {
         if (this.ws) {
             this.ws.close();
@@ -52,14 +208,38 @@ class MCPClient {
     }
     
     async initialize() {
-        const response = await this.sendRequest('initialize', {});
+        const experimentalOffer = {};
+        if (this.preferredEncoding === 'msgpack') {
+            experimentalOffer.encodings = ['msgpack'];
+        }
+        if (this.compression) {
+            experimentalOffer.compression = ['deflate'];
+        }
+        const params = { capabilities: { experimental: experimentalOffer } };
+        const response = await this.sendRequest('initialize', params);
+        // The initialize response is JSON; the agreed encoding applies after it
+        const experimental = ((response.result || {}).capabilities || {}).experimental || {};
+        if (experimental.encoding === 'msgpack') {
+            this.encoding = 'msgpack';
+        }
         console.log('Server initialized:', response);
         return response;
     }
     
     async listResources() {
-        const response = await this.sendRequest('resources/list', {});
-        return response.result.data.resources;
+        return this.listAll('resources/list', 'resources');
+    }
+    
+    // Follows nextCursor until the server has returned every page
+    async listAll(method, key) {
+        const items = [];
+        let cursor;
+        do {
+            const response = await this.sendRequest(method, cursor ? { cursor } : {});
+            items.push(...response.result[key]);
+            cursor = response.result.nextCursor;
+        } while (cursor);
+        return items;
     }
     
     async readResource(uri) {
@@ -67,6 +247,26 @@ class MCPClient {
         return response.result.data;
     }
     
+    // Reads a binary resource chunk by chunk, following nextOffset
+    async readBlob(uri) {
+        const chunks = [];
+        let offset = 0;
+        do {
+            const response = await this.sendRequest('resources/read', { uri, offset });
+            const binary = atob(response.result.contents[0].blob);
+            chunks.push(Uint8Array.from(binary, (c) => c.charCodeAt(0)));
+            offset = response.result.nextOffset;
+        } while (offset !== undefined);
+        return new Blob(chunks);
+    }
+    
+    // Ask for the server's log lines at this level and above ('debug',
+    // 'info', 'warning', 'error'); they arrive through onLog
+    async setLogLevel(level, onLog) {
+        this.onLog = onLog;
+        await this.sendRequest('logging/setLevel', { level });
+    }
+    
     async subscribe(uri, callback) {
         const response = await this.sendRequest('resources/subscribe', { uri });
         if (response.result.success) {
@@ -98,16 +298,26 @@ class MCPClient {
                 id: id
             };
             
+            const frame = this.encoding === 'msgpack' ? MsgPack.encode(request) : JSON.stringify(request);
             this.callbacks.set(id, { resolve, reject });
-            this.ws.send(JSON.stringify(request));
+            this.ws.send(frame);
             
-            // Set timeout for request
-            setTimeout(() => {
-                if (this.callbacks.has(id)) {
-                    this.callbacks.delete(id);
-                    reject(new Error('Request timeout'));
+            // On timeout resend with the same id: the server answers a
+            // tools/call it already ran from its replay cache
+            let retries = 0;
+            const expire = () => {
+                if (!this.callbacks.has(id)) {
+                    return;
+                }
+                if (retries++ < this.requestRetries && this.ws.readyState === WebSocket.OPEN) {
+                    this.ws.send(frame);
+                    setTimeout(expire, 5000);
+                    return;
                 }
-            }, 5000);
+                this.callbacks.delete(id);
+                reject(new Error('Request timeout'));
+            };
+            setTimeout(expire, 5000);
         });
     }
     
@@ -132,6 +342,12 @@ class MCPClient {
     }
     
     handleNotification(message) {
+        if (message.method === 'notifications/message') {
+            if (this.onLog) {
+                this.onLog(message.params.level, message.params.data);
+            }
+            return;
+        }
         if (message.method === 'notifications/resources/updated') {
             const uri = message.params.uri;
             const callback = this.subscriptions.get(uri);
@@ -154,10 +370,15 @@ class MCPClient {
         setTimeout(() => this.connect(), delay);
     }
     
+    // MCP ping; the server also pings at the WebSocket level, which the
+    // browser answers by itself
     startHeartbeat() {
         this.heartbeatInterval = setInterval(() => {
             if (this.ws && this.ws.readyState === WebSocket.OPEN) {
-                this.ws.send(JSON.stringify({ type: 'ping' }));
+                const sentAt = performance.now();
+                this.sendRequest('ping', {})
+                    .then(() => { this.rtt = performance.now() - sentAt; })
+                    .catch((error) => console.warn('Ping failed:', error.message));
             }
         }, 30000);
     }
@@ -191,6 +412,15 @@ async function connectToMCP() {
         const networkStatus = await client.readResource('system://network');
         console.log('Network status:', networkStatus);
         
+        // Stream the board's log lines of level info and above
+        await client.setLogLevel('info', (level, lines) => {
+            lines.forEach((line) => console.log(`[esp32 ${level}] ${line}`));
+        });
+        
+        // Download the metrics history log
+        const history = await client.readBlob('file:///metrics.log');
+        console.log('Metrics history:', history.size, 'bytes');
+        
     } catch (error) {
         console.error('Error:', error);
     }
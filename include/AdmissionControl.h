@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace mcp {
+
+/**
+ * Decides which connections and messages the server takes on.
+ *
+ * Connections are refused when all client slots are taken or free heap is
+ * below the shedding threshold. Each admitted client gets a token bucket
+ * limiting its message rate, and clients silent for longer than the idle
+ * timeout are reported for eviction.
+ *
+ * Pure bookkeeping: callers pass the time and free heap in, so the policy
+ * can be tested off-device. Not thread-safe; the caller serializes access.
+ */
+class AdmissionControl {
+public:
+    static constexpr size_t MAX_SLOTS = 8;
+
+    struct Config {
+        uint8_t maxClients;          // Concurrent clients admitted (<= MAX_SLOTS)
+        uint16_t messagesPerSecond;  // Sustained per-client message rate
+        uint16_t burst;              // Messages a client may send back to back
+        uint32_t idleTimeout;        // ms without messages before eviction (0 = never)
+        uint32_t minFreeHeap;        // Refuse new clients below this many free bytes
+        uint32_t criticalFreeHeap;   // Drop incoming messages below this many free bytes
+    };
+
+    enum class Verdict {
+        ADMIT,
+        REJECT_FULL,       // No client slot available
+        REJECT_LOW_HEAP,   // Shed to protect the heap
+        REJECT_RATE        // Client exceeded its token bucket
+    };
+
+    static constexpr Config DEFAULT_CONFIG = {
+        4,      // maxClients
+        10,     // messagesPerSecond
+        20,     // burst
+        300000, // idleTimeout: 5 minutes
+        40000,  // minFreeHeap
+        20000   // criticalFreeHeap
+    };
+
+    explicit AdmissionControl(const Config& config = DEFAULT_CONFIG);
+
+    void setConfig(const Config& config);
+    const Config& getConfig() const { return config; }
+
+    /**
+     * Decide whether a new connection may take a slot
+     * @param activeClients Connections currently holding slots
+     * @param freeHeap Current free heap in bytes
+     */
+    Verdict admitConnection(size_t activeClients, uint32_t freeHeap) const;
+
+    /**
+     * Start tracking a newly admitted client
+     * @param slot Client slot index
+     * @param now Current time in ms
+     */
+    void opened(size_t slot, uint32_t now);
+
+    /**
+     * Charge one message against a client's bucket
+     * @param slot Client slot index
+     * @param now Current time in ms
+     * @param freeHeap Current free heap in bytes
+     */
+    Verdict admitMessage(size_t slot, uint32_t now, uint32_t freeHeap);
+
+    /**
+     * Check whether a client has been silent past the idle timeout
+     */
+    bool isIdle(size_t slot, uint32_t now) const;
+
+private:
+    static constexpr uint32_t MILLI = 1000; // Tokens are tracked in thousandths
+
+    struct Bucket {
+        uint32_t milliTokens;
+        uint32_t lastRefill;
+        uint32_t lastActivity;
+    };
+
+    Config config;
+    Bucket buckets[MAX_SLOTS];
+};
+
+} // namespace mcp
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace mcp {
+
+/**
+ * Incremental base64 encoder (RFC 4648 alphabet, with padding).
+ *
+ * Input may arrive in pieces of any size: up to two trailing bytes are
+ * carried over to the next update(), so the output is the same as encoding
+ * the concatenated input at once. Each 3-byte group is translated with four
+ * lookups in a 64-entry table, without branches.
+ *
+ *     Base64Encoder encoder;
+ *     n = encoder.update(piece, len, out);   // as often as needed
+ *     n += encoder.finish(out + n);
+ */
+class Base64Encoder {
+public:
+    /**
+     * Encoded size of len bytes, padding included
+     */
+    static constexpr size_t encodedLength(size_t len) { return (len + 2) / 3 * 4; }
+
+    /**
+     * Encode more input
+     * @param in Input bytes
+     * @param len Number of input bytes
+     * @param out Receives the text; needs room for encodedLength(len + 2) chars
+     * @return Number of chars written
+     */
+    size_t update(const uint8_t *in, size_t len, char *out);
+
+    /**
+     * Encode the carried bytes with padding and reset the encoder
+     * @param out Receives the text; needs room for 4 chars
+     * @return Number of chars written
+     */
+    size_t finish(char *out);
+
+private:
+    uint8_t carry[3] = {0, 0, 0};
+    uint8_t carried = 0;
+};
+
+} // namespace mcp
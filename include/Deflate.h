@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef MCP_DEFLATE_WINDOW_BITS
+#define MCP_DEFLATE_WINDOW_BITS 10
+#endif
+
+namespace mcp {
+
+/**
+ * Raw DEFLATE (RFC 1951) encoder for outgoing frames.
+ *
+ * LZ77 over a bounded window with hash chains, emitted as a single block of
+ * fixed Huffman codes, so no code tables are built or sent. The window and
+ * hash table are the only state (2 bytes per entry each: 4 KB with the
+ * default 1 KB window); the input is compressed in one call from memory,
+ * so no sliding window copy is kept.
+ *
+ * Output is inflatable by any raw-deflate decoder (zlib with -15 window
+ * bits, DecompressionStream("deflate-raw")). Not thread-safe; the owner
+ * serializes access.
+ */
+class Deflate {
+public:
+    static constexpr uint8_t WINDOW_BITS = MCP_DEFLATE_WINDOW_BITS;
+    static constexpr size_t WINDOW_SIZE = 1u << WINDOW_BITS;
+    static constexpr uint8_t HASH_BITS = 10;
+    static constexpr size_t HASH_SIZE = 1u << HASH_BITS;
+    static constexpr size_t MAX_INPUT = 0xFFFF;     // Positions are stored in 16 bits
+    static constexpr uint8_t MAX_CHAIN = 16;        // Candidates tried per position
+
+    static_assert(WINDOW_BITS >= 8 && WINDOW_BITS <= 15, "DEFLATE window is 256 B .. 32 KB");
+
+    Deflate();
+
+    /**
+     * Compress a buffer
+     * @param in Input bytes
+     * @param len Input length (at most MAX_INPUT)
+     * @param out Destination
+     * @param capacity Destination size
+     * @return Compressed length, or 0 if it would not fit in capacity
+     */
+    size_t compress(const uint8_t* in, size_t len, uint8_t* out, size_t capacity);
+
+private:
+    uint16_t head[HASH_SIZE];    // Last position + 1 per hash (0 = none)
+    uint16_t prev[WINDOW_SIZE];  // Previous position + 1 with the same hash
+
+    uint8_t* out;
+    size_t outCapacity;
+    size_t outLength;
+    uint32_t bitBuffer;
+    uint8_t bitCount;
+    bool overflow;
+
+    void writeBits(uint32_t value, uint8_t count);
+    void writeCode(uint16_t code, uint8_t length);
+    void writeLiteral(uint8_t literal);
+    void writeMatch(uint16_t length, uint16_t distance);
+    void flushBits();
+    static uint32_t hash(const uint8_t* p);
+};
+
+} // namespace mcp
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace mcp {
+
+/**
+ * Keeps the DHCP lease of an address the station already uses.
+ *
+ * A fast connect joins on the cached lease as a static address. Starting the
+ * stack's DHCP client would clear that address first, which aborts every
+ * socket and starts over with a DISCOVER. This client asks the server
+ * directly instead (RFC 2131 4.3.2 and 4.4.5). It sends an INIT-REBOOT
+ * DHCPREQUEST for the cached address, then renews at T1 of every lease the
+ * server grants and rebinds at T2. The address itself is never touched.
+ *
+ * Pure bookkeeping like Heartbeat: callers pass the time in and own the UDP
+ * socket. IPv4 addresses are uint32_t as IPAddress stores them, with the
+ * first octet in the lowest byte. Not thread-safe; the caller serializes
+ * access.
+ */
+class DhcpLease {
+public:
+    static constexpr uint16_t CLIENT_PORT = 68;
+    static constexpr uint16_t SERVER_PORT = 67;
+    static constexpr size_t REQUEST_SIZE = 300;        // BOOTP minimum; some servers drop shorter
+    static constexpr size_t MAX_REPLY_SIZE = 576;      // Every DHCP client must accept this much
+    static constexpr uint32_t RETRY_INTERVAL = 4000;   // ms between unanswered requests
+    static constexpr uint32_t MAX_LEASE_TIME = 604800; // s; longer leases are renewed weekly
+    static constexpr uint32_t BROADCAST = 0xFFFFFFFF;
+
+    enum class Action {
+        NONE,
+        SEND,     // Send the request written to the buffer to the returned destination
+        EXPIRED   // The lease ran out unrenewed; the address must not be used any more
+    };
+
+    enum class Reply {
+        IGNORED,  // Not an answer to the outstanding request
+        ACK,      // Lease granted or extended
+        NAK       // Address refused; tracking has ended
+    };
+
+    DhcpLease();
+
+    /**
+     * Start confirming an address; the first request is due at once
+     * @param address Address the station uses
+     * @param mac Station MAC address (6 bytes)
+     * @param xid Random transaction id
+     * @param now Current time in ms
+     */
+    void start(uint32_t address, const uint8_t *mac, uint32_t xid, uint32_t now);
+
+    void stop() { state = State::IDLE; }
+
+    bool isActive() const { return state != State::IDLE; }
+
+    /**
+     * Whether the server has not yet confirmed the address since start()
+     */
+    bool isConfirming() const { return state == State::REBOOTING; }
+
+    /**
+     * Whether a request is waiting for its reply
+     */
+    bool isWaiting() const {
+        return state == State::REBOOTING || state == State::RENEWING || state == State::REBINDING;
+    }
+
+    /**
+     * Decide what the lease needs now
+     * @param now Current time in ms
+     * @param request Set to the request when SEND is returned; REQUEST_SIZE bytes
+     * @param destination Set to where SEND's request goes (BROADCAST or the server)
+     */
+    Action poll(uint32_t now, uint8_t *request, uint32_t &destination);
+
+    /**
+     * Process a packet received on CLIENT_PORT
+     * @param data Packet payload
+     * @param length Payload length in bytes
+     * @param now Current time in ms
+     */
+    Reply receive(const uint8_t *data, size_t length, uint32_t now);
+
+    /**
+     * Time until poll() has something to do (UINT32_MAX when idle)
+     * @param now Current time in ms
+     */
+    uint32_t timeUntilDue(uint32_t now) const;
+
+    /**
+     * Lease time granted by the last ACK, in seconds
+     */
+    uint32_t getLeaseTime() const { return leaseTime; }
+
+    /**
+     * Server that granted the lease (0 until the first ACK)
+     */
+    uint32_t getServer() const { return server; }
+
+private:
+    enum class State : uint8_t {
+        IDLE,
+        REBOOTING,  // INIT-REBOOT: broadcast, requested address in option 50
+        BOUND,
+        RENEWING,   // Past T1: unicast to the server, address in ciaddr
+        REBINDING   // Past T2: broadcast, address in ciaddr
+    };
+
+    State state;
+    uint32_t address;
+    uint8_t mac[6];
+    uint32_t xid;
+    bool sent;              // A request went out in the current state
+    uint32_t lastSent;      // ms
+    uint32_t boundAt;       // ms, when the last ACK arrived
+    uint32_t leaseTime;     // s
+    uint32_t renewAfter;    // ms after boundAt (T1)
+    uint32_t rebindAfter;   // ms after boundAt (T2)
+    uint32_t expireAfter;   // ms after boundAt
+    uint32_t server;
+
+    void enter(State next);
+    void writeRequest(uint8_t *request) const;
+};
+
+} // namespace mcp
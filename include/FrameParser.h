@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include "MCPTransport.h"
+
+namespace mcp {
+
+/**
+ * Parses incoming MCP frames with per-method filter documents.
+ *
+ * The method name is picked off the raw frame by a scan that only tracks
+ * nesting, and selects a filter so the single deserialization retains only
+ * the fields its handler reads. Large unused params are skipped by the
+ * tokenizer instead of being copied into the document, which keeps
+ * parse-time RAM bounded. Frames without a known method keep only the
+ * JSON-RPC envelope (jsonrpc, id, method).
+ *
+ * MessagePack frames are scanned and filtered the same way.
+ *
+ * Frames are parsed into the request's own MemoryPool-backed document
+ * (see MCPRequest), so no per-frame heap allocation takes place.
+ */
+class FrameParser {
+public:
+    static constexpr size_t MAX_FRAME_SIZE = 8192;
+    static constexpr uint8_t NESTING_LIMIT = 8;
+    static constexpr size_t MAX_METHOD_LENGTH = 48;  // Longer names get the envelope filter
+
+    FrameParser();
+
+    /**
+     * Register the filter used for a method's second pass
+     * @param method JSON-RPC method name
+     * @param filterJson Filter document, e.g. {"params":{"uri":true}}
+     * @return false if the filter JSON is invalid
+     */
+    bool setFilter(const std::string& method, const char* filterJson);
+
+    /**
+     * Find the top-level "method" of a frame without deserializing it
+     * @param method Receives the name, NUL-terminated
+     * @param size Size of method (at most MAX_METHOD_LENGTH is useful)
+     * @return false if the frame has no method string or it does not fit
+     */
+    static bool findMethod(const uint8_t* data, size_t len, Encoding encoding, char* method, size_t size);
+
+    /**
+     * Parse a frame straight from the transport's receive buffer
+     * @param data Frame bytes (not copied)
+     * @param len Frame length
+     * @param doc Destination document, normally MCPRequest::doc
+     * @param encoding JSON text or MessagePack (binary frames)
+     * @return Deserialization result; TooDeep/NoMemory/InvalidInput on failure
+     */
+    DeserializationError parse(const uint8_t* data, size_t len, JsonDocument& doc,
+                               Encoding encoding = Encoding::JSON);
+
+private:
+    JsonDocument envelopeFilter;
+    std::map<std::string, JsonDocument, std::less<>> methodFilters;  // Looked up by const char*
+    std::mutex mutex;                                                // Guards both filter sets
+};
+
+} // namespace mcp
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace mcp {
+
+/**
+ * Schedules liveness pings per client slot and detects dead peers.
+ *
+ * Each tracked slot is pinged every interval, with at most one ping
+ * outstanding. A ping not answered within the timeout counts as missed and
+ * is retried at once; maxMissed misses in a row declare the peer dead. A
+ * half-open connection is so detected after interval + maxMissed * timeout,
+ * instead of after the TCP retransmission timeout.
+ *
+ * Pure bookkeeping like AdmissionControl: callers pass the time in and send
+ * the pings. Not thread-safe; the caller serializes access.
+ */
+class Heartbeat {
+public:
+    static constexpr size_t MAX_SLOTS = 8;
+
+    struct Config {
+        uint32_t interval;   // ms between pings (0 = disabled)
+        uint32_t timeout;    // ms to wait for the pong
+        uint8_t maxMissed;   // Missed pongs in a row before the peer is dead
+    };
+
+    static constexpr Config DEFAULT_CONFIG = {15000, 5000, 2};
+
+    enum class Action {
+        NONE,
+        PING,   // Send a ping carrying the returned sequence number
+        DEAD    // Peer stopped answering; tracking of the slot has ended
+    };
+
+    explicit Heartbeat(const Config &config = DEFAULT_CONFIG);
+
+    void setConfig(const Config &config) { this->config = config; }
+    const Config &getConfig() const { return config; }
+
+    /**
+     * Start tracking a slot; its first ping is due one interval from now
+     * @param slot Client slot index
+     * @param now Current time in ms
+     */
+    void opened(size_t slot, uint32_t now);
+
+    /**
+     * Stop tracking a slot
+     */
+    void closed(size_t slot);
+
+    /**
+     * Decide what a slot needs now
+     * @param slot Client slot index
+     * @param now Current time in ms
+     * @param sequence Set to the ping's sequence number when PING is returned
+     */
+    Action poll(size_t slot, uint32_t now, uint32_t &sequence);
+
+    /**
+     * Record a pong
+     * @param slot Client slot index
+     * @param sequence Sequence number echoed in the pong
+     * @return true if it answers the outstanding ping (stale pongs are ignored)
+     */
+    bool pong(size_t slot, uint32_t sequence);
+
+    /**
+     * Whether a slot has a ping awaiting its pong
+     */
+    bool isOutstanding(size_t slot) const;
+
+private:
+    struct Peer {
+        bool tracked;
+        bool outstanding;
+        uint8_t missed;
+        uint32_t sequence;
+        uint32_t lastPing;   // When the last ping was sent (or tracking began)
+    };
+
+    Config config;
+    Peer peers[MAX_SLOTS];
+    uint32_t nextSequence;
+};
+
+} // namespace mcp
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <ESPAsyncWebServer.h>
+#include <map>
+#include <mutex>
+#include "MCPTransport.h"
+#include "MemoryPool.h"
+
+namespace mcp {
+
+/**
+ * MCP Streamable HTTP transport on the port-80 AsyncWebServer.
+ *
+ * A POST /mcp carrying initialize opens a session; the response holds the
+ * Mcp-Session-Id header that every later request must send back. A session
+ * is one MCPServer client for its whole life, so what initialize negotiated,
+ * subscriptions and the log level carry across requests. Each POST carries
+ * one JSON-RPC message, answered in the response body (202 Accepted for
+ * notifications); GET /mcp opens the session's SSE stream for server
+ * notifications; DELETE /mcp ends the session. A request unanswered after
+ * RESPONSE_TIMEOUT also ends it.
+ *
+ * AsyncWebServer requests may only be touched on the async_tcp task. Answers
+ * produced on the MCP task are therefore parked in the exchange and pulled
+ * by a chunked response filler that AsyncTCP polls until they are ready,
+ * and notifications wait in the session until its stream's filler takes
+ * them.
+ */
+class HttpTransport : public Transport {
+public:
+    static constexpr const char* ENDPOINT = "/mcp";
+    static constexpr const char* SESSION_HEADER = "Mcp-Session-Id";
+    static constexpr size_t MAX_SESSIONS = 4;
+    static constexpr size_t MAX_EXCHANGES = 4;          // POSTs awaiting their answer, all sessions
+    static constexpr size_t MAX_STREAM_BACKLOG = 4096;  // SSE bytes held per session for its stream
+    static constexpr uint32_t RESPONSE_TIMEOUT = 10000; // 10 seconds
+
+    explicit HttpTransport(AsyncWebServer& server);
+
+    const char* name() const override { return "http"; }
+    bool begin() override;
+    void poll() override;
+    bool send(uint32_t connectionId, const char* data, size_t len) override;
+    void close(uint32_t connectionId) override;
+
+private:
+    static constexpr size_t TOKEN_LENGTH = 32;
+
+    struct Session {
+        uint32_t id;                    // Connection id known to the server; 0 when free
+        char token[TOKEN_LENGTH + 1];   // Mcp-Session-Id value
+        AsyncWebServerRequest* stream;  // Open GET stream, or nullptr
+        PooledBuffer events;            // SSE text the stream has not taken yet
+    };
+
+    struct Exchange {
+        uint32_t id;                    // 0 when free; ascending, so answers pair up in order
+        uint32_t session;
+        AsyncWebServerRequest* request; // nullptr once the peer went away
+        uint32_t startedAt;
+        PooledBuffer response;
+        bool ready;                     // response holds the whole body
+    };
+
+    AsyncWebServer& web;
+    Session sessions[MAX_SESSIONS];
+    Exchange exchanges[MAX_EXCHANGES];
+    std::map<AsyncWebServerRequest*, PooledBuffer> bodies;  // async_tcp task only
+    uint32_t nextId;
+    uint32_t inlineExchange;  // Exchange whose frame is inside MCPServer::onMessage()
+    TaskHandle_t inlineTask;  // Task running that call; its sends answer inlineExchange
+    std::mutex mutex;         // Guards sessions, exchanges and the inline pair
+    bool started;
+
+    void onBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total);
+    void onPost(AsyncWebServerRequest* request);
+    void onStream(AsyncWebServerRequest* request);
+    void onDelete(AsyncWebServerRequest* request);
+    void forget(AsyncWebServerRequest* request);
+
+    /**
+     * Chunked response fillers, run on the async_tcp task
+     * @return Bytes written, 0 at the end, RESPONSE_TRY_AGAIN while waiting
+     */
+    size_t fillResponse(uint32_t exchangeId, uint8_t* buffer, size_t maxLen, size_t index);
+    size_t fillStream(uint32_t sessionId, uint8_t* buffer, size_t maxLen);
+
+    /**
+     * Close a session: its pending exchanges are answered with an error and
+     * its stream ends; the server is told outside the lock
+     */
+    void endSession(uint32_t sessionId, const char* reason);
+
+    uint32_t takeId();
+    Session* findSession(uint32_t id);
+    Session* findSession(AsyncWebServerRequest* request);
+    Exchange* findExchange(uint32_t id);
+    void answer(Exchange& exchange, const char* data, size_t len);
+    void release(Exchange& exchange);
+};
+
+} // namespace mcp
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include "RequestId.h"
+
+namespace mcp {
+
+/**
+ * Output that only counts bytes, to size a buffer before writing
+ */
+struct CountingOutput {
+    size_t length = 0;
+
+    bool write(const char*, size_t len) {
+        length += len;
+        return true;
+    }
+};
+
+/**
+ * Output into a caller-owned fixed buffer; fails rather than truncating
+ */
+class BufferOutput {
+public:
+    BufferOutput(char* data, size_t capacity) : data_(data), capacity_(capacity), length_(0) {}
+
+    bool write(const char* bytes, size_t len) {
+        if (len > capacity_ - length_) {
+            return false;
+        }
+        memcpy(data_ + length_, bytes, len);
+        length_ += len;
+        return true;
+    }
+
+    size_t length() const { return length_; }
+
+private:
+    char* data_;
+    size_t capacity_;
+    size_t length_;
+};
+
+/**
+ * Streaming JSON writer for fixed-shape messages.
+ *
+ * Emits straight into an Output (anything with bool write(const char*, size_t))
+ * in a single pass: no document tree, no allocation. Commas between members
+ * and elements are inserted automatically; keys and pre-encoded fragments
+ * given as string literals have their length fixed at compile time.
+ * Strings are escaped per RFC 8259; non-finite numbers are written as null,
+ * as ArduinoJson does.
+ *
+ *     BufferOutput out(buffer, sizeof(buffer));
+ *     JsonWriter<BufferOutput> writer(out);
+ *     writer.beginObject().rawKey(JsonRpc::ID_KEY).value(id)
+ *           .key("result").beginObject().key("ok").value(true).endObject()
+ *           .endObject();
+ *
+ * The writer does not check that the calls form a valid document.
+ */
+template <typename Output>
+class JsonWriter {
+public:
+    static constexpr uint8_t MAX_DEPTH = 32;
+
+    explicit JsonWriter(Output& output) : output(output), depth(0), hasMembers(0), afterKey(false), failed(false) {}
+
+    /**
+     * Whether every byte was accepted by the output
+     */
+    bool ok() const { return !failed; }
+
+    JsonWriter& beginObject() { return open('{'); }
+    JsonWriter& endObject() { return close('}'); }
+    JsonWriter& beginArray() { return open('['); }
+    JsonWriter& endArray() { return close(']'); }
+
+    /**
+     * Member name known at compile time; must not need escaping
+     */
+    template <size_t N>
+    JsonWriter& key(const char (&name)[N]) {
+        separate();
+        put('"');
+        put(name, N - 1);
+        put("\":", 2);
+        afterKey = true;
+        return *this;
+    }
+
+    /**
+     * Member name from runtime text, escaped
+     */
+    JsonWriter& key(const char* name, size_t len) {
+        separate();
+        putString(name, len);
+        put(':');
+        afterKey = true;
+        return *this;
+    }
+
+    /**
+     * Pre-encoded members ending in a key, e.g. "\"jsonrpc\":\"2.0\",\"id\":";
+     * the next call writes that key's value
+     */
+    template <size_t N>
+    JsonWriter& rawKey(const char (&fragment)[N]) {
+        separate();
+        put(fragment, N - 1);
+        afterKey = true;
+        return *this;
+    }
+
+    /**
+     * Pre-encoded value, e.g. a cached serialization, written as is
+     */
+    JsonWriter& rawValue(const char* json, size_t len) {
+        beginValue();
+        put(json, len);
+        return *this;
+    }
+
+    /**
+     * String value whose characters are written by fill(Output&), which
+     * returns false on failure; for text that needs no escaping, such as
+     * base64, and that is too large to build separately first
+     */
+    template <typename Fill>
+    JsonWriter& rawString(Fill fill) {
+        beginValue();
+        put('"');
+        if (!failed && !fill(output)) {
+            failed = true;
+        }
+        put('"');
+        return *this;
+    }
+
+    JsonWriter& value(const char* text) {
+        if (!text) {
+            return null();
+        }
+        return value(text, strlen(text));
+    }
+
+    JsonWriter& value(const char* text, size_t len) {
+        beginValue();
+        putString(text, len);
+        return *this;
+    }
+
+    JsonWriter& value(const std::string& text) { return value(text.data(), text.size()); }
+
+    JsonWriter& value(bool flag) {
+        beginValue();
+        if (flag) {
+            put("true", 4);
+        } else {
+            put("false", 5);
+        }
+        return *this;
+    }
+
+    JsonWriter& value(int32_t number) { return value(static_cast<int64_t>(number)); }
+    JsonWriter& value(uint32_t number) { return value(static_cast<uint64_t>(number)); }
+
+    JsonWriter& value(int64_t number) {
+        beginValue();
+        if (number < 0) {
+            put('-');
+            putUnsigned(0 - static_cast<uint64_t>(number));
+        } else {
+            putUnsigned(static_cast<uint64_t>(number));
+        }
+        return *this;
+    }
+
+    JsonWriter& value(uint64_t number) {
+        beginValue();
+        putUnsigned(number);
+        return *this;
+    }
+
+    JsonWriter& value(double number) {
+        if (!isfinite(number)) {
+            return null();
+        }
+        beginValue();
+        char digits[32];
+        int len = snprintf(digits, sizeof(digits), "%.9g", number);
+        put(digits, static_cast<size_t>(len));
+        return *this;
+    }
+
+    /**
+     * JSON-RPC id, echoed as the client sent it
+     */
+    JsonWriter& value(const RequestId& id) {
+        switch (id.kind()) {
+            case RequestId::Kind::INTEGER: return value(id.integer());
+            case RequestId::Kind::STRING: return value(id.text(), id.length());
+            default: return null();
+        }
+    }
+
+    JsonWriter& null() {
+        beginValue();
+        put("null", 4);
+        return *this;
+    }
+
+private:
+    Output& output;
+    uint8_t depth;
+    uint32_t hasMembers;  // Bit per nesting level: a comma is due before the next item
+    bool afterKey;
+    bool failed;
+
+    void put(char c) { put(&c, 1); }
+
+    void put(const char* bytes, size_t len) {
+        if (!failed && !output.write(bytes, len)) {
+            failed = true;
+        }
+    }
+
+    void separate() {
+        uint32_t bit = depth ? 1u << (depth - 1) : 0;
+        if (hasMembers & bit) {
+            put(',');
+        }
+        hasMembers |= bit;
+    }
+
+    void beginValue() {
+        if (afterKey) {
+            afterKey = false;
+        } else {
+            separate();
+        }
+    }
+
+    JsonWriter& open(char bracket) {
+        beginValue();
+        put(bracket);
+        if (depth < MAX_DEPTH) {
+            depth++;
+            hasMembers &= ~(1u << (depth - 1));
+        }
+        return *this;
+    }
+
+    JsonWriter& close(char bracket) {
+        if (depth > 0) {
+            depth--;
+        }
+        put(bracket);
+        return *this;
+    }
+
+    void putUnsigned(uint64_t number) {
+        char digits[20];
+        size_t pos = sizeof(digits);
+        do {
+            digits[--pos] = static_cast<char>('0' + number % 10);
+            number /= 10;
+        } while (number);
+        put(digits + pos, sizeof(digits) - pos);
+    }
+
+    void putString(const char* text, size_t len) {
+        static const char HEX_DIGITS[] = "0123456789abcdef";
+        put('"');
+        // Copy runs of plain bytes in one write; UTF-8 passes through
+        size_t run = 0;
+        for (size_t i = 0; i < len; i++) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            put(text + run, i - run);
+            run = i + 1;
+            switch (c) {
+                case '"': put("\\\"", 2); break;
+                case '\\': put("\\\\", 2); break;
+                case '\b': put("\\b", 2); break;
+                case '\f': put("\\f", 2); break;
+                case '\n': put("\\n", 2); break;
+                case '\r': put("\\r", 2); break;
+                case '\t': put("\\t", 2); break;
+                default: {
+                    char escape[6] = {'\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF]};
+                    put(escape, sizeof(escape));
+                }
+            }
+        }
+        put(text + run, len - run);
+        put('"');
+    }
+};
+
+/**
+ * Pre-encoded JSON-RPC envelope fragments for use with JsonWriter::rawKey()
+ */
+namespace JsonRpc {
+constexpr char ID_KEY[] = "\"jsonrpc\":\"2.0\",\"id\":";
+constexpr char METHOD_KEY[] = "\"jsonrpc\":\"2.0\",\"method\":";
+} // namespace JsonRpc
+
+} // namespace mcp
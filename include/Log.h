@@ -0,0 +1,139 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <mutex>
+#include "LogRing.h"
+#include "LogTap.h"
+
+/**
+ * Logging facade.
+ *
+ * MCP_LOG_LEVEL selects, at compile time, which statements exist at all:
+ * anything above it expands to nothing, arguments included. Enabled
+ * statements only append a binary record (format pointer + arguments) to
+ * a lock-free ring; a low-priority task formats and writes the records to
+ * Serial and/or a LittleFS file, so the caller never waits on the UART.
+ *
+ *   MCP_LOGI("Client %d connected from %s", id, ip.toString().c_str());
+ *
+ * Format strings must be literals (only the pointer is stored). String
+ * arguments are copied, up to LogRing::MAX_STRING bytes.
+ */
+
+#define MCP_LOG_LEVEL_NONE  0
+#define MCP_LOG_LEVEL_ERROR 1
+#define MCP_LOG_LEVEL_WARN  2
+#define MCP_LOG_LEVEL_INFO  3
+#define MCP_LOG_LEVEL_DEBUG 4
+
+#ifndef MCP_LOG_LEVEL
+#define MCP_LOG_LEVEL MCP_LOG_LEVEL_INFO
+#endif
+
+#ifndef MCP_LOG_RING_SIZE
+#define MCP_LOG_RING_SIZE 4096
+#endif
+
+#ifndef MCP_LOG_TAP_LINES
+#define MCP_LOG_TAP_LINES 16
+#endif
+
+#if MCP_LOG_LEVEL >= MCP_LOG_LEVEL_ERROR
+#define MCP_LOGE(format, ...) ::mcp::Log::write(MCP_LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#else
+#define MCP_LOGE(format, ...) do {} while (0)
+#endif
+
+#if MCP_LOG_LEVEL >= MCP_LOG_LEVEL_WARN
+#define MCP_LOGW(format, ...) ::mcp::Log::write(MCP_LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#else
+#define MCP_LOGW(format, ...) do {} while (0)
+#endif
+
+#if MCP_LOG_LEVEL >= MCP_LOG_LEVEL_INFO
+#define MCP_LOGI(format, ...) ::mcp::Log::write(MCP_LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#else
+#define MCP_LOGI(format, ...) do {} while (0)
+#endif
+
+#if MCP_LOG_LEVEL >= MCP_LOG_LEVEL_DEBUG
+#define MCP_LOGD(format, ...) ::mcp::Log::write(MCP_LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+#define MCP_LOGD(format, ...) do {} while (0)
+#endif
+
+namespace mcp {
+
+class Log {
+public:
+    static constexpr uint32_t DRAIN_INTERVAL = 20;            // ms between drains when idle
+    static constexpr size_t MAX_LINE = 256;
+    static constexpr size_t MAX_FILE_SIZE = 64 * 1024;        // Rotated to <path>.1 beyond this
+
+    static Log& getInstance() {
+        static Log instance;
+        return instance;
+    }
+
+    /**
+     * Start the drain task; records logged before this are kept in the ring
+     * @param output Serial port (or any Print) to write to, nullptr for none
+     * @return true if the task is running (placed per TaskTopology::LOG_DRAIN)
+     */
+    bool begin(Print* output = &Serial);
+
+    /**
+     * Also append formatted lines to a file
+     * @param fs Filesystem (LittleFS)
+     * @param path Log file path
+     * @return true if the file could be opened
+     */
+    bool logToFile(fs::FS& fs, const char* path);
+
+    /**
+     * Record a log statement; use the MCP_LOGx macros instead
+     */
+    template<typename... Args>
+    static void write(uint8_t level, const char* format, const Args&... args) {
+        getInstance().ring.write(level, millis(), format, args...);
+    }
+
+    uint32_t getDropped() const { return ring.getDropped(); }
+
+    /**
+     * Also copy formatted lines up to a level into the tap, for forwarding
+     * to remote clients; the drain task is its producer
+     * @param level Most verbose level copied, MCP_LOG_LEVEL_NONE for none
+     */
+    void setTapLevel(uint8_t level) { tapLevel.store(level, std::memory_order_relaxed); }
+
+    /**
+     * Lines copied by setTapLevel(); read by a single consumer task
+     */
+    LogTap& getTap() { return tap; }
+
+private:
+    Log();
+    Log(const Log&) = delete;
+    Log& operator=(const Log&) = delete;
+
+    LogRing ring;
+    LogTap tap;
+    std::atomic<uint8_t> tapLevel;
+    Print* output;
+    fs::FS* fileSystem;
+    String filePath;
+    File file;
+    std::mutex mutex;             // Guards the outputs, not the ring
+    TaskHandle_t drainTaskHandle;
+    uint32_t reportedDrops;
+
+    static void drainTaskCode(void* parameter);
+    void drainTask();
+    bool drain();
+    void emit(const char* line, size_t length);
+    void rotateFile();
+};
+
+} // namespace mcp
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+namespace mcp {
+
+/**
+ * Lock-free multi-producer, single-consumer ring of binary log records.
+ *
+ * A record stores the format string pointer (literals stay in flash) and
+ * the raw arguments; nothing is formatted on the logging path. Producers
+ * reserve space with a CAS on the head and publish the record by writing
+ * its header word last. The single consumer formats committed records in
+ * order and frees them. When the ring is full the record is dropped and
+ * counted instead of blocking the caller.
+ *
+ * Record layout (4-byte aligned):
+ *   header | timestamp | format pointer | tag, value | tag, value | ...
+ * String arguments are copied (up to MAX_STRING bytes) since the caller's
+ * buffer may be gone by the time the record is drained.
+ */
+class LogRing {
+public:
+    static constexpr size_t MAX_STRING = 64;     // Longest string argument kept
+    static constexpr size_t MAX_RECORD = 512;    // Larger records are dropped
+
+    struct Entry {
+        uint32_t timestamp;
+        uint8_t level;
+        const char* format;
+        const uint8_t* args;
+        size_t argsSize;
+    };
+
+    /**
+     * @param capacity Ring size in bytes, rounded up to a power of two
+     */
+    explicit LogRing(size_t capacity);
+    ~LogRing();
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    /**
+     * Append a record; safe from any task
+     * @param level Log level stored with the record
+     * @param timestamp Time in ms
+     * @param format printf-style format; must outlive the record (a literal)
+     * @return false if the record was dropped
+     */
+    template<typename... Args>
+    bool write(uint8_t level, uint32_t timestamp, const char* format, const Args&... args) {
+        size_t length = HEADER_SIZE + argsSize(args...);
+        uint8_t* record;
+        if (!reserve(length, record)) {
+            return false;
+        }
+        uint8_t* out = record + HEADER_SIZE;
+        encodeArgs(out, args...);
+        publish(record, align(length), level, timestamp, format);
+        return true;
+    }
+
+    /**
+     * Oldest committed record (consumer only)
+     * @param entry Filled with a view into the ring, valid until consume()
+     * @return false if no committed record is available
+     */
+    bool read(Entry& entry);
+
+    /**
+     * Free the record last returned by read() (consumer only)
+     */
+    void consume();
+
+    /**
+     * Render a record's format string with its stored arguments
+     * @return Characters written, excluding the terminator
+     */
+    static size_t format(const Entry& entry, char* out, size_t size);
+
+    size_t getCapacity() const { return capacity; }
+    uint32_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    enum ArgType : uint8_t {
+        ARG_INT32 = 1,
+        ARG_UINT32,
+        ARG_INT64,
+        ARG_UINT64,
+        ARG_DOUBLE,
+        ARG_STRING,
+        ARG_POINTER
+    };
+
+    static constexpr uint32_t LENGTH_MASK = 0x00FFFFFF;
+    static constexpr uint32_t LEVEL_SHIFT = 24;
+    static constexpr uint32_t PADDING = 1u << 30;
+    static constexpr uint32_t COMMITTED = 1u << 31;
+    static constexpr size_t HEADER_SIZE = 2 * sizeof(uint32_t) + sizeof(const char*);
+
+    uint8_t* buffer;
+    size_t capacity;
+    std::atomic<uint32_t> head;      // Next byte to reserve (monotonic)
+    std::atomic<uint32_t> tail;      // Next byte to consume (monotonic)
+    std::atomic<uint32_t> dropped;
+    uint32_t pendingLength;          // Record returned by read(), 0 if none
+
+    static size_t align(size_t length) { return (length + 3) & ~static_cast<size_t>(3); }
+    bool reserve(size_t length, uint8_t*& record);
+    void publish(uint8_t* record, size_t length, uint8_t level, uint32_t timestamp, const char* format);
+    static size_t boundedLength(const char* s);
+    static const char* orNull(const char* s) { return s ? s : "(null)"; }
+
+    template<typename T>
+    using Decayed = typename std::decay<T>::type;
+
+    template<typename T>
+    static constexpr bool isString() {
+        return std::is_same<Decayed<T>, const char*>::value || std::is_same<Decayed<T>, char*>::value;
+    }
+
+    static size_t argsSize() { return 0; }
+
+    template<typename T, typename... Rest>
+    static size_t argsSize(const T& value, const Rest&... rest) {
+        size_t size;
+        if constexpr (isString<T>()) {
+            size = 2 + boundedLength(orNull(value));
+        } else if constexpr (std::is_floating_point<T>::value) {
+            size = 1 + sizeof(double);
+        } else if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) {
+            size = 1 + (sizeof(T) > sizeof(uint32_t) ? sizeof(uint64_t) : sizeof(uint32_t));
+        } else {
+            static_assert(std::is_pointer<T>::value, "Unsupported log argument type");
+            size = 1 + sizeof(uintptr_t);
+        }
+        return size + argsSize(rest...);
+    }
+
+    static void encodeArgs(uint8_t*&) {}
+
+    template<typename T, typename... Rest>
+    static void encodeArgs(uint8_t*& out, const T& value, const Rest&... rest) {
+        if constexpr (isString<T>()) {
+            const char* s = orNull(value);
+            uint8_t length = boundedLength(s);
+            *out++ = ARG_STRING;
+            *out++ = length;
+            memcpy(out, s, length);
+            out += length;
+        } else if constexpr (std::is_floating_point<T>::value) {
+            double v = value;
+            *out++ = ARG_DOUBLE;
+            memcpy(out, &v, sizeof(v));
+            out += sizeof(v);
+        } else if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) {
+            using U = typename std::conditional<std::is_enum<T>::value,
+                                                std::underlying_type<T>, std::common_type<T>>::type::type;
+            constexpr bool wide = sizeof(U) > sizeof(uint32_t);
+            if constexpr (std::is_signed<U>::value) {
+                *out++ = wide ? ARG_INT64 : ARG_INT32;
+            } else {
+                *out++ = wide ? ARG_UINT64 : ARG_UINT32;
+            }
+            if constexpr (wide) {
+                uint64_t v = static_cast<uint64_t>(value);
+                memcpy(out, &v, sizeof(v));
+                out += sizeof(v);
+            } else {
+                // Sign-extended on decode
+                uint32_t v = static_cast<uint32_t>(static_cast<U>(value));
+                memcpy(out, &v, sizeof(v));
+                out += sizeof(v);
+            }
+        } else {
+            uintptr_t v = reinterpret_cast<uintptr_t>(value);
+            *out++ = ARG_POINTER;
+            memcpy(out, &v, sizeof(v));
+            out += sizeof(v);
+        }
+        encodeArgs(out, rest...);
+    }
+};
+
+} // namespace mcp
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace mcp {
+
+/**
+ * Lock-free single-producer, single-consumer queue of formatted log lines,
+ * for handing lines from the log drain task to another task.
+ *
+ * Slots have a fixed size; longer lines are truncated. When every slot is
+ * taken a line is dropped and counted, so the producer never waits. The
+ * consumer reads lines in place with peek() and frees them with consume(),
+ * so it can pass over the same lines several times.
+ */
+class LogTap {
+public:
+    static constexpr size_t MAX_TEXT = 128;
+
+    struct Line {
+        uint8_t level;
+        uint8_t length;
+        char text[MAX_TEXT];
+    };
+
+    /**
+     * @param slots Number of lines held, rounded up to a power of two
+     */
+    explicit LogTap(size_t slots);
+    ~LogTap();
+
+    LogTap(const LogTap&) = delete;
+    LogTap& operator=(const LogTap&) = delete;
+
+    /**
+     * Append a line (producer only)
+     * @param level Log level of the line
+     * @return false if the queue was full and the line dropped
+     */
+    bool push(uint8_t level, const char* text, size_t length);
+
+    /**
+     * Number of lines ready (consumer only)
+     */
+    size_t available() const;
+
+    /**
+     * Line by position, oldest first (consumer only)
+     * @param index Less than available()
+     */
+    const Line& peek(size_t index) const;
+
+    /**
+     * Free the oldest lines (consumer only)
+     */
+    void consume(size_t count);
+
+    size_t getCapacity() const { return capacity; }
+    uint32_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    Line* lines;
+    size_t capacity;
+    std::atomic<uint32_t> head;   // Next slot to fill (monotonic)
+    std::atomic<uint32_t> tail;   // Next slot to read (monotonic)
+    std::atomic<uint32_t> dropped;
+};
+
+} // namespace mcp
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string.h>
+
+namespace mcp {
+
+enum class MCPRequestType {
+    INITIALIZE,
+    RESOURCES_LIST,
+    RESOURCE_READ,
+    SUBSCRIBE,
+    UNSUBSCRIBE,
+    TOOLS_LIST,
+    TOOLS_CALL,
+    RESOURCE_TEMPLATES_LIST,
+    LOGGING_SET_LEVEL,
+    UNKNOWN
+};
+
+/**
+ * Map a JSON-RPC method name to its request type
+ */
+inline MCPRequestType requestTypeFromMethod(const char* method) {
+    if (strcmp(method, "initialize") == 0) return MCPRequestType::INITIALIZE;
+    if (strcmp(method, "resources/list") == 0) return MCPRequestType::RESOURCES_LIST;
+    if (strcmp(method, "resources/read") == 0) return MCPRequestType::RESOURCE_READ;
+    if (strcmp(method, "resources/subscribe") == 0) return MCPRequestType::SUBSCRIBE;
+    if (strcmp(method, "resources/unsubscribe") == 0) return MCPRequestType::UNSUBSCRIBE;
+    if (strcmp(method, "tools/list") == 0) return MCPRequestType::TOOLS_LIST;
+    if (strcmp(method, "tools/call") == 0) return MCPRequestType::TOOLS_CALL;
+    if (strcmp(method, "resources/templates/list") == 0) return MCPRequestType::RESOURCE_TEMPLATES_LIST;
+    if (strcmp(method, "logging/setLevel") == 0) return MCPRequestType::LOGGING_SET_LEVEL;
+    return MCPRequestType::UNKNOWN;
+}
+
+} // namespace mcp
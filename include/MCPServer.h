@@ -3,8 +3,18 @@
 
 #include <ArduinoJson.h>
 #include "MCPTypes.h"
-#include <unordered_map>
+#include "MCPTransport.h"
+#include "FrameParser.h"
+#include "RequestQueue.h"
+#include "AdmissionControl.h"
+#include "Deflate.h"
+#include "Heartbeat.h"
+#include "SessionTable.h"
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <functional>
 
 namespace mcp {
@@ -21,27 +31,233 @@ struct ServerCapabilities {
 
 class MCPServer {
 public:
+    static constexpr uint8_t MAX_CLIENTS = AdmissionControl::MAX_SLOTS;
+    static_assert(Heartbeat::MAX_SLOTS >= MAX_CLIENTS, "Heartbeat must track every client slot");
+    static_assert(SessionTable::CAPACITY >= MAX_CLIENTS, "Every client slot needs a session");
+
     MCPServer(uint16_t port = 9000);
 
+    uint16_t getPort() const { return port_; }
+
+    /**
+     * Attach a transport; all transports feed the same dispatcher
+     * @param transport Transport to start in begin() (not owned)
+     */
+    void addTransport(Transport *transport);
+
+    /**
+     * Replace the connection and message admission limits
+     * @param config New limits; applies to existing clients immediately
+     */
+    void setAdmissionConfig(const AdmissionControl::Config &config);
+
+    /**
+     * Smallest serialized message deflated for clients that negotiated
+     * compression; smaller ones are sent as they are
+     * @param bytes Threshold in bytes
+     */
+    void setCompressionThreshold(size_t bytes) { compressionThreshold = bytes; }
+
+    /**
+     * Entries per page of resources/list and tools/list; clients fetch the
+     * rest by passing the returned nextCursor back as cursor
+     * @param size Page size (at least 1)
+     */
+    void setPageSize(size_t size) { pageSize = size ? size : 1; }
+
+    /**
+     * Bytes of tools/call responses remembered per client, so a retried
+     * request id is answered from memory instead of running the tool again
+     * @param bytes Budget per client (0 disables replay)
+     */
+    void setReplayBudget(size_t bytes);
+
+    /**
+     * Limit the log lines forwarded to each client that enabled logging
+     * @param linesPerSecond Sustained rate; lines above it are dropped
+     * @param burst Lines that may be sent back to back
+     */
+    void setLogRate(uint16_t linesPerSecond, uint16_t burst);
+
+    /**
+     * Replace the liveness ping schedule (interval, pong timeout, misses before eviction)
+     */
+    void setHeartbeatConfig(const Heartbeat::Config &config);
+
     void begin(bool isConnected);
     void handleClient();
+
+    /**
+     * Hand a parsed request to the MCP worker; it is dispatched from handleClient()
+     * @param request Request to move into the queue
+     * @return false if the queue is full (request is left intact)
+     */
+    bool submit(MCPRequest &&request);
+
+    /**
+     * Parse a raw frame into an owning request
+     * @param clientId Client the frame came from
+     * @param json Frame text
+     */
+    MCPRequest parseRequest(uint8_t clientId, const std::string &json);
+
+    // Transport callbacks (may run on the transport's task)
+
+    /**
+     * Register a new connection
+     * @return Client id assigned to the connection, or -1 if rejected
+     */
+    int onConnect(Transport *transport, uint32_t connectionId);
+    void onDisconnect(Transport *transport, uint32_t connectionId);
+
+    /**
+     * Accept the pong answering a ping sent by pingClients()
+     * @param data Echoed ping payload
+     */
+    void onPong(Transport *transport, uint32_t connectionId, const uint8_t *data, size_t len);
+
+    /**
+     * Accept one complete frame from a connection
+     * @param encoding Frame encoding (binary frames carry MessagePack)
+     * @return true if a response will be sent back on this connection
+     */
+    bool onMessage(Transport *transport, uint32_t connectionId, const uint8_t *data, size_t len,
+                   Encoding encoding = Encoding::JSON);
+
+    void registerResource(const MCPResource &resource);
+    void unregisterResource(const std::string &uri);
+
+    /**
+     * Update a resource's value; clients are notified as its NotifyPolicy allows
+     * @param uri Resource URI
+     * @param value New value (also served by resources/read unless the resource has a reader)
+     * @return false if the resource does not exist
+     */
+    bool setResourceValue(const std::string &uri, const std::string &value);
+
+    /**
+     * Replace a resource's notification policy (deadband, min/max interval)
+     * @return false if the resource does not exist
+     */
+    bool setNotifyPolicy(const std::string &uri, const NotifyPolicy::Config &config);
+
+    /**
+     * Register a family of resources served through one URI template
+     * @param resourceTemplate Template, listed by resources/templates/list; its
+     *        reader serves resources/read for every matching URI
+     * @return false if the template is malformed or clashes with another
+     */
+    bool registerResourceTemplate(const MCPResourceTemplate &resourceTemplate);
+
+    void registerTool(const MCPTool &tool);
+
     void handleInitialize(uint8_t clientId, const RequestId &id, const JsonObject &params);
     void handleResourcesList(uint8_t clientId, const RequestId &id, const JsonObject &params);
     void handleResourceRead(uint8_t clientId, const RequestId &id, const JsonObject &params);
+    void sendBlob(uint8_t clientId, const RequestId &id, const char *uri, const std::string &mimeType,
+                  const BlobSource &blob, const JsonObject &params);
+    void handleResourceTemplatesList(uint8_t clientId, const RequestId &id, const JsonObject &params);
     void handleResourceWrite(uint8_t clientId, const RequestId &id, const JsonObject &params);
     void handleSubscribe(uint8_t clientId, const RequestId &id, const JsonObject &params);
     void handleUnsubscribe(uint8_t clientId, const RequestId &id, const JsonObject &params);
-    void unregisterResource(const std::string &uri);
+    void handleToolsList(uint8_t clientId, const RequestId &id, const JsonObject &params);
+    void handleToolsCall(uint8_t clientId, const RequestId &id, const JsonObject &params);
+    void handleSetLogLevel(uint8_t clientId, const RequestId &id, const JsonObject &params);
     void sendResponse(uint8_t clientId, const RequestId &id, const MCPResponse &response);
     void sendError(uint8_t clientId, const RequestId &id, int code, const std::string &message);
     void broadcastResourceUpdate(const std::string &uri);
 
 private:
+    static constexpr size_t REQUEST_QUEUE_SIZE = 16;
+    static constexpr uint32_t NOTIFY_POLL_INTERVAL = 100; // Coalesced changes and heartbeats (ms)
+    static constexpr size_t DEFAULT_COMPRESSION_THRESHOLD = 512;
+    static constexpr size_t INITIALIZE_SIZE_HINT = 384;
+    static constexpr size_t DEFAULT_PAGE_SIZE = 16;
+    static constexpr size_t MAX_BLOB_CHUNK = 3072;     // Bytes per blob read; 4 KB once base64 encoded
+    static constexpr size_t BLOB_ENVELOPE_SIZE = 160;  // Response around the base64 text, less URI and MIME type
+    static constexpr size_t PING_PAYLOAD_SIZE = 8; // Sequence number and send time (micros)
+    static constexpr uint32_t LOG_FLUSH_INTERVAL = 250;  // ms between notifications/message batches
+    static constexpr size_t MAX_LOG_BATCH = 32;          // Lines per batch; one bit each in a mask
+    static constexpr uint16_t DEFAULT_LOG_RATE = 20;     // Lines per second per client
+    static constexpr uint16_t DEFAULT_LOG_BURST = 40;
+    static constexpr uint32_t LOG_REFILL_CAP = 60000;    // ms of refill counted at most, against overflow
+    // First byte of a compressed binary frame; raw deflate data follows
+    static constexpr uint8_t FRAME_DEFLATE_JSON = 0x01;
+    static constexpr uint8_t FRAME_DEFLATE_MSGPACK = 0x02;
+
+    // Snapshot of a session taken under sessionsMutex for one send
+    struct Route {
+        Transport *transport;
+        uint32_t connectionId;
+        Encoding encoding;
+        bool compress;
+    };
+
     uint16_t port_;
     Implementation serverInfo{"esp32-mcp-server", "1.0.0"};
     ServerCapabilities capabilities{true, true};
 
-    MCPRequest parseRequest(const std::string &json);
+    std::vector<Transport *> transports;
+    SessionTable sessions;            // Indexed by client id; guarded by sessionsMutex
+    AdmissionControl admission;       // Guarded by sessionsMutex
+    Heartbeat heartbeat;              // Guarded by sessionsMutex
+    std::mutex sessionsMutex;
+    uint16_t logRate = DEFAULT_LOG_RATE;     // Guarded by sessionsMutex
+    uint16_t logBurst = DEFAULT_LOG_BURST;   // Guarded by sessionsMutex
+    uint32_t lastLogFlush = 0;
+    uint32_t tapDropped = 0;         // LogTap::getDropped() already reported
+
+    std::map<std::string, MCPResource> resources;
+    std::map<std::string, MCPTool> tools;
+    std::map<std::string, MCPResourceTemplate> resourceTemplates;  // By uriTemplate, for listing
+    std::vector<const MCPResourceTemplate *> templatesById;         // By UriTemplateMatcher id
+    UriTemplateMatcher templateMatcher;
+    std::vector<std::string> dueUpdates;   // Notifications to send from the MCP task
+    uint32_t lastNotifyPoll = 0;
+    size_t pageSize = DEFAULT_PAGE_SIZE;
+    std::mutex registryMutex;
+
+    FrameParser frameParser;
+    RequestQueue<MCPRequest> requestQueue{REQUEST_QUEUE_SIZE};
+    RequestTrace *activeTrace = nullptr;            // Request being dispatched; read through currentTrace()
+    std::atomic<TaskHandle_t> dispatchTask{nullptr}; // Task that runs dispatch()
+
+    Deflate deflater;                 // Guarded by deflateMutex
+    std::mutex deflateMutex;
+    size_t compressionThreshold = DEFAULT_COMPRESSION_THRESHOLD;
+
+    void dispatch(MCPRequest &request);
+
+    /**
+     * Trace of the request being dispatched, when called from the dispatching
+     * task; nullptr on transport tasks, whose sends (pings, admission and
+     * parse errors) belong to no dispatched request
+     */
+    RequestTrace *currentTrace();
+    void markSerialized();  // Response encoded; stamps the current trace, if any
+    void evictIdleClients();
+    void pingClients();
+    bool answerPing(uint8_t clientId, const MCPRequest &request);
+    void flushResourceUpdates();
+    void flushLogs();
+    void updateLogTap();
+    MCPRequest parseFrame(uint8_t clientId, const uint8_t *data, size_t len, Encoding encoding,
+                          DeserializationError &error);
+    bool supportsBinary(uint8_t clientId);
+    bool findRoute(uint8_t clientId, Route &route);
+    bool transmit(uint8_t clientId, const JsonDocument &doc);
+    bool deliver(const Route &route, const PooledBuffer &buffer, bool binary);
+    bool transmitJson(uint8_t clientId, const PooledBuffer &buffer);
+    bool replay(uint8_t clientId, const RequestId &id);
+
+    /**
+     * Send a fixed-shape message streamed by a JsonWriter instead of a document
+     * @param sizeHint Expected length; a larger message costs an extra measuring pass
+     * @param build Callable taking any JsonWriter<Output>& and writing the message
+     */
+    template <typename Build>
+    bool transmitWritten(uint8_t clientId, size_t sizeHint, Build build);
+    bool transmitCompressed(Transport *transport, uint32_t connectionId, const PooledBuffer &buffer, bool binary);
     std::string serializeResponse(const RequestId &id, const MCPResponse &response);
 };
 
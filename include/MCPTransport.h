@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace mcp {
+
+class MCPServer;
+
+/**
+ * Wire encoding of a frame. JSON unless MessagePack was negotiated in
+ * initialize; MessagePack needs a transport with binary frames.
+ */
+enum class Encoding : uint8_t {
+    JSON,
+    MSGPACK
+};
+
+/**
+ * A connection-oriented carrier of MCP frames (WebSocket, raw TCP, HTTP).
+ *
+ * Transports own their sockets and framing. They report connections and
+ * complete frames to the MCPServer they are attached to, which assigns each
+ * connection a small client id and runs the single dispatcher. Responses come
+ * back through send() keyed by the transport's own connection id.
+ */
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    /**
+     * Short name used in logs and metrics (e.g. "ws", "tcp", "http")
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * Start accepting connections
+     * @return true if the transport is listening
+     */
+    virtual bool begin() = 0;
+
+    /**
+     * Periodic work on the MCP task (timeouts, polling sockets)
+     */
+    virtual void poll() {}
+
+    /**
+     * Send one complete frame to a connection
+     * @param connectionId Transport-specific connection id
+     * @param data Frame bytes
+     * @param len Frame length
+     * @return false if the connection is gone or its send buffer is full
+     */
+    virtual bool send(uint32_t connectionId, const char* data, size_t len) = 0;
+
+    /**
+     * Whether the transport can carry binary frames (see sendBinary())
+     */
+    virtual bool supportsBinary() const { return false; }
+
+    /**
+     * Send one complete binary frame (MessagePack-encoded message)
+     * @return false if unsupported, or as send()
+     */
+    virtual bool sendBinary(uint32_t connectionId, const uint8_t* data, size_t len) { return false; }
+
+    /**
+     * Whether the transport has protocol-level pings (see ping())
+     */
+    virtual bool supportsPing() const { return false; }
+
+    /**
+     * Send a liveness ping; the peer's pong goes to MCPServer::onPong()
+     * @param payload Bytes the pong must echo
+     */
+    virtual bool ping(uint32_t connectionId, const uint8_t* payload, size_t len) { return false; }
+
+    /**
+     * Close a connection from the server side
+     */
+    virtual void close(uint32_t connectionId) = 0;
+
+    /**
+     * Drop a connection whose peer stopped answering, without a closing
+     * handshake that would wait on it; defaults to close()
+     */
+    virtual void abort(uint32_t connectionId) { close(connectionId); }
+
+    void attach(MCPServer* owner) { server = owner; }
+
+protected:
+    MCPServer* server = nullptr;
+};
+
+} // namespace mcp
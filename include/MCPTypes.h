@@ -3,35 +3,87 @@
 
 #include <ArduinoJson.h>
 #include <string>
+#include <functional>
+#include "MemoryPool.h"
+#include "RequestTracer.h"
+#include "NotifyPolicy.h"
+#include "UriTemplate.h"
+#include "RequestId.h"
+#include "MCPRequestType.h"
 
 namespace mcp {
 
-enum class MCPRequestType {
-    INITIALIZE,
-    RESOURCES_LIST,
-    RESOURCE_READ,
-    SUBSCRIBE,
-    UNSUBSCRIBE
-};
-
-using RequestId = uint32_t;
-
+/**
+ * A parsed request that owns its JSON document.
+ *
+ * The document is allocated from MemoryPool and travels with the request, so
+ * a request can be moved through a RequestQueue to a worker task without
+ * copying and without dangling views. Move-only: copying would duplicate the
+ * document.
+ *
+ * params() is derived on each call because JsonObject handles point into the
+ * document's storage and do not survive a move.
+ */
 struct MCPRequest {
     MCPRequestType type;
     RequestId id;
-    JsonObject params;
+    uint8_t clientId;
+    JsonDocument doc;
+    RequestTrace trace;
+
+    MCPRequest()
+        : type(MCPRequestType::UNKNOWN), clientId(0), doc(&MemoryPool::getInstance()) {}
 
-    MCPRequest() : type(MCPRequestType::INITIALIZE), id(0), params() {}
+    MCPRequest(MCPRequest&&) = default;
+    MCPRequest& operator=(MCPRequest&&) = default;
+    MCPRequest(const MCPRequest&) = delete;
+    MCPRequest& operator=(const MCPRequest&) = delete;
+
+    JsonObject params() { return doc["params"].as<JsonObject>(); }
+    const char* method() const { return doc["method"] | ""; }
 };
 
+/**
+ * A handler result that owns its payload document (MemoryPool-backed).
+ * Handlers build directly into data, so nothing is copied on the way out.
+ */
 struct MCPResponse {
     bool success;
     std::string message;
-    JsonVariant data;
+    JsonDocument data;
+
+    MCPResponse() : success(false), message(""), data(&MemoryPool::getInstance()) {}
+    MCPResponse(bool s, const std::string &msg)
+        : success(s), message(msg), data(&MemoryPool::getInstance()) {}
 
-    MCPResponse() : success(false), message(""), data() {}
-    MCPResponse(bool s, const std::string &msg, JsonVariant d)
-        : success(s), message(msg), data(d) {}
+    MCPResponse(MCPResponse&&) = default;
+    MCPResponse& operator=(MCPResponse&&) = default;
+    MCPResponse(const MCPResponse&) = delete;
+    MCPResponse& operator=(const MCPResponse&) = delete;
+};
+
+/**
+ * Produces the current text of a dynamic resource
+ */
+using ResourceReader = std::function<std::string()>;
+
+/**
+ * Reads part of a binary resource
+ * @param offset Byte offset into the resource
+ * @param buffer Destination
+ * @param len Number of bytes wanted
+ * @return Number of bytes read; fewer than len only at the end of the resource
+ */
+using BlobReader = std::function<size_t(size_t offset, uint8_t *buffer, size_t len)>;
+
+/**
+ * Binary content of a resource, read in ranges so it never has to fit in RAM
+ */
+struct BlobSource {
+    std::function<size_t()> size;
+    BlobReader read;
+
+    explicit operator bool() const { return size && read; }
 };
 
 struct MCPResource {
@@ -39,11 +91,84 @@ struct MCPResource {
     std::string uri;
     std::string type;
     std::string value;
+    ResourceReader reader; // Optional; value is served when empty
+    BlobSource blob;       // Optional; makes the resource binary, read in chunks
+    NotifyPolicy notify;   // When a setResourceValue() change is announced to clients
 
-    MCPResource(const std::string &n, const std::string &u, const std::string &t, const std::string &v)
-        : name(n), uri(u), type(t), value(v) {}
+    MCPResource(const std::string &n, const std::string &u, const std::string &t, const std::string &v,
+                ResourceReader r = nullptr)
+        : name(n), uri(u), type(t), value(v), reader(std::move(r)) {}
+};
+
+/**
+ * Produces the text of one instance of a templated resource
+ * @param params Variables captured from the requested URI
+ * @return false if no such instance exists
+ */
+using ResourceTemplateReader = std::function<bool(const UriParams &params, std::string &text)>;
+
+struct MCPResourceTemplate {
+    std::string name;
+    std::string uriTemplate;  // e.g. sensor://{bus}/{addr:int}/temperature (see UriTemplateMatcher)
+    std::string mimeType;
+    std::string description;
+    ResourceTemplateReader reader;
+};
+
+/**
+ * Runs a tool call; writes the result text and returns false to flag isError
+ */
+using ToolHandler = std::function<bool(JsonObjectConst arguments, std::string &text)>;
+
+struct MCPTool {
+    std::string name;
+    std::string description;
+    std::string inputSchema; // JSON Schema, as JSON text
+    ToolHandler handler;
 };
 
 } // namespace mcp
 
+namespace ArduinoJson {
+
+/**
+ * Lets documents hold a RequestId: doc["id"] = id, doc["id"].as<RequestId>()
+ */
+template <>
+struct Converter<mcp::RequestId> {
+    static void toJson(const mcp::RequestId &id, JsonVariant dst) {
+        switch (id.kind()) {
+            case mcp::RequestId::Kind::INTEGER:
+                dst.set(id.integer());
+                break;
+            case mcp::RequestId::Kind::STRING:
+                dst.set(const_cast<char *>(id.text()));  // char* is copied into the document
+                break;
+            default:
+                dst.clear();
+                break;
+        }
+    }
+
+    static mcp::RequestId fromJson(JsonVariantConst src) {
+        if (src.isNull()) {
+            return mcp::RequestId();
+        }
+        if (src.is<const char *>()) {
+            JsonString text = src.as<JsonString>();
+            return mcp::RequestId(text.c_str(), text.size());
+        }
+        if (src.is<int64_t>()) {
+            return mcp::RequestId(src.as<int64_t>());
+        }
+        return mcp::RequestId::invalid();
+    }
+
+    static bool checkJson(JsonVariantConst src) {
+        return fromJson(src).isValid();
+    }
+};
+
+} // namespace ArduinoJson
+
 #endif // MCP_TYPES_H
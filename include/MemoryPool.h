@@ -0,0 +1,142 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <mutex>
+
+namespace mcp {
+
+/**
+ * Size-classed fixed-block allocator over a statically reserved arena.
+ *
+ * JSON documents and frame buffers are allocated from here instead of the
+ * general heap, so their churn cannot fragment it over long uptimes. Each
+ * size class keeps an intrusive free list; a request that no class can
+ * satisfy falls back to malloc and is counted.
+ *
+ * Implements ArduinoJson::Allocator so it can back any JsonDocument:
+ *     JsonDocument doc(&MemoryPool::getInstance());
+ */
+class MemoryPool : public ArduinoJson::Allocator {
+public:
+    static constexpr size_t CLASS_COUNT = 5;
+    static constexpr size_t BLOCK_SIZES[CLASS_COUNT] = {32, 64, 256, 1024, 8192};
+    static constexpr size_t BLOCK_COUNTS[CLASS_COUNT] = {64, 32, 16, 12, 2};
+    // Larger classes a request may take when its own is exhausted; never the
+    // largest, whose few blocks are kept for the frames that need them
+    static constexpr size_t MAX_SPILL = 1;
+
+    struct ClassStats {
+        size_t blockSize;
+        size_t capacity;
+        size_t inUse;
+        size_t highWater;
+    };
+
+    static MemoryPool& getInstance() {
+        static MemoryPool instance;
+        return instance;
+    }
+
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr) override;
+    void* reallocate(void* ptr, size_t newSize) override;
+
+    /**
+     * Get usage statistics for a size class
+     * @param index Class index (0 .. CLASS_COUNT-1)
+     */
+    ClassStats getClassStats(size_t index);
+
+    /**
+     * Number of requests served from the general heap because no block fit
+     */
+    uint32_t getFallbackCount();
+
+    /**
+     * Number of requests that could not be served at all
+     */
+    uint32_t getFailureCount();
+
+    /**
+     * Publish per-class high-water/in-use gauges and fallback/failure
+     * counters to MetricsSystem (called periodically)
+     */
+    void publishMetrics();
+
+private:
+    MemoryPool();
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct SizeClass {
+        uint8_t* begin;
+        uint8_t* end;
+        FreeBlock* freeList;
+        size_t inUse;
+        size_t highWater;
+    };
+
+    std::mutex mutex;
+    SizeClass classes[CLASS_COUNT];
+    uint32_t fallbacks;
+    uint32_t failures;
+    uint32_t publishedFallbacks;
+    uint32_t publishedFailures;
+    bool metricsRegistered;
+
+    int classOf(const void* ptr) const;
+    void* takeBlock(size_t size);
+};
+
+/**
+ * Move-only byte buffer backed by MemoryPool, for frame assembly and
+ * serialized responses.
+ */
+class PooledBuffer {
+public:
+    PooledBuffer() : data_(nullptr), capacity_(0), length_(0) {}
+    explicit PooledBuffer(size_t capacity);
+    ~PooledBuffer();
+
+    PooledBuffer(PooledBuffer&& other) noexcept;
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept;
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    /**
+     * Append bytes, failing rather than growing past capacity
+     * @return false if the data does not fit
+     */
+    bool append(const void* bytes, size_t len);
+
+    /**
+     * Grow to hold at least capacity bytes, keeping the contents
+     * @return false if the larger block could not be allocated
+     */
+    bool reserve(size_t capacity);
+
+    /**
+     * Drop bytes from the front, keeping the rest in order
+     */
+    void consume(size_t len);
+
+    void clear() { length_ = 0; }
+    bool valid() const { return data_ != nullptr; }
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+    size_t length() const { return length_; }
+    size_t capacity() const { return capacity_; }
+    void setLength(size_t len) { length_ = len < capacity_ ? len : capacity_; }
+
+private:
+    char* data_;
+    size_t capacity_;
+    size_t length_;
+};
+
+} // namespace mcp
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Arduino.h>
+#include "MetricsSystem.h"
+
+namespace mcp {
+
+/**
+ * Incremental walker that renders MetricsSystem contents for HTTP export.
+ *
+ * Output is produced one metric at a time into the caller's buffer, so it can
+ * back an AsyncWebServer chunked response without ever holding the whole
+ * payload in RAM. The walker resumes by metric name, which keeps it valid even
+ * if metrics are registered between chunks.
+ */
+class MetricsExporter {
+public:
+    enum class Format {
+        OPENMETRICS,  // OpenMetrics 1.0 text exposition
+        STATS_JSON,   // Dashboard JSON consumed by metrics_stats.html
+        METRICS_DELTA // {"seq","since","metrics"} holding only metrics changed after a sequence
+    };
+
+    static constexpr const char* OPENMETRICS_CONTENT_TYPE =
+        "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+    /**
+     * @param format Output format
+     * @param allTime For STATS_JSON, summarize persisted history instead of since-boot values
+     * @param changedSince For METRICS_DELTA, the change sequence the reader already has (0 for all)
+     */
+    explicit MetricsExporter(Format format, bool allTime = false, uint32_t changedSince = 0);
+
+    /**
+     * Change sequence the export is consistent with; metrics changed later
+     * may or may not be included and will be sent again in the next delta
+     */
+    uint32_t getSequence() const { return sequence; }
+
+    /**
+     * Copy the next piece of output into a buffer
+     * @param buffer Destination
+     * @param maxLen Capacity of destination
+     * @return Bytes written; 0 once the export is complete
+     */
+    size_t fill(uint8_t* buffer, size_t maxLen);
+
+private:
+    enum class Stage {
+        HEADER,
+        METRICS,
+        FOOTER,
+        DONE
+    };
+
+    Format format;
+    bool allTime;
+    uint32_t changedSince;
+    uint32_t sequence;
+    Stage stage;
+    String cursor;        // Name of the last metric rendered
+    bool firstMetric;
+    String pending;       // Rendered text not yet copied out
+    size_t pendingOffset;
+
+    void renderNext();
+    void renderStatsHeader();
+    void renderDeltaHeader();
+    void renderOpenMetrics(const MetricsSystem::MetricInfo& info, const MetricValue& value);
+    void renderStatsMetric(const MetricsSystem::MetricInfo& info, const MetricValue& value);
+
+    static String sanitizeName(const String& name);
+    static String formatNumber(double value);
+};
+
+} // namespace mcp
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+namespace mcp {
+
+/**
+ * Server-Sent Events feed of metric changes on /events/metrics.
+ *
+ * A client receives a "snapshot" event with every metric when it connects,
+ * then "delta" events holding only the metrics whose values changed since
+ * the previous event. Each payload carries {"seq","since"}; values are
+ * absolute, so a delta applies to any state at or after "since". A client
+ * whose last seen seq is older than "since" has missed an event and should
+ * reconnect to get a fresh snapshot.
+ *
+ * Deltas are coalesced while the SSE send queues are backed up: the tick is
+ * skipped, and the next delta covers everything changed in between.
+ */
+class MetricsStream {
+public:
+    static constexpr const char* ENDPOINT = "/events/metrics";
+    static constexpr uint32_t DEFAULT_INTERVAL = 1000;   // ms between deltas
+    static constexpr uint32_t MIN_INTERVAL = 100;
+    static constexpr uint32_t MAX_PACKETS_WAITING = 2;   // Coalesce above this queue depth
+    static constexpr uint32_t RECONNECT_DELAY = 3000;    // Client retry hint, ms
+
+    MetricsStream();
+
+    /**
+     * Register the SSE endpoint (safe to call more than once)
+     * @param server Web server to attach to
+     */
+    void begin(AsyncWebServer& server);
+
+    /**
+     * Set the minimum time between delta events
+     * @param intervalMs Interval in milliseconds (clamped to MIN_INTERVAL)
+     */
+    void setInterval(uint32_t intervalMs);
+    uint32_t getInterval() const { return interval; }
+
+    /**
+     * Push a delta if the interval elapsed and anything changed; call periodically
+     */
+    void poll();
+
+private:
+    AsyncEventSource events;
+    uint32_t interval;
+    uint32_t lastPush;
+    uint32_t sentSequence;  // Change sequence covered by the last delta
+    bool started;
+
+    /**
+     * Render the metrics changed after a sequence
+     * @param changedSince Sequence the reader already has (0 for a full snapshot)
+     * @param sequence Receives the sequence the payload is consistent with
+     */
+    static String render(uint32_t changedSince, uint32_t& sequence);
+};
+
+} // namespace mcp
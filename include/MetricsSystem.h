@@ -9,6 +9,13 @@
 #include "uLogger.h"
 
 namespace mcp{
+// Upper bounds of the fixed histogram buckets; samples above the last bound
+// land in the overflow bucket. Tuned for millisecond latencies.
+static constexpr double HISTOGRAM_BOUNDS[] = {
+    0.1, 0.25, 0.5, 1, 2.5, 5, 10, 25, 50, 100, 250, 500, 1000
+};
+static constexpr size_t HISTOGRAM_BUCKETS = sizeof(HISTOGRAM_BOUNDS) / sizeof(HISTOGRAM_BOUNDS[0]) + 1;
+
 struct MetricValue {
         uint64_t timestamp;
         union {
@@ -20,6 +27,7 @@ struct MetricValue {
                 double max;      // Maximum value
                 double sum;      // Sum of all values
                 uint32_t count;  // Number of values
+                uint32_t buckets[HISTOGRAM_BUCKETS]; // Per-bucket sample counts
             } histogram;
         };
     };
@@ -112,6 +120,21 @@ public:
      */
     void recordHistogram(const String& name, double value);
 
+    /**
+     * Check whether a metric has been registered
+     * @param name Metric identifier
+     * @return true if the metric exists
+     */
+    bool hasMetric(const String& name);
+
+    /**
+     * Estimate a quantile from histogram buckets
+     * @param value Histogram metric value
+     * @param quantile Quantile in range [0, 1] (e.g. 0.99)
+     * @return Estimated value at the requested quantile
+     */
+    static double histogramQuantile(const MetricValue& value, double quantile);
+
     /**
      * Get current value of a metric
      * @param name Metric identifier
@@ -120,6 +143,22 @@ public:
      */
     MetricValue getMetric(const String& name, bool fromBoot = true);
 
+    /**
+     * All-time value of a metric without reading flash, for callers on the
+     * web server task. Served from a summary of the history log kept by
+     * summarizeHistory(); a name is summarized from its first request on,
+     * and reads as empty until then.
+     * @param name Metric identifier
+     * @return Summary as of the last refresh
+     */
+    MetricValue getHistorySummary(const String& name);
+
+    /**
+     * Summarize newly requested names, or all of them with all = true; the
+     * log scan happens here (called periodically from the MCP task)
+     */
+    void summarizeHistory(bool all = false);
+
     /**
      * Get historical values for a metric
      * @param name Metric identifier
@@ -136,10 +175,34 @@ public:
     std::map<String, MetricInfo> getMetrics(const String& category = "");
 
     /**
-     * Update system metrics (called periodically)
+     * Fetch the metric that sorts after a given name, for incremental walks
+     * that must not copy the whole registry (e.g. streamed HTTP exports)
+     * @param after Name of the previously visited metric ("" to start)
+     * @param info Receives the metric information
+     * @param value Receives the since-boot value
+     * @param changedSince Skip metrics not modified after this change sequence (0 for all)
+     * @return false when there are no more metrics
+     */
+    bool nextMetric(const String& after, MetricInfo& info, MetricValue& value,
+                    uint32_t changedSince = 0);
+
+    /**
+     * Current change sequence; bumped every time any metric value changes
+     * @return Sequence number of the most recent change
+     */
+    uint32_t getChangeSequence();
+
+    /**
+     * Refresh the system gauges (called periodically; no flash access)
      */
     void updateSystemMetrics();
 
+    /**
+     * Append a history snapshot and, if a metric definition changed, save
+     * the definitions (called at the much longer persistence interval)
+     */
+    void persist();
+
     /**
      * Reset boot-time metrics
      */
@@ -162,6 +225,21 @@ public:
      */
     void clearHistory();
 
+    /**
+     * Get the size of the historical metric log
+     * @return Size in bytes
+     */
+    size_t getHistorySize();
+
+    /**
+     * Read raw bytes of the historical metric log
+     * @param offset Byte offset into the log
+     * @param buffer Destination buffer
+     * @param len Maximum number of bytes to read
+     * @return Number of bytes read
+     */
+    size_t readHistory(size_t offset, uint8_t* buffer, size_t len);
+
     /**
      * Check if metrics system is initialized
      * @return true if initialized
@@ -174,18 +252,25 @@ private:
     MetricsSystem(const MetricsSystem&) = delete;
     MetricsSystem& operator=(const MetricsSystem&) = delete;
 
-    static std::mutex metricsMutex;
+    static std::recursive_mutex metricsMutex;
     bool initialized;
-    uint32_t lastSaveTime;
+    bool definitionsDirty;  // Registry differs from the boot metrics file
 
     std::map<String, MetricInfo> metrics;
     std::map<String, MetricValue> bootMetrics;
+    std::map<String, int64_t> loggedCounters; // Counter values at last history snapshot
+    std::map<String, uint32_t> changedAt;     // Change sequence of each metric's last update
+    std::map<String, MetricValue> historySummaries;  // getHistorySummary() results
+    std::vector<String> pendingSummaries;            // Requested, not yet summarized
+    uint32_t changeSequence;
     uLogger logger;
 
     void initializeSystemMetrics();
     void registerMetric(const String& name, MetricType type, const String& description,
                        const String& unit = "", const String& category = "");
     MetricValue calculateHistogram(const std::vector<MetricValue>& values);
+    MetricValue summarize(const String& name, MetricType type);
+    void snapshotHistory();
 };
 
 /**
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace mcp {
+
+/**
+ * Table-driven WiFi connection state machine.
+ *
+ * Driven by WiFi events (got IP, disconnect with reason code) and by a
+ * single timeout timer; nothing is polled. handle() looks the (state, event)
+ * pair up in the transition table, moves to the next state and returns the
+ * action the owner must perform. Pairs missing from the table are ignored.
+ *
+ * The machine knows nothing about WiFi APIs or time sources, so recorded
+ * event traces can be replayed against it off-device.
+ */
+class NetworkStateMachine {
+public:
+    enum class State : uint8_t {
+        INIT,
+        CONNECTING,
+        CONNECTED,
+        CONNECTION_FAILED,  // Between attempts, waiting for the retry timer
+        AP_MODE
+    };
+
+    enum class Event : uint8_t {
+        NONE,
+        START_STA,          // Boot with stored credentials
+        START_AP,           // Boot without credentials
+        GOT_IP,             // ARDUINO_EVENT_WIFI_STA_GOT_IP
+        DISCONNECTED,       // ARDUINO_EVENT_WIFI_STA_DISCONNECTED (see reason)
+        TIMEOUT,            // Armed timer expired
+        RETRY,              // Try the next network now
+        GIVE_UP,            // No more attempts: fall back to AP mode
+        CREDENTIALS_SAVED   // User entered a network
+    };
+
+    enum class Action : uint8_t {
+        NONE,
+        BEGIN_CONNECT,      // Start an attempt and arm its timeout
+        ON_CONNECTED,       // Link is up
+        ON_CONNECT_FAILED,  // Attempt failed: retry, back off or give up
+        ON_LINK_LOST,       // Established link dropped: back off and reconnect
+        ON_LEASE,           // DHCP bound or renewed the address while connected
+        START_AP            // Bring up the configuration access point
+    };
+
+    static constexpr uint8_t REASON_ASSOC_LEAVE = 8; // WIFI_REASON_ASSOC_LEAVE
+
+    struct Transition {
+        State from;
+        Event event;
+        State to;
+        Action action;
+    };
+
+    NetworkStateMachine();
+
+    State getState() const { return state; }
+
+    /**
+     * Apply an event
+     * @param event Event to apply
+     * @param reason Disconnect reason code (wifi_err_reason_t) for DISCONNECTED
+     * @return Action the owner must perform (NONE if the event was ignored)
+     */
+    Action handle(Event event, uint8_t reason = 0);
+
+    /**
+     * Arm the timeout timer; any transition disarms it
+     * @param now Current time in ms
+     * @param duration Time until TIMEOUT fires
+     */
+    void armTimer(uint32_t now, uint32_t duration);
+
+    bool isTimerArmed() const { return timerArmed; }
+
+    /**
+     * Time left until the timer fires
+     * @return Milliseconds, 0 if expired, UINT32_MAX if not armed
+     */
+    uint32_t timeUntilTimeout(uint32_t now) const;
+
+    /**
+     * Fire TIMEOUT if the timer has expired
+     * @return Action for the timeout, NONE if nothing fired
+     */
+    Action poll(uint32_t now);
+
+    /**
+     * Reason code of the last DISCONNECTED event
+     */
+    uint8_t getLastReason() const { return lastReason; }
+
+    /**
+     * Whether a disconnect reason means the credentials were rejected
+     * (retrying the same network will not help)
+     */
+    static bool isAuthFailure(uint8_t reason);
+
+    static const char* stateName(State state);
+    static const char* eventName(Event event);
+
+private:
+    static const Transition TRANSITIONS[];
+    static const size_t TRANSITION_COUNT;
+
+    State state;
+    bool timerArmed;
+    uint32_t timerStart;
+    uint32_t timerDuration;
+    uint8_t lastReason;
+};
+
+} // namespace mcp
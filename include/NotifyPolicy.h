@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+namespace mcp {
+
+/**
+ * Decides when a resource value change is worth a
+ * notifications/resources/updated message.
+ *
+ * A new value is significant if it differs from the last *notified* value
+ * by at least the deadband (absolute, or percent of the last notified
+ * value), so slow drift still notifies once it adds up. Non-numeric values
+ * are significant whenever the text changes. Significant changes closer
+ * together than minInterval are coalesced into one notification sent when
+ * the interval has passed; maxInterval sends a heartbeat when nothing
+ * significant happened for that long.
+ *
+ * update() is called on every value set and costs one strtod and a
+ * compare. Not thread-safe; the owner serializes access.
+ */
+class NotifyPolicy {
+public:
+    struct Config {
+        float deadband;          // Smallest change worth a notification (0 = any change)
+        bool deadbandPercent;    // deadband is a percentage of the last notified value
+        uint32_t minInterval;    // ms between notifications; faster changes coalesce
+        uint32_t maxInterval;    // ms without a notification before a heartbeat (0 = never)
+    };
+
+    static constexpr Config DEFAULT_CONFIG = {0.0f, false, 0, 0};
+
+    explicit NotifyPolicy(const Config &config = DEFAULT_CONFIG);
+
+    void setConfig(const Config &config) { this->config = config; }
+    const Config &getConfig() const { return config; }
+
+    /**
+     * Set the baseline without notifying (e.g. at registration)
+     * @param value Current value
+     * @param now Current time in ms
+     */
+    void reset(const std::string &value, uint32_t now);
+
+    /**
+     * Evaluate a newly set value
+     * @param value New value
+     * @param now Current time in ms
+     * @return true if a notification should be sent now
+     */
+    bool update(const std::string &value, uint32_t now);
+
+    /**
+     * Check for coalesced changes and heartbeats
+     * @param now Current time in ms
+     * @return true if a notification should be sent now
+     */
+    bool poll(uint32_t now);
+
+    /**
+     * Whether a coalesced change is waiting for minInterval to pass
+     */
+    bool isPending() const { return pending; }
+
+private:
+    Config config;
+    std::string lastText;        // Last notified value
+    double lastNumber;
+    bool lastNumeric;
+    uint32_t lastSent;
+    bool pending;
+    std::string pendingText;
+    double pendingNumber;
+    bool pendingNumeric;
+
+    bool isSignificant(const std::string &text, double number, bool numeric) const;
+    void markSent(const std::string &text, double number, bool numeric, uint32_t now);
+    static bool parseNumber(const std::string &text, double &number);
+};
+
+} // namespace mcp
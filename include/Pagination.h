@@ -0,0 +1,28 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include <iterator>
+
+namespace mcp {
+
+/**
+ * Add one page of registry entries to a list result. Registries are ordered
+ * maps, so a page is the entries after the cursor key and the cursor stays
+ * valid when entries are added or removed between requests. A cursor that
+ * names no entry resumes after the position it would sort into.
+ * @param cursor Last key of the previous page, or nullptr for the first page
+ * @param result Receives nextCursor when entries remain after the page
+ * @param add Called with each entry of the page
+ */
+template <typename Registry, typename Add>
+void addPage(const Registry &registry, const char *cursor, size_t pageSize, JsonObject result, Add add) {
+    auto it = cursor ? registry.upper_bound(cursor) : registry.begin();
+    for (size_t count = 0; it != registry.end() && count < pageSize; ++it, ++count) {
+        add(it->second);
+    }
+    if (it != registry.end()) {
+        result["nextCursor"] = std::prev(it)->first;
+    }
+}
+
+} // namespace mcp
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace mcp {
+
+/**
+ * Exponential backoff with full jitter: the n-th delay is drawn uniformly
+ * from [0, min(maxDelay, baseDelay * 2^n)]. Spreading retries over the whole
+ * window keeps a fleet that lost the same AP from reconnecting in lockstep.
+ */
+class ExponentialBackoff {
+public:
+    static constexpr uint32_t DEFAULT_BASE_DELAY = 500;   // ms
+    static constexpr uint32_t DEFAULT_MAX_DELAY = 60000;  // ms
+
+    explicit ExponentialBackoff(uint32_t baseDelay = DEFAULT_BASE_DELAY,
+                                uint32_t maxDelay = DEFAULT_MAX_DELAY);
+
+    /**
+     * Delay before the next retry; advances the attempt count
+     * @param random Uniform random value (e.g. esp_random())
+     * @return Delay in milliseconds
+     */
+    uint32_t next(uint32_t random);
+
+    /**
+     * Upper bound of the window the next delay is drawn from
+     */
+    uint32_t window() const;
+
+    void reset() { attempt = 0; }
+    uint32_t attempts() const { return attempt; }
+
+private:
+    uint32_t baseDelay;
+    uint32_t maxDelay;
+    uint32_t attempt;
+};
+
+/**
+ * Ranks stored WiFi credentials by connection quality.
+ *
+ * Each slot keeps an exponentially weighted RSSI average and its connect
+ * successes and failures. The score blends normalized signal strength with
+ * a smoothed success rate; unknown signal counts as average so a newly
+ * added network is neither favored nor buried.
+ */
+class CredentialRanker {
+public:
+    static constexpr size_t MAX_CREDENTIALS = 4;
+    static constexpr float RSSI_ALPHA = 0.2f;        // Weight of a new RSSI sample
+    static constexpr float RSSI_FLOOR = -90.0f;      // dBm scored as 0
+    static constexpr float RSSI_CEILING = -40.0f;    // dBm scored as 1
+    static constexpr float SIGNAL_WEIGHT = 0.6f;     // Remainder weighs success rate
+    static constexpr uint16_t MAX_HISTORY = 1000;    // Counts are halved past this
+
+    // Plain layout, persisted as a blob
+    struct Stats {
+        float rssi;          // EWMA in dBm; valid when hasRssi
+        uint8_t hasRssi;
+        uint8_t reserved;
+        uint16_t successes;
+        uint16_t failures;
+    };
+
+    CredentialRanker();
+
+    void clear(size_t slot);
+    void setStats(size_t slot, const Stats& stats);
+    const Stats& getStats(size_t slot) const { return stats[slot]; }
+
+    void recordRssi(size_t slot, int rssi);
+    void recordSuccess(size_t slot);
+    void recordFailure(size_t slot);
+
+    /**
+     * Score in [0, 1]; higher is better
+     */
+    float score(size_t slot) const;
+
+    /**
+     * Order slots by descending score
+     * @param used Which slots hold a credential
+     * @param order Receives slot indices, best first
+     * @return Number of entries written
+     */
+    size_t rank(const bool used[MAX_CREDENTIALS], uint8_t order[MAX_CREDENTIALS]) const;
+
+private:
+    Stats stats[MAX_CREDENTIALS];
+
+    void trimHistory(Stats& s);
+};
+
+} // namespace mcp
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <list>
+#include <string>
+#include "RequestId.h"
+
+namespace mcp {
+
+/**
+ * Recent responses of one session by JSON-RPC request id, so a retried
+ * request is answered again without being executed again.
+ *
+ * Least recently used entries are evicted once the stored responses exceed
+ * the byte budget; a response larger than the whole budget is not kept.
+ * Ids are assumed unique within a session, as JSON-RPC requires, so an id
+ * seen before always denotes a retry; they compare as sent, so the string
+ * "1" and the number 1 are different requests.
+ *
+ * Pure bookkeeping like AdmissionControl. Not thread-safe; the caller
+ * serializes access.
+ */
+class ReplayCache {
+public:
+    static constexpr size_t DEFAULT_BUDGET = 2048;
+
+    explicit ReplayCache(size_t budget = DEFAULT_BUDGET) : budget(budget), used(0) {}
+
+    /**
+     * Change the byte budget, evicting entries that no longer fit
+     */
+    void setBudget(size_t bytes);
+
+    /**
+     * Remember the response to a request
+     * @param id Request id
+     * @param response Serialized response
+     * @param len Response length in bytes
+     * @return false if the response is larger than the budget and was not kept
+     */
+    bool store(const RequestId &id, const char *response, size_t len);
+
+    /**
+     * Look up the response to a request and mark it most recently used
+     * @param id Request id
+     * @return The serialized response, or nullptr; valid until the next change
+     */
+    const std::string *find(const RequestId &id);
+
+    void clear();
+    size_t size() const { return entries.size(); }
+    size_t bytes() const { return used; }
+
+private:
+    struct Entry {
+        RequestId id;
+        std::string response;
+    };
+
+    std::list<Entry> entries;  // Most recently used first
+    size_t budget;
+    size_t used;
+
+    void evict(size_t needed);
+};
+
+} // namespace mcp
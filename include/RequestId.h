@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace mcp {
+
+/**
+ * JSON-RPC request id as the client sent it: a string, an integer or null.
+ *
+ * Responses echo it unchanged and per-session state such as ReplayCache is
+ * keyed on it, so "7" and 7 are different ids. Strings up to MAX_LENGTH
+ * bytes are stored inline; ids that cannot be kept exactly (longer strings,
+ * fractions, other JSON types) are marked invalid and refused.
+ */
+class RequestId {
+public:
+    static constexpr size_t MAX_LENGTH = 40;  // A UUID and then some
+
+    enum class Kind : uint8_t { NONE, INTEGER, STRING, INVALID };
+
+    RequestId() : kind_(Kind::NONE), length_(0), integer_(0) { text_[0] = '\0'; }
+
+    explicit RequestId(int64_t number) : kind_(Kind::INTEGER), length_(0), integer_(number) { text_[0] = '\0'; }
+
+    RequestId(const char *text, size_t len) : kind_(Kind::STRING), length_(0), integer_(0) {
+        if (len > MAX_LENGTH) {
+            kind_ = Kind::INVALID;
+            len = 0;
+        }
+        memcpy(text_, text, len);
+        text_[len] = '\0';
+        length_ = static_cast<uint8_t>(len);
+    }
+
+    static RequestId invalid() {
+        RequestId id;
+        id.kind_ = Kind::INVALID;
+        return id;
+    }
+
+    Kind kind() const { return kind_; }
+    bool isNull() const { return kind_ == Kind::NONE; }
+    bool isValid() const { return kind_ != Kind::INVALID; }
+    bool isString() const { return kind_ == Kind::STRING; }
+
+    int64_t integer() const { return integer_; }
+    const char *text() const { return text_; }
+    size_t length() const { return length_; }
+
+    bool operator==(const RequestId &other) const {
+        if (kind_ != other.kind_) {
+            return false;
+        }
+        if (kind_ == Kind::INTEGER) {
+            return integer_ == other.integer_;
+        }
+        return length_ == other.length_ && memcmp(text_, other.text_, length_) == 0;
+    }
+
+    bool operator!=(const RequestId &other) const { return !(*this == other); }
+
+private:
+    Kind kind_;
+    uint8_t length_;
+    char text_[MAX_LENGTH + 1];
+    int64_t integer_;
+};
+
+} // namespace mcp
@@ -2,6 +2,7 @@
 
 #include <queue>
 #include <mutex>
+#include <utility>
 
 template<typename T>
 class RequestQueue {
@@ -16,13 +17,24 @@ public:
         queue.push(item);
         return true;
     }
+
+    // Move-only items (e.g. MCPRequest) are moved in; on overflow the item is
+    // left untouched so the caller can still report an error from it
+    bool push(T&& item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.size() >= maxQueueSize) {
+            return false;
+        }
+        queue.push(std::move(item));
+        return true;
+    }
     
     bool pop(T& item) {
         std::lock_guard<std::mutex> lock(mutex);
         if (queue.empty()) {
             return false;
         }
-        item = queue.front();
+        item = std::move(queue.front());
         queue.pop();
         return true;
     }
@@ -47,4 +59,4 @@ private:
     std::queue<T> queue;
     mutable std::mutex mutex;
     const size_t maxQueueSize;
-};
\ No newline at end of file
+};
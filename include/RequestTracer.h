@@ -0,0 +1,147 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <mutex>
+#include "RequestId.h"
+#include "MCPRequestType.h"
+
+namespace mcp {
+
+/**
+ * Lifecycle phases of a single MCP request, in pipeline order.
+ */
+enum class TracePhase : uint8_t {
+    RECEIVED,    // Frame arrived from the transport
+    PARSED,      // JSON deserialized
+    QUEUED,      // Pushed onto the request queue for the MCP task
+    DISPATCHED,  // Popped by the MCP task; handler about to run
+    HANDLED,     // Handler finished building the result
+    SERIALIZED,  // Response encoded and ready for the transport
+    SENT,        // Transport accepted the frame
+    COUNT
+};
+
+/**
+ * Timestamps (micros) captured for one request as it moves through the pipeline.
+ * Plain value type so it can travel with the request between tasks.
+ */
+struct RequestTrace {
+    static constexpr size_t PHASE_COUNT = static_cast<size_t>(TracePhase::COUNT);
+    static constexpr size_t MAX_METHOD_LENGTH = 24;
+
+    uint32_t stamps[PHASE_COUNT];
+    char method[MAX_METHOD_LENGTH];
+    MCPRequestType type;
+    RequestId id;
+    uint8_t clientId;
+
+    RequestTrace() : type(MCPRequestType::UNKNOWN), clientId(0) {
+        memset(stamps, 0, sizeof(stamps));
+        method[0] = '\0';
+    }
+
+    /**
+     * Start a new trace; marks RECEIVED
+     * @param client Client the frame came from
+     */
+    void begin(uint8_t client) {
+        *this = RequestTrace();
+        clientId = client;
+        mark(TracePhase::RECEIVED);
+    }
+
+    void mark(TracePhase phase) {
+        stamps[static_cast<size_t>(phase)] = micros();
+    }
+
+    /**
+     * @param name Method as the client sent it, kept for the slow ring
+     * @param requestType Parsed method; keys the latency histograms
+     */
+    void setMethod(const char* name, MCPRequestType requestType) {
+        strncpy(method, name, MAX_METHOD_LENGTH - 1);
+        method[MAX_METHOD_LENGTH - 1] = '\0';
+        type = requestType;
+    }
+
+    /**
+     * Duration between two phases in microseconds (0 if either is unset)
+     */
+    uint32_t elapsed(TracePhase from, TracePhase to) const {
+        uint32_t start = stamps[static_cast<size_t>(from)];
+        uint32_t end = stamps[static_cast<size_t>(to)];
+        return (start == 0 || end == 0) ? 0 : end - start;
+    }
+
+    uint32_t total() const {
+        return elapsed(TracePhase::RECEIVED, TracePhase::SENT);
+    }
+};
+
+/**
+ * Records completed request traces into per-method latency histograms and
+ * keeps a ring of the most recent slow requests for inspection over MCP.
+ *
+ * Histograms are named mcp.<method>.<stage> (e.g. mcp.tools_call.handler),
+ * one set per MCPRequestType, registered lazily the first time the type is
+ * seen. Methods the server does not know share mcp.other.<stage>, so clients
+ * cannot grow the metric registry by sending made-up method names.
+ */
+class RequestTracer {
+public:
+    static constexpr size_t SLOW_RING_SIZE = 16;
+    static constexpr uint32_t DEFAULT_SLOW_THRESHOLD_US = 50000; // 50 ms
+    static constexpr size_t TRACED_TYPES = static_cast<size_t>(MCPRequestType::UNKNOWN) + 1;  // UNKNOWN is "other"
+    static constexpr size_t STAGE_COUNT = 6;          // Histograms per traced method
+    static constexpr const char* SLOW_RESOURCE_URI = "metrics://mcp/slow";
+
+    static RequestTracer& getInstance() {
+        static RequestTracer instance;
+        return instance;
+    }
+
+    /**
+     * Set the total latency above which a request is kept in the slow ring
+     * @param thresholdUs Threshold in microseconds
+     */
+    void setSlowThreshold(uint32_t thresholdUs);
+
+    /**
+     * Record a finished request; expects at least RECEIVED and SENT marked
+     * @param trace Completed trace
+     */
+    void complete(const RequestTrace& trace);
+
+    /**
+     * Count a request that failed before it could be dispatched
+     */
+    void recordError();
+
+    /**
+     * Write the slow request ring (newest first) as JSON objects
+     * @param out Array to append entries to
+     */
+    void writeSlowRequests(JsonArray out);
+
+private:
+    struct SlowEntry {
+        RequestTrace trace;
+        uint32_t completedAt; // millis()
+    };
+
+    RequestTracer();
+    RequestTracer(const RequestTracer&) = delete;
+    RequestTracer& operator=(const RequestTracer&) = delete;
+
+    std::mutex mutex;
+    SlowEntry slowRing[SLOW_RING_SIZE];
+    size_t slowHead;
+    size_t slowCount;
+    uint32_t slowThresholdUs;
+    bool registered[TRACED_TYPES];
+
+    String metricPrefix(MCPRequestType type);
+};
+
+} // namespace mcp
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "MCPTransport.h"
+#include "ReplayCache.h"
+
+namespace mcp {
+
+/**
+ * Everything the server knows about one connected client
+ */
+struct Session {
+    static constexpr size_t MAX_VERSION_LENGTH = 16;
+
+    Transport *transport = nullptr;  // nullptr when the slot is free
+    uint32_t connectionId = 0;
+    bool closing = false;            // Close requested, waiting for onDisconnect
+
+    // Negotiated in initialize
+    bool initialized = false;
+    char protocolVersion[MAX_VERSION_LENGTH] = {};  // Version the client asked for
+    Encoding encoding = Encoding::JSON;             // Outgoing encoding
+    bool compress = false;                          // Deflate large messages
+
+    // Log forwarding, set by logging/setLevel
+    uint8_t logLevel = 0;            // Most verbose MCP_LOG_LEVEL_x sent; 0 (NONE) until requested
+    uint16_t logTokens = 0;          // Lines the client may still receive now (token bucket)
+    uint32_t logRefillAt = 0;        // ms
+    uint32_t logSuppressed = 0;      // Lines dropped by the rate limit, not yet reported
+    uint32_t logOverrun = 0;         // Lines lost to a full log tap, not yet reported
+
+    // Activity
+    uint32_t openedAt = 0;           // ms
+    uint32_t requests = 0;
+    uint32_t errors = 0;
+    float rtt = 0.0f;                // Last heartbeat round trip (ms); 0 until a pong
+
+    std::vector<std::string> subscriptions;  // Resource URIs, sorted
+    ReplayCache replay;                      // Recent tools/call responses
+
+    /**
+     * Add a resource subscription
+     * @return false if already subscribed
+     */
+    bool subscribe(const std::string &uri);
+
+    /**
+     * Remove a resource subscription
+     * @return false if not subscribed
+     */
+    bool unsubscribe(const std::string &uri);
+
+    bool isSubscribed(const std::string &uri) const;
+};
+
+/**
+ * Fixed-capacity table of client sessions, indexed by client id.
+ *
+ * The slot index is the client id MCPServer hands to its request handlers,
+ * so finding a request's session is an array access. A slot is bound to a
+ * transport connection when the client connects and reclaimed, with all
+ * its state, when it disconnects.
+ *
+ * Not thread-safe; the caller serializes access.
+ */
+class SessionTable {
+public:
+    static constexpr uint8_t CAPACITY = 8;
+    static constexpr int NONE = -1;
+
+    /**
+     * Bind a free slot to a connection
+     * @param now Current time in ms
+     * @return Client id, or NONE if every slot is taken
+     */
+    int open(Transport *transport, uint32_t connectionId, uint32_t now);
+
+    /**
+     * Reclaim a slot, dropping all of its state
+     */
+    void close(uint8_t clientId);
+
+    /**
+     * Client id of a connection
+     * @return Client id, or NONE if the connection has no session
+     */
+    int find(const Transport *transport, uint32_t connectionId) const;
+
+    /**
+     * Session of a client
+     * @return The session, or nullptr if the id is out of range or the slot free
+     */
+    Session *get(uint8_t clientId);
+    const Session *get(uint8_t clientId) const;
+
+    /**
+     * Slot by index, free or not, for iterating over all of them
+     */
+    Session &operator[](uint8_t clientId) { return sessions[clientId]; }
+
+    /**
+     * Number of bound slots
+     */
+    size_t active() const;
+
+    /**
+     * Byte budget of each session's replay cache, kept across sessions
+     */
+    void setReplayBudget(size_t bytes);
+
+private:
+    Session sessions[CAPACITY];
+    size_t replayBudget = ReplayCache::DEFAULT_BUDGET;
+};
+
+} // namespace mcp
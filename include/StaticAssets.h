@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <ESPAsyncWebServer.h>
+#include <map>
+#include <memory>
+
+namespace mcp {
+
+/**
+ * Serves the LittleFS web assets staged by scripts/build_assets.py.
+ *
+ * The build step stores each file gzipped (when that helps) and writes a
+ * manifest of content hashes. Responses carry the hash as a strong ETag,
+ * If-None-Match is answered with 304, and small hot pages can be pinned in
+ * RAM so they are served without touching flash.
+ *
+ * Caching: URLs requested with ?v=<hash> (rewritten into pages by the build
+ * step) are immutable; plain URLs must revalidate, which costs a 304 only.
+ * Without a manifest (data/ uploaded unstaged) files are served as-is.
+ */
+class StaticAssets : public AsyncWebHandler {
+public:
+    static constexpr const char* MANIFEST_PATH = "/assets.manifest";
+    static constexpr size_t MAX_CACHED_FILE = 4096;    // Largest file pinned in RAM
+    static constexpr size_t RAM_CACHE_BUDGET = 16384;  // Total bytes pinned in RAM
+    static constexpr const char* IMMUTABLE_CACHE = "public, max-age=31536000, immutable";
+    static constexpr const char* REVALIDATE_CACHE = "no-cache";
+
+    StaticAssets();
+
+    /**
+     * Load the asset manifest (safe to call more than once)
+     * @param fs Filesystem holding the staged assets
+     * @return true if a manifest was found
+     */
+    bool begin(fs::FS& fs);
+
+    /**
+     * Pin a file's stored bytes in RAM
+     * @param path Asset path (e.g. "/index.html")
+     * @return false if unknown, too large or over the cache budget
+     */
+    bool cache(const String& path);
+
+    /**
+     * Check whether an asset exists
+     */
+    bool exists(const String& path);
+
+    /**
+     * Answer a request with a specific asset, regardless of the request URL
+     * @param request Request to answer
+     * @param path Asset path
+     * @return false if the asset does not exist (nothing was sent)
+     */
+    bool send(AsyncWebServerRequest* request, const String& path);
+
+    /**
+     * Evaluate an If-None-Match header against an asset's ETag (weak
+     * comparison: "*", comma-separated lists and W/ tags are accepted)
+     * @param ifNoneMatch Header value
+     * @param etag Quoted ETag of the asset
+     * @return true if the client's copy is current (answer 304)
+     */
+    static bool matchesEtag(const String& ifNoneMatch, const String& etag);
+
+    // AsyncWebHandler
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+    bool isRequestHandlerTrivial() override { return true; }
+
+private:
+    struct Asset {
+        String etag;                     // Quoted content hash ("" without a manifest)
+        bool gzipped;                    // Stored as <path>.gz
+        size_t size;                     // Original (uncompressed) size
+        std::unique_ptr<uint8_t[]> ram;  // Pinned stored bytes, if cached
+        size_t ramLength;
+    };
+
+    fs::FS* fs;
+    bool hasManifest;
+    size_t cachedBytes;
+    std::map<String, Asset> assets;
+
+    Asset* find(const String& path);
+    static const char* contentType(const String& path);
+};
+
+} // namespace mcp
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace mcp {
+
+/**
+ * Per-task CPU time and stack usage, published as MetricsSystem gauges.
+ *
+ * Each sample() reads uxTaskGetSystemState() and publishes, per task of
+ * TaskTopology (other tasks would crowd the metric registry):
+ *   task.<name>.stack_free  Lowest free stack seen (bytes)
+ *   task.<name>.cpu         Share of one core since the previous sample (%)
+ * and per core:
+ *   cpu.core<N>.load        100 - idle task share (%)
+ *
+ * CPU figures need run-time stats (configGENERATE_RUN_TIME_STATS, i.e.
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS in sdkconfig); without them only
+ * the stack gauges are published. Without the trace facility nothing is.
+ */
+class TaskProfiler {
+public:
+    static constexpr size_t MAX_TASKS = 32;
+    static constexpr uint32_t SAMPLE_INTERVAL = 5000; // ms
+
+    static TaskProfiler& getInstance() {
+        static TaskProfiler instance;
+        return instance;
+    }
+
+    /**
+     * Take a sample and publish the gauges (called periodically)
+     * @return Number of tasks sampled, 0 if unsupported by the build
+     */
+    size_t sample();
+
+private:
+    TaskProfiler();
+    TaskProfiler(const TaskProfiler&) = delete;
+    TaskProfiler& operator=(const TaskProfiler&) = delete;
+
+    // Run time seen at the previous sample, matched by task number
+    struct Previous {
+        UBaseType_t taskNumber;
+        uint32_t runTime;
+    };
+    Previous previous[MAX_TASKS];
+    size_t previousCount;
+    uint32_t previousTotal;
+    bool coreMetricsRegistered;
+
+    static String metricPrefix(const char* taskName);
+    static bool isProfiled(const char* taskName);
+};
+
+} // namespace mcp
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace mcp {
+
+/**
+ * Where each pipeline stage runs: core, priority and stack size.
+ *
+ * Core 0 (PRO) also runs the WiFi/LwIP stack and AsyncTCP
+ * (CONFIG_ASYNC_TCP_RUNNING_CORE in platformio.ini), so it gets the
+ * event-driven network task and the log drain. Core 1 (APP) is left to
+ * MCP request processing. Arduino's loop() does no work.
+ *
+ * Edit this table to move a stage; TaskProfiler's cpu.coreN.load and
+ * task.<name>.cpu gauges show whether the split is balanced.
+ */
+struct TaskConfig {
+    const char* name;
+    BaseType_t core;
+    UBaseType_t priority;
+    uint32_t stackSize;
+};
+
+namespace TaskTopology {
+    // Above AsyncTCP (3) would starve the web server; the network task
+    // only wakes on WiFi events and timer expiry
+    constexpr TaskConfig NETWORK = {"NetworkTask", 0, 2, 8192};
+    // Parses and dispatches queued MCP requests, publishes metrics
+    constexpr TaskConfig MCP = {"MCPTask", 1, 2, 8192};
+    // Formats log records; lowest priority so output never delays work
+    constexpr TaskConfig LOG_DRAIN = {"LogDrain", 0, 1, 4096};
+
+    // Every stage above; TaskProfiler publishes per-task gauges for these only
+    constexpr const TaskConfig* ALL[] = {&NETWORK, &MCP, &LOG_DRAIN};
+    constexpr size_t COUNT = sizeof(ALL) / sizeof(ALL[0]);
+
+    /**
+     * Create a task as described by its topology entry
+     * @param config Core, priority, stack size and name
+     * @param code Task function
+     * @param parameter Passed to the task function
+     * @param handle Receives the task handle (may be nullptr)
+     * @return true if the task was created
+     */
+    inline bool start(const TaskConfig& config, TaskFunction_t code, void* parameter, TaskHandle_t* handle) {
+        return xTaskCreatePinnedToCore(code, config.name, config.stackSize, parameter,
+                                       config.priority, handle, config.core) == pdPASS;
+    }
+}
+
+} // namespace mcp
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <mutex>
+#include "MCPTransport.h"
+#include <AsyncTCP.h>
+#include "MemoryPool.h"
+
+namespace mcp {
+
+/**
+ * Newline-delimited JSON-RPC over a raw TCP socket.
+ *
+ * Skips WebSocket framing and masking entirely, which makes it the cheapest
+ * transport for machine-to-machine collectors. Runs on AsyncTCP, whose
+ * callbacks arrive on the async_tcp task.
+ *
+ * Output the socket cannot take at once is queued per connection, in order,
+ * and flushed as the peer acknowledges data. A peer that falls more than
+ * MAX_PENDING bytes behind is disconnected rather than losing frames.
+ */
+class TcpTransport : public Transport {
+public:
+    static constexpr size_t MAX_CONNECTIONS = 8;
+    static constexpr size_t MAX_PENDING = 16384;  // Unsent bytes held per connection
+
+    explicit TcpTransport(uint16_t port);
+    ~TcpTransport() override;
+
+    const char* name() const override { return "tcp"; }
+    bool begin() override;
+    void poll() override;
+    bool send(uint32_t connectionId, const char* data, size_t len) override;
+    void close(uint32_t connectionId) override;
+
+private:
+    struct Connection {
+        uint32_t id;        // 0 when the slot is free
+        AsyncClient* client;
+        PooledBuffer line;     // Partial line carried between reads
+        bool overflow;         // Discarding an oversized line until its newline
+        PooledBuffer pending;  // Output the socket has not taken yet, oldest first
+    };
+
+    uint16_t port;
+    uint32_t nextId;
+    Connection connections[MAX_CONNECTIONS];
+    std::mutex mutex;
+
+    AsyncServer* listener;
+
+    void onClient(AsyncClient* client);
+    void onAck(uint32_t id);
+
+    Connection* find(uint32_t id);
+    Connection* allocate();
+    void onBytes(uint32_t id, const uint8_t* data, size_t len);
+    void release(uint32_t id);
+
+    /**
+     * Write as much as the socket takes now without blocking
+     * @param written Set to the bytes taken
+     * @return false if the connection failed
+     */
+    bool writeSome(Connection& conn, const char* data, size_t len, size_t& written);
+
+    /**
+     * Write queued output, then as much of data as fits, queueing the rest
+     * @return false if the connection failed or its queue would exceed MAX_PENDING
+     */
+    bool write(Connection& conn, const char* data, size_t len);
+    bool enqueue(Connection& conn, const char* data, size_t len);
+};
+
+} // namespace mcp
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mcp {
+
+/**
+ * Values captured from a URI, by template variable name
+ */
+using UriParams = std::map<std::string, std::string>;
+
+/**
+ * Matches URIs against a set of URI templates compiled into a trie.
+ *
+ * Templates are split on '/'; each segment is either literal text or one
+ * variable: {name} captures any non-empty segment, {name:int} only decimal
+ * digits. For example sensor://{bus}/{addr:int}/temperature.
+ *
+ * All templates share one trie of segments, so matching walks the URI once
+ * and its cost depends on the URI's length, not on how many templates are
+ * registered. Where templates overlap, a literal segment wins over
+ * {name:int}, which wins over {name}; the walk only backs up when a more
+ * specific branch dead-ends.
+ *
+ * Not thread-safe; the owner serializes access.
+ */
+class UriTemplateMatcher {
+public:
+    static constexpr int NO_MATCH = -1;
+
+    /**
+     * Compile a template into the trie
+     * @param pattern URI template
+     * @return Template id (the existing one if the pattern was added before),
+     *         or NO_MATCH if the pattern is malformed
+     */
+    int add(const std::string &pattern);
+
+    /**
+     * Resolve a URI
+     * @param uri URI to match
+     * @param params Receives the captured variables on success
+     * @return Id of the matching template, or NO_MATCH
+     */
+    int match(const std::string &uri, UriParams &params) const;
+
+    size_t size() const { return templates.size(); }
+
+private:
+    static constexpr int32_t NONE = -1;
+
+    struct Node {
+        std::map<std::string, int32_t, std::less<>> literals;  // Child per literal segment
+        int32_t integer = NONE;      // Child for a {name:int} segment
+        int32_t text = NONE;         // Child for a {name} segment
+        int32_t templateId = NONE;   // Template ending at this node
+    };
+
+    struct Template {
+        std::string pattern;
+        std::vector<std::string> names;  // Variable names in segment order
+    };
+
+    std::vector<Node> nodes{Node()};     // nodes[0] is the root
+    std::vector<Template> templates;
+
+    bool walk(int32_t node, std::string_view uri, size_t pos, std::vector<std::string> &values,
+              int32_t &found) const;
+};
+
+} // namespace mcp
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ESPAsyncWebServer.h>
+#include <map>
+#include "MCPTransport.h"
+#include "MemoryPool.h"
+
+namespace mcp {
+
+/**
+ * MCP over the /ws AsyncWebSocket endpoint served by NetworkManager.
+ * Text frames carry one JSON-RPC message each, binary frames one
+ * MessagePack-encoded message; frames split across TCP packets are
+ * reassembled up to FrameParser::MAX_FRAME_SIZE.
+ */
+class WebSocketTransport : public Transport {
+public:
+    static constexpr uint32_t CLEANUP_INTERVAL = 1000; // ms between client list reaps
+
+    explicit WebSocketTransport(AsyncWebSocket& ws);
+
+    const char* name() const override { return "ws"; }
+    bool begin() override;
+    void poll() override;
+    bool send(uint32_t connectionId, const char* data, size_t len) override;
+    bool supportsBinary() const override { return true; }
+    bool sendBinary(uint32_t connectionId, const uint8_t* data, size_t len) override;
+    bool supportsPing() const override { return true; }
+    bool ping(uint32_t connectionId, const uint8_t* payload, size_t len) override;
+    void close(uint32_t connectionId) override;
+    void abort(uint32_t connectionId) override;
+
+private:
+    AsyncWebSocket& ws;
+    uint32_t lastCleanup;
+    std::map<uint32_t, PooledBuffer> partialFrames; // Frames split across TCP packets, by client id
+
+    void onEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+    void onData(AsyncWebSocketClient* client, AwsFrameInfo* info, uint8_t* data, size_t len);
+};
+
+} // namespace mcp
@@ -86,6 +86,21 @@ public:
      */
     bool compact(uint64_t maxAge);
 
+    /**
+     * Get the size of the log file
+     * @return Size in bytes
+     */
+    size_t getFileSize();
+
+    /**
+     * Read raw bytes of the log file
+     * @param offset Byte offset into the file
+     * @param buffer Destination buffer
+     * @param len Maximum number of bytes to read
+     * @return Number of bytes read (0 at or past the end)
+     */
+    size_t readRaw(size_t offset, uint8_t* buffer, size_t len);
+
 private:
     static const size_t BUFFER_SIZE = 4096;
     static const size_t MAX_FILE_SIZE = 1024 * 1024; // 1MB
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+
+"""
+Stage data/ for the LittleFS image: gzip each file and record a content hash.
+
+Runs as a PlatformIO pre-script (extra_scripts = pre:scripts/build_assets.py)
+and points buildfs/uploadfs at the staged directory. It can also be run by hand:
+
+    python3 scripts/build_assets.py [data_dir] [out_dir]
+
+For every file in data_dir the staged tree holds either <name>.gz (when gzip
+makes it smaller) or the original file. References from HTML pages to other
+non-HTML assets are rewritten to <name>?v=<hash> so those URLs can be cached
+as immutable. A manifest of "<path> <etag> <gzip> <size>" lines is written to
+/assets.manifest for the server to load at boot.
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+import sys
+
+MANIFEST_NAME = "assets.manifest"
+HASH_LENGTH = 16
+GZIP_MIN_SAVING = 0.9  # Keep the gzip variant only if it is <90% of the original
+
+REF_PATTERN = re.compile(r'((?:src|href)=")(/?[^"?#:]+\.(?:js|css|png|jpg|svg|ico|json))(")')
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:HASH_LENGTH]
+
+
+def rewrite_references(html, hashes):
+    def replace(match):
+        path = match.group(2)
+        key = path if path.startswith("/") else "/" + path
+        if key not in hashes:
+            return match.group(0)
+        return "%s%s?v=%s%s" % (match.group(1), path, hashes[key], match.group(3))
+
+    return REF_PATTERN.sub(replace, html.decode("utf-8")).encode("utf-8")
+
+
+def collect(data_dir):
+    files = {}
+    for root, _, names in os.walk(data_dir):
+        for name in sorted(names):
+            full = os.path.join(root, name)
+            rel = "/" + os.path.relpath(full, data_dir).replace(os.sep, "/")
+            if rel.endswith(".gz") or rel == "/" + MANIFEST_NAME:
+                continue
+            with open(full, "rb") as f:
+                files[rel] = f.read()
+    return files
+
+
+def build(data_dir, out_dir):
+    files = collect(data_dir)
+
+    # Hash leaf assets first so pages can reference them by hash
+    hashes = {path: content_hash(data) for path, data in files.items()
+              if not path.endswith(".html")}
+    for path in files:
+        if path.endswith(".html"):
+            files[path] = rewrite_references(files[path], hashes)
+            hashes[path] = content_hash(files[path])
+
+    if os.path.isdir(out_dir):
+        shutil.rmtree(out_dir)
+    os.makedirs(out_dir)
+
+    manifest = []
+    original_total = 0
+    staged_total = 0
+    for path in sorted(files):
+        data = files[path]
+        packed = gzip.compress(data, compresslevel=9, mtime=0)
+        use_gzip = len(packed) < len(data) * GZIP_MIN_SAVING
+
+        target = os.path.join(out_dir, path.lstrip("/"))
+        os.makedirs(os.path.dirname(target), exist_ok=True)
+        with open(target + (".gz" if use_gzip else ""), "wb") as f:
+            f.write(packed if use_gzip else data)
+
+        manifest.append("%s %s %d %d" % (path, hashes[path], 1 if use_gzip else 0, len(data)))
+        original_total += len(data)
+        staged_total += len(packed) if use_gzip else len(data)
+
+    with open(os.path.join(out_dir, MANIFEST_NAME), "w") as f:
+        f.write("\n".join(manifest) + "\n")
+
+    print("Staged %d assets: %d -> %d bytes" % (len(files), original_total, staged_total))
+
+
+def main():
+    data_dir = sys.argv[1] if len(sys.argv) > 1 else "data"
+    out_dir = sys.argv[2] if len(sys.argv) > 2 else os.path.join(".pio", "data")
+    build(data_dir, out_dir)
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+except NameError:
+    if __name__ == "__main__":
+        main()
+else:
+    project_dir = env.subst("$PROJECT_DIR")  # noqa: F821
+    staged_dir = os.path.join(env.subst("$BUILD_DIR"), "data")  # noqa: F821
+    build(os.path.join(project_dir, "data"), staged_dir)
+    env.Replace(PROJECT_DATA_DIR=staged_dir)  # noqa: F821
@@ -0,0 +1,64 @@
+#include "AdmissionControl.h"
+#include <algorithm>
+
+using namespace mcp;
+
+AdmissionControl::AdmissionControl(const Config& config) : buckets{} {
+    setConfig(config);
+}
+
+void AdmissionControl::setConfig(const Config& newConfig) {
+    config = newConfig;
+    config.maxClients = std::min<uint8_t>(config.maxClients, MAX_SLOTS);
+    config.burst = std::max<uint16_t>(config.burst, 1);
+}
+
+AdmissionControl::Verdict AdmissionControl::admitConnection(size_t activeClients, uint32_t freeHeap) const {
+    if (activeClients >= config.maxClients) {
+        return Verdict::REJECT_FULL;
+    }
+    if (freeHeap < config.minFreeHeap) {
+        return Verdict::REJECT_LOW_HEAP;
+    }
+    return Verdict::ADMIT;
+}
+
+void AdmissionControl::opened(size_t slot, uint32_t now) {
+    if (slot >= MAX_SLOTS) {
+        return;
+    }
+    buckets[slot].milliTokens = config.burst * MILLI;
+    buckets[slot].lastRefill = now;
+    buckets[slot].lastActivity = now;
+}
+
+AdmissionControl::Verdict AdmissionControl::admitMessage(size_t slot, uint32_t now, uint32_t freeHeap) {
+    if (slot >= MAX_SLOTS) {
+        return Verdict::REJECT_FULL;
+    }
+    Bucket& bucket = buckets[slot];
+    bucket.lastActivity = now;
+
+    if (freeHeap < config.criticalFreeHeap) {
+        return Verdict::REJECT_LOW_HEAP;
+    }
+
+    // One token per (1000 / rate) ms, i.e. rate milli-tokens per ms
+    uint32_t capacity = config.burst * MILLI;
+    uint64_t refill = static_cast<uint64_t>(now - bucket.lastRefill) * config.messagesPerSecond;
+    bucket.milliTokens = static_cast<uint32_t>(std::min<uint64_t>(capacity, bucket.milliTokens + refill));
+    bucket.lastRefill = now;
+
+    if (bucket.milliTokens < MILLI) {
+        return Verdict::REJECT_RATE;
+    }
+    bucket.milliTokens -= MILLI;
+    return Verdict::ADMIT;
+}
+
+bool AdmissionControl::isIdle(size_t slot, uint32_t now) const {
+    if (slot >= MAX_SLOTS || config.idleTimeout == 0) {
+        return false;
+    }
+    return now - buckets[slot].lastActivity >= config.idleTimeout;
+}
@@ -0,0 +1,57 @@
+#include "Base64.h"
+
+using namespace mcp;
+
+static const char ALPHABET[64 + 1] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static inline void encodeGroup(uint32_t group, char *out) {
+    out[0] = ALPHABET[(group >> 18) & 0x3F];
+    out[1] = ALPHABET[(group >> 12) & 0x3F];
+    out[2] = ALPHABET[(group >> 6) & 0x3F];
+    out[3] = ALPHABET[group & 0x3F];
+}
+
+size_t Base64Encoder::update(const uint8_t *in, size_t len, char *out) {
+    char *start = out;
+
+    // Complete a group begun by the previous call
+    while (carried && len) {
+        carry[carried++] = *in++;
+        len--;
+        if (carried == 3) {
+            encodeGroup((uint32_t(carry[0]) << 16) | (uint32_t(carry[1]) << 8) | carry[2], out);
+            out += 4;
+            carried = 0;
+        }
+    }
+    if (carried) {
+        return static_cast<size_t>(out - start);
+    }
+
+    for (; len >= 3; in += 3, len -= 3, out += 4) {
+        encodeGroup((uint32_t(in[0]) << 16) | (uint32_t(in[1]) << 8) | in[2], out);
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        carry[i] = in[i];
+    }
+    carried = static_cast<uint8_t>(len);
+    return static_cast<size_t>(out - start);
+}
+
+size_t Base64Encoder::finish(char *out) {
+    if (!carried) {
+        return 0;
+    }
+    uint32_t group = uint32_t(carry[0]) << 16;
+    if (carried == 2) {
+        group |= uint32_t(carry[1]) << 8;
+    }
+    encodeGroup(group, out);
+    out[3] = '=';
+    if (carried == 1) {
+        out[2] = '=';
+    }
+    carried = 0;
+    return 4;
+}
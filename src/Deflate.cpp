@@ -0,0 +1,180 @@
+#include "Deflate.h"
+#include <string.h>
+
+using namespace mcp;
+
+namespace {
+
+constexpr size_t MIN_MATCH = 3;
+constexpr size_t MAX_MATCH = 258;
+constexpr uint16_t END_OF_BLOCK = 256;
+
+// RFC 1951 3.2.5: length symbols 257..285 and distance codes 0..29
+constexpr uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t DISTANCE_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t DISTANCE_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Largest index whose base does not exceed value
+template <size_t N>
+size_t findBase(const uint16_t (&bases)[N], uint16_t value) {
+    size_t lo = 0;
+    size_t hi = N - 1;
+    while (lo < hi) {
+        size_t mid = (lo + hi + 1) / 2;
+        if (bases[mid] <= value) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+} // namespace
+
+Deflate::Deflate()
+    : head(),
+      prev(),
+      out(nullptr),
+      outCapacity(0),
+      outLength(0),
+      bitBuffer(0),
+      bitCount(0),
+      overflow(false) {
+}
+
+uint32_t Deflate::hash(const uint8_t* p) {
+    uint32_t key = (static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[2];
+    return (key * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void Deflate::writeBits(uint32_t value, uint8_t count) {
+    bitBuffer |= value << bitCount;
+    bitCount += count;
+    while (bitCount >= 8) {
+        if (outLength < outCapacity) {
+            out[outLength++] = static_cast<uint8_t>(bitBuffer);
+        } else {
+            overflow = true;
+        }
+        bitBuffer >>= 8;
+        bitCount -= 8;
+    }
+}
+
+void Deflate::writeCode(uint16_t code, uint8_t length) {
+    // Huffman codes are packed starting from their most significant bit
+    uint16_t reversed = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    writeBits(reversed, length);
+}
+
+void Deflate::writeLiteral(uint8_t literal) {
+    // Fixed literal/length code (RFC 1951 3.2.6)
+    if (literal < 144) {
+        writeCode(0x30 + literal, 8);
+    } else {
+        writeCode(0x190 + (literal - 144), 9);
+    }
+}
+
+void Deflate::writeMatch(uint16_t length, uint16_t distance) {
+    size_t index = findBase(LENGTH_BASE, length);
+    uint16_t symbol = 257 + index;
+    if (symbol < 280) {
+        writeCode(symbol - 256, 7);
+    } else {
+        writeCode(0xC0 + (symbol - 280), 8);
+    }
+    writeBits(length - LENGTH_BASE[index], LENGTH_EXTRA[index]);
+
+    index = findBase(DISTANCE_BASE, distance);
+    writeCode(index, 5);
+    writeBits(distance - DISTANCE_BASE[index], DISTANCE_EXTRA[index]);
+}
+
+void Deflate::flushBits() {
+    if (bitCount > 0) {
+        writeBits(0, 8 - bitCount);
+    }
+}
+
+size_t Deflate::compress(const uint8_t* in, size_t len, uint8_t* dest, size_t capacity) {
+    if (len > MAX_INPUT) {
+        return 0;
+    }
+
+    memset(head, 0, sizeof(head));
+    out = dest;
+    outCapacity = capacity;
+    outLength = 0;
+    bitBuffer = 0;
+    bitCount = 0;
+    overflow = false;
+
+    writeBits(1, 1); // BFINAL
+    writeBits(1, 2); // BTYPE = fixed Huffman
+
+    size_t pos = 0;
+    while (pos < len && !overflow) {
+        size_t bestLength = 0;
+        size_t bestDistance = 0;
+
+        if (pos + MIN_MATCH <= len) {
+            uint32_t h = hash(in + pos);
+            size_t maxLength = len - pos < MAX_MATCH ? len - pos : MAX_MATCH;
+            uint16_t candidate = head[h];
+            for (uint8_t chain = 0; candidate && chain < MAX_CHAIN; chain++) {
+                size_t from = candidate - 1;
+                size_t distance = pos - from;
+                if (distance > WINDOW_SIZE) {
+                    break;
+                }
+                size_t length = 0;
+                while (length < maxLength && in[from + length] == in[pos + length]) {
+                    length++;
+                }
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = distance;
+                    if (length == maxLength) {
+                        break;
+                    }
+                }
+                candidate = prev[from & (WINDOW_SIZE - 1)];
+            }
+        }
+
+        size_t advance = 1;
+        if (bestLength >= MIN_MATCH) {
+            writeMatch(bestLength, bestDistance);
+            advance = bestLength;
+        } else {
+            writeLiteral(in[pos]);
+        }
+
+        // Index every position covered, so later matches can start inside this one
+        for (size_t end = pos + advance; pos < end; pos++) {
+            if (pos + MIN_MATCH <= len) {
+                uint32_t h = hash(in + pos);
+                prev[pos & (WINDOW_SIZE - 1)] = head[h];
+                head[h] = pos + 1;
+            }
+        }
+    }
+
+    writeCode(END_OF_BLOCK - 256, 7);
+    flushBits();
+    return overflow ? 0 : outLength;
+}
@@ -0,0 +1,244 @@
+#include "DhcpLease.h"
+#include <string.h>
+#include <algorithm>
+
+using namespace mcp;
+
+namespace {
+
+// RFC 2131 section 2 and RFC 2132
+const size_t OP = 0;
+const size_t HTYPE = 1;
+const size_t HLEN = 2;
+const size_t XID = 4;
+const size_t FLAGS = 10;
+const size_t CIADDR = 12;
+const size_t YIADDR = 16;
+const size_t CHADDR = 28;
+const size_t COOKIE = 236;
+const size_t OPTIONS = 240;
+
+const uint8_t BOOTREQUEST = 1;
+const uint8_t BOOTREPLY = 2;
+const uint8_t ETHERNET = 1;
+const uint8_t MAGIC_COOKIE[] = {99, 130, 83, 99};
+
+const uint8_t OPTION_PAD = 0;
+const uint8_t OPTION_SUBNET_MASK = 1;
+const uint8_t OPTION_ROUTER = 3;
+const uint8_t OPTION_DNS = 6;
+const uint8_t OPTION_REQUESTED_IP = 50;
+const uint8_t OPTION_LEASE_TIME = 51;
+const uint8_t OPTION_MESSAGE_TYPE = 53;
+const uint8_t OPTION_SERVER_ID = 54;
+const uint8_t OPTION_PARAMETERS = 55;
+const uint8_t OPTION_RENEWAL_TIME = 58;
+const uint8_t OPTION_REBINDING_TIME = 59;
+const uint8_t OPTION_END = 255;
+
+const uint8_t DHCPREQUEST = 3;
+const uint8_t DHCPACK = 5;
+const uint8_t DHCPNAK = 6;
+
+void putAddress(uint8_t *out, uint32_t address) {
+    for (size_t i = 0; i < 4; i++) {
+        out[i] = static_cast<uint8_t>(address >> (8 * i));
+    }
+}
+
+uint32_t getAddress(const uint8_t *in) {
+    return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 |
+           static_cast<uint32_t>(in[2]) << 16 | static_cast<uint32_t>(in[3]) << 24;
+}
+
+uint32_t getBigEndian(const uint8_t *in) {
+    return static_cast<uint32_t>(in[0]) << 24 | static_cast<uint32_t>(in[1]) << 16 |
+           static_cast<uint32_t>(in[2]) << 8 | static_cast<uint32_t>(in[3]);
+}
+
+} // namespace
+
+DhcpLease::DhcpLease()
+    : state(State::IDLE),
+      address(0),
+      mac{},
+      xid(0),
+      sent(false),
+      lastSent(0),
+      boundAt(0),
+      leaseTime(0),
+      renewAfter(0),
+      rebindAfter(0),
+      expireAfter(0),
+      server(0) {
+}
+
+void DhcpLease::start(uint32_t address, const uint8_t *mac, uint32_t xid, uint32_t now) {
+    this->address = address;
+    memcpy(this->mac, mac, sizeof(this->mac));
+    this->xid = xid;
+    server = 0;
+    leaseTime = 0;
+    boundAt = now;
+    state = State::REBOOTING;
+    sent = false;
+}
+
+void DhcpLease::enter(State next) {
+    state = next;
+    sent = false;
+    xid++; // Each exchange gets its own transaction id
+}
+
+DhcpLease::Action DhcpLease::poll(uint32_t now, uint8_t *request, uint32_t &destination) {
+    if (state == State::IDLE) {
+        return Action::NONE;
+    }
+
+    if (state != State::REBOOTING) {
+        uint32_t elapsed = now - boundAt;
+        if (elapsed >= expireAfter) {
+            state = State::IDLE;
+            return Action::EXPIRED;
+        }
+        if (state == State::BOUND && elapsed >= renewAfter) {
+            enter(State::RENEWING);
+        }
+        if (state == State::RENEWING && elapsed >= rebindAfter) {
+            enter(State::REBINDING); // The server stayed silent; ask any server
+        }
+        if (state == State::BOUND) {
+            return Action::NONE;
+        }
+    }
+
+    if (sent && now - lastSent < RETRY_INTERVAL) {
+        return Action::NONE;
+    }
+    sent = true;
+    lastSent = now;
+    writeRequest(request);
+    destination = state == State::RENEWING && server != 0 ? server : BROADCAST;
+    return Action::SEND;
+}
+
+void DhcpLease::writeRequest(uint8_t *request) const {
+    memset(request, 0, REQUEST_SIZE);
+    request[OP] = BOOTREQUEST;
+    request[HTYPE] = ETHERNET;
+    request[HLEN] = sizeof(mac);
+    request[XID] = static_cast<uint8_t>(xid >> 24);
+    request[XID + 1] = static_cast<uint8_t>(xid >> 16);
+    request[XID + 2] = static_cast<uint8_t>(xid >> 8);
+    request[XID + 3] = static_cast<uint8_t>(xid);
+    if (state == State::REBOOTING) {
+        request[FLAGS] = 0x80; // Broadcast the reply: the server may not accept our address
+    } else {
+        putAddress(request + CIADDR, address);
+    }
+    memcpy(request + CHADDR, mac, sizeof(mac));
+    memcpy(request + COOKIE, MAGIC_COOKIE, sizeof(MAGIC_COOKIE));
+
+    uint8_t *option = request + OPTIONS;
+    *option++ = OPTION_MESSAGE_TYPE;
+    *option++ = 1;
+    *option++ = DHCPREQUEST;
+    if (state == State::REBOOTING) {
+        *option++ = OPTION_REQUESTED_IP;
+        *option++ = 4;
+        putAddress(option, address);
+        option += 4;
+    }
+    *option++ = OPTION_PARAMETERS;
+    *option++ = 3;
+    *option++ = OPTION_SUBNET_MASK;
+    *option++ = OPTION_ROUTER;
+    *option++ = OPTION_DNS;
+    *option++ = OPTION_END;
+}
+
+DhcpLease::Reply DhcpLease::receive(const uint8_t *data, size_t length, uint32_t now) {
+    if (!isWaiting() || length < OPTIONS || data[OP] != BOOTREPLY || getBigEndian(data + XID) != xid ||
+        memcmp(data + CHADDR, mac, sizeof(mac)) != 0 ||
+        memcmp(data + COOKIE, MAGIC_COOKIE, sizeof(MAGIC_COOKIE)) != 0) {
+        return Reply::IGNORED;
+    }
+
+    uint8_t type = 0;
+    bool hasLease = false;
+    uint32_t lease = 0;
+    uint32_t renewal = 0;
+    uint32_t rebinding = 0;
+    uint32_t serverId = 0;
+    size_t pos = OPTIONS;
+    while (pos < length && data[pos] != OPTION_END) {
+        uint8_t code = data[pos++];
+        if (code == OPTION_PAD) {
+            continue;
+        }
+        if (pos >= length || pos + 1 + data[pos] > length) {
+            return Reply::IGNORED; // Truncated option
+        }
+        uint8_t size = data[pos++];
+        const uint8_t *value = data + pos;
+        pos += size;
+        if (code == OPTION_MESSAGE_TYPE && size == 1) {
+            type = value[0];
+        } else if (code == OPTION_LEASE_TIME && size == 4) {
+            lease = getBigEndian(value);
+            hasLease = true;
+        } else if (code == OPTION_RENEWAL_TIME && size == 4) {
+            renewal = getBigEndian(value);
+        } else if (code == OPTION_REBINDING_TIME && size == 4) {
+            rebinding = getBigEndian(value);
+        } else if (code == OPTION_SERVER_ID && size == 4) {
+            serverId = getAddress(value);
+        }
+    }
+
+    if (type == DHCPNAK) {
+        state = State::IDLE;
+        return Reply::NAK;
+    }
+    // An ACK for another address does not answer this request
+    if (type != DHCPACK || !hasLease || getAddress(data + YIADDR) != address) {
+        return Reply::IGNORED;
+    }
+
+    // Missing or inconsistent timers default to 50% and 87.5% of the lease
+    leaseTime = lease;
+    lease = std::min(lease, MAX_LEASE_TIME);
+    if (renewal == 0 || renewal >= lease) {
+        renewal = lease / 2;
+    }
+    if (rebinding <= renewal || rebinding >= lease) {
+        rebinding = lease - lease / 8;
+    }
+    renewAfter = renewal * 1000;
+    rebindAfter = rebinding * 1000;
+    expireAfter = lease * 1000;
+    if (serverId != 0) {
+        server = serverId;
+    }
+    boundAt = now;
+    enter(State::BOUND);
+    return Reply::ACK;
+}
+
+uint32_t DhcpLease::timeUntilDue(uint32_t now) const {
+    if (state == State::IDLE) {
+        return UINT32_MAX;
+    }
+    uint32_t elapsed = now - boundAt;
+    if (state == State::BOUND) {
+        return elapsed >= renewAfter ? 0 : renewAfter - elapsed;
+    }
+    uint32_t due = sent ? RETRY_INTERVAL - std::min(now - lastSent, RETRY_INTERVAL) : 0;
+    if (state == State::RENEWING) {
+        due = std::min(due, elapsed >= rebindAfter ? 0 : rebindAfter - elapsed);
+    }
+    if (state != State::REBOOTING) {
+        due = std::min(due, elapsed >= expireAfter ? 0 : expireAfter - elapsed);
+    }
+    return due;
+}
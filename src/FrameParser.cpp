@@ -0,0 +1,265 @@
+#include "FrameParser.h"
+
+using namespace mcp;
+
+FrameParser::FrameParser() {
+    envelopeFilter["jsonrpc"] = true;
+    envelopeFilter["id"] = true;
+    envelopeFilter["method"] = true;
+    envelopeFilter["type"] = true;     // Legacy {"type":"ping"} heartbeat
+
+    // Fields read by the built-in handlers
+    setFilter("initialize", R"({"params":{"protocolVersion":true,"capabilities":true,"clientInfo":true}})");
+    setFilter("resources/list", R"({"params":{"cursor":true}})");
+    setFilter("resources/read", R"({"params":{"uri":true,"offset":true,"length":true}})");
+    setFilter("resources/subscribe", R"({"params":{"uri":true}})");
+    setFilter("resources/unsubscribe", R"({"params":{"uri":true}})");
+    setFilter("resources/templates/list", R"({"params":{"cursor":true}})");
+    setFilter("logging/setLevel", R"({"params":{"level":true}})");
+    setFilter("tools/list", R"({"params":{"cursor":true}})");
+    setFilter("tools/call", R"({"params":{"name":true,"arguments":true}})");
+}
+
+bool FrameParser::setFilter(const std::string& method, const char* filterJson) {
+    JsonDocument filter;
+    if (deserializeJson(filter, filterJson)) {
+        return false;
+    }
+
+    // Every filter keeps the envelope so responses can echo the id
+    filter["jsonrpc"] = true;
+    filter["id"] = true;
+    filter["method"] = true;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    methodFilters[method] = std::move(filter);
+    return true;
+}
+
+static DeserializationError deserialize(JsonDocument& doc, const char* input, size_t len, Encoding encoding,
+                                        const JsonDocument& filter, uint8_t nestingLimit) {
+    auto nesting = DeserializationOption::NestingLimit(nestingLimit);
+    if (encoding == Encoding::MSGPACK) {
+        return deserializeMsgPack(doc, input, len, DeserializationOption::Filter(filter), nesting);
+    }
+    return deserializeJson(doc, input, len, DeserializationOption::Filter(filter), nesting);
+}
+
+namespace {
+
+constexpr char METHOD_KEY[] = "method";
+constexpr size_t METHOD_KEY_LENGTH = sizeof(METHOD_KEY) - 1;
+
+bool copyName(const char* name, size_t len, char* out, size_t size) {
+    if (len >= size) {
+        return false;
+    }
+    memcpy(out, name, len);
+    out[len] = '\0';
+    return true;
+}
+
+// Value of the "method" key whose closing quote p points past
+bool jsonMethodValue(const char* p, const char* end, char* out, size_t size) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' || *p == ':')) {
+        p++;
+    }
+    if (p >= end || *p != '"') {
+        return false;
+    }
+    const char* name = ++p;
+    while (p < end && *p != '"') {
+        if (*p == '\\') {
+            return false; // No method name needs escapes
+        }
+        p++;
+    }
+    return p < end && copyName(name, static_cast<size_t>(p - name), out, size);
+}
+
+bool findJsonMethod(const char* p, const char* end, char* out, size_t size) {
+    int depth = 0;
+    char last = 0; // Last structural character; a string after '{' or ',' is a key
+    while (p < end) {
+        char c = *p++;
+        if (c == '{' || c == '[') {
+            depth++;
+            last = c;
+        } else if (c == '}' || c == ']') {
+            depth--;
+            last = c;
+        } else if (c == ',' || c == ':') {
+            last = c;
+        } else if (c == '"') {
+            const char* text = p;
+            while (p < end && *p != '"') {
+                p += *p == '\\' ? 2 : 1;
+            }
+            if (p >= end) {
+                return false;
+            }
+            bool key = depth == 1 && (last == '{' || last == ',');
+            size_t len = static_cast<size_t>(p++ - text);
+            last = '"';
+            if (key && len == METHOD_KEY_LENGTH && memcmp(text, METHOD_KEY, len) == 0) {
+                return jsonMethodValue(p, end, out, size);
+            }
+        }
+    }
+    return false;
+}
+
+bool readBigEndian(const uint8_t*& p, const uint8_t* end, size_t bytes, uint32_t& value) {
+    if (static_cast<size_t>(end - p) < bytes) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value = value << 8 | *p++;
+    }
+    return true;
+}
+
+bool skipBytes(const uint8_t*& p, const uint8_t* end, uint32_t len) {
+    if (static_cast<size_t>(end - p) < len) {
+        return false;
+    }
+    p += len;
+    return true;
+}
+
+// Reads the next value if it is a string; otherwise sets text to nullptr and leaves p alone
+bool readMsgPackString(const uint8_t*& p, const uint8_t* end, const char*& text, uint32_t& len) {
+    if (p >= end) {
+        return false;
+    }
+    uint8_t c = *p;
+    if ((c & 0xE0) == 0xA0) {
+        p++;
+        len = c & 0x1F;
+    } else if (c >= 0xD9 && c <= 0xDB) {
+        p++;
+        if (!readBigEndian(p, end, size_t(1) << (c - 0xD9), len)) {
+            return false;
+        }
+    } else {
+        text = nullptr;
+        return true;
+    }
+    text = reinterpret_cast<const char*>(p);
+    return skipBytes(p, end, len);
+}
+
+bool skipMsgPack(const uint8_t*& p, const uint8_t* end, uint8_t depth) {
+    if (p >= end || depth == 0) {
+        return false;
+    }
+    uint8_t c = *p++;
+    uint32_t count = 0;
+    uint32_t len = 0;
+    if (c <= 0x7F || c >= 0xE0 || c == 0xC0 || c == 0xC2 || c == 0xC3) {
+        return true;                                   // fixint, nil, bool
+    } else if ((c & 0xE0) == 0xA0) {
+        return skipBytes(p, end, c & 0x1F);            // fixstr
+    } else if ((c & 0xF0) == 0x90) {
+        count = c & 0x0F;                              // fixarray
+    } else if ((c & 0xF0) == 0x80) {
+        count = (c & 0x0F) * 2u;                       // fixmap
+    } else if (c >= 0xC4 && c <= 0xC6) {
+        return readBigEndian(p, end, size_t(1) << (c - 0xC4), len) && skipBytes(p, end, len);     // bin
+    } else if (c >= 0xD9 && c <= 0xDB) {
+        return readBigEndian(p, end, size_t(1) << (c - 0xD9), len) && skipBytes(p, end, len);     // str
+    } else if (c >= 0xC7 && c <= 0xC9) {
+        return readBigEndian(p, end, size_t(1) << (c - 0xC7), len) && skipBytes(p, end, len + 1); // ext
+    } else if (c >= 0xD4 && c <= 0xD8) {
+        return skipBytes(p, end, 1 + (1u << (c - 0xD4)));                                         // fixext
+    } else if (c == 0xCA || c == 0xCB) {
+        return skipBytes(p, end, c == 0xCA ? 4 : 8);                                              // float
+    } else if (c >= 0xCC && c <= 0xD3) {
+        return skipBytes(p, end, 1u << ((c - 0xCC) & 3));                                         // (u)int
+    } else if (c == 0xDC || c == 0xDD) {
+        if (!readBigEndian(p, end, c == 0xDC ? 2 : 4, count)) {
+            return false;
+        }
+    } else if (c == 0xDE || c == 0xDF) {
+        if (!readBigEndian(p, end, c == 0xDE ? 2 : 4, count) || count > UINT32_MAX / 2) {
+            return false;
+        }
+        count *= 2;
+    } else {
+        return false;                                  // 0xC1 is never used
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (!skipMsgPack(p, end, depth - 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool findMsgPackMethod(const uint8_t* p, const uint8_t* end, char* out, size_t size) {
+    if (p >= end) {
+        return false;
+    }
+    uint8_t c = *p++;
+    uint32_t entries;
+    if ((c & 0xF0) == 0x80) {
+        entries = c & 0x0F;
+    } else if (c == 0xDE || c == 0xDF) {
+        if (!readBigEndian(p, end, c == 0xDE ? 2 : 4, entries)) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < entries; i++) {
+        const char* key;
+        uint32_t keyLength;
+        if (!readMsgPackString(p, end, key, keyLength) || (!key && !skipMsgPack(p, end, FrameParser::NESTING_LIMIT))) {
+            return false;
+        }
+        if (key && keyLength == METHOD_KEY_LENGTH && memcmp(key, METHOD_KEY, keyLength) == 0) {
+            const char* name;
+            uint32_t nameLength;
+            return readMsgPackString(p, end, name, nameLength) && name && copyName(name, nameLength, out, size);
+        }
+        if (!skipMsgPack(p, end, FrameParser::NESTING_LIMIT)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+bool FrameParser::findMethod(const uint8_t* data, size_t len, Encoding encoding, char* method, size_t size) {
+    if (encoding == Encoding::MSGPACK) {
+        return findMsgPackMethod(data, data + len, method, size);
+    }
+    const char* text = reinterpret_cast<const char*>(data);
+    return findJsonMethod(text, text + len, method, size);
+}
+
+DeserializationError FrameParser::parse(const uint8_t* data, size_t len, JsonDocument& doc, Encoding encoding) {
+    if (len > MAX_FRAME_SIZE) {
+        return DeserializationError::NoMemory;
+    }
+
+    char method[MAX_METHOD_LENGTH];
+    bool named = findMethod(data, len, encoding, method, sizeof(method));
+
+    // Held through deserialization: setFilter() may replace the filter
+    std::lock_guard<std::mutex> lock(mutex);
+    const JsonDocument* filter = &envelopeFilter;
+    if (named) {
+        auto it = methodFilters.find(method);
+        if (it != methodFilters.end()) {
+            filter = &it->second;
+        }
+    }
+
+    // Unknown methods keep just the envelope so an error can be returned
+    return deserialize(doc, reinterpret_cast<const char*>(data), len, encoding, *filter, NESTING_LIMIT);
+}
@@ -0,0 +1,62 @@
+#include "Heartbeat.h"
+
+using namespace mcp;
+
+Heartbeat::Heartbeat(const Config &config) : config(config), peers{}, nextSequence(1) {}
+
+void Heartbeat::opened(size_t slot, uint32_t now) {
+    if (slot >= MAX_SLOTS) {
+        return;
+    }
+    peers[slot] = Peer{true, false, 0, 0, now};
+}
+
+void Heartbeat::closed(size_t slot) {
+    if (slot < MAX_SLOTS) {
+        peers[slot].tracked = false;
+    }
+}
+
+Heartbeat::Action Heartbeat::poll(size_t slot, uint32_t now, uint32_t &sequence) {
+    if (slot >= MAX_SLOTS || !peers[slot].tracked || config.interval == 0) {
+        return Action::NONE;
+    }
+    Peer &peer = peers[slot];
+
+    bool retry = false;
+    if (peer.outstanding) {
+        if (now - peer.lastPing < config.timeout) {
+            return Action::NONE;
+        }
+        peer.outstanding = false;
+        if (++peer.missed >= config.maxMissed) {
+            peer.tracked = false;
+            return Action::DEAD;
+        }
+        retry = true; // Probe again at once rather than a full interval later
+    }
+
+    if (!retry && now - peer.lastPing < config.interval) {
+        return Action::NONE;
+    }
+
+    peer.outstanding = true;
+    peer.sequence = nextSequence++;
+    peer.lastPing = now;
+    sequence = peer.sequence;
+    return Action::PING;
+}
+
+bool Heartbeat::pong(size_t slot, uint32_t sequence) {
+    if (slot >= MAX_SLOTS || !peers[slot].tracked || !peers[slot].outstanding ||
+        peers[slot].sequence != sequence) {
+        return false;
+    }
+    peers[slot].outstanding = false;
+    peers[slot].missed = 0;
+    return true;
+}
+
+bool Heartbeat::isOutstanding(size_t slot) const {
+    return slot < MAX_SLOTS && peers[slot].tracked && peers[slot].outstanding;
+}
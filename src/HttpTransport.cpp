@@ -0,0 +1,442 @@
+#include "HttpTransport.h"
+#include "MCPServer.h"
+#include "FrameParser.h"
+#include "JsonWriter.h"
+#include <algorithm>
+
+using namespace mcp;
+
+namespace {
+
+constexpr char SSE_PREFIX[] = "event: message\ndata: ";
+constexpr char SSE_SUFFIX[] = "\n\n";
+
+// Server-initiated messages start like this, whichever writer produced them
+bool isNotification(const char* data, size_t len) {
+    constexpr size_t keyLength = sizeof(JsonRpc::METHOD_KEY) - 1;
+    return len > keyLength && data[0] == '{' && memcmp(data + 1, JsonRpc::METHOD_KEY, keyLength) == 0;
+}
+
+void newToken(char* token, size_t length) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    for (size_t i = 0; i < length; i += 8) {
+        uint32_t bits = esp_random();
+        for (size_t j = 0; j < 8 && i + j < length; j++) {
+            token[i + j] = HEX_DIGITS[(bits >> (4 * j)) & 0xF];
+        }
+    }
+    token[length] = '\0';
+}
+
+} // namespace
+
+HttpTransport::HttpTransport(AsyncWebServer& server)
+    : web(server),
+      nextId(1),
+      inlineExchange(0),
+      inlineTask(nullptr),
+      started(false) {
+    for (auto& session : sessions) {
+        session.id = 0;
+        session.token[0] = '\0';
+        session.stream = nullptr;
+    }
+    for (auto& exchange : exchanges) {
+        exchange.id = 0;
+        exchange.session = 0;
+        exchange.request = nullptr;
+        exchange.startedAt = 0;
+        exchange.ready = false;
+    }
+}
+
+bool HttpTransport::begin() {
+    if (started) {
+        return true;
+    }
+
+    web.on(ENDPOINT, HTTP_POST,
+        [this](AsyncWebServerRequest* request) { this->onPost(request); },
+        nullptr,
+        [this](AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+            this->onBody(request, data, len, index, total);
+        });
+    web.on(ENDPOINT, HTTP_GET, [this](AsyncWebServerRequest* request) { this->onStream(request); });
+    web.on(ENDPOINT, HTTP_DELETE, [this](AsyncWebServerRequest* request) { this->onDelete(request); });
+    started = true;
+    return true;
+}
+
+uint32_t HttpTransport::takeId() {
+    uint32_t id = nextId++;
+    if (nextId == 0) {
+        nextId = 1;
+    }
+    return id;
+}
+
+HttpTransport::Session* HttpTransport::findSession(uint32_t id) {
+    for (auto& session : sessions) {
+        if (session.id == id && id != 0) {
+            return &session;
+        }
+    }
+    return nullptr;
+}
+
+HttpTransport::Session* HttpTransport::findSession(AsyncWebServerRequest* request) {
+    if (!request->hasHeader(SESSION_HEADER)) {
+        return nullptr;
+    }
+    const String& token = request->getHeader(SESSION_HEADER)->value();
+    for (auto& session : sessions) {
+        if (session.id != 0 && token == session.token) {
+            return &session;
+        }
+    }
+    return nullptr;
+}
+
+HttpTransport::Exchange* HttpTransport::findExchange(uint32_t id) {
+    for (auto& exchange : exchanges) {
+        if (exchange.id == id && id != 0) {
+            return &exchange;
+        }
+    }
+    return nullptr;
+}
+
+void HttpTransport::release(Exchange& exchange) {
+    exchange.id = 0;
+    exchange.session = 0;
+    exchange.request = nullptr;
+    exchange.response = PooledBuffer();
+    exchange.ready = false;
+}
+
+void HttpTransport::answer(Exchange& exchange, const char* data, size_t len) {
+    exchange.response = PooledBuffer(len);
+    exchange.response.append(data, len);
+    exchange.ready = true;
+}
+
+void HttpTransport::onBody(AsyncWebServerRequest* request, uint8_t* data, size_t len,
+                           size_t index, size_t total) {
+    if (total > FrameParser::MAX_FRAME_SIZE) {
+        return; // Rejected in onPost
+    }
+    if (index == 0) {
+        bodies[request] = PooledBuffer(total);
+        // The request's only disconnect handler; onPost must not replace it
+        request->onDisconnect([this, request]() { this->forget(request); });
+    }
+    auto it = bodies.find(request);
+    if (it != bodies.end()) {
+        it->second.append(data, len);
+    }
+}
+
+void HttpTransport::onPost(AsyncWebServerRequest* request) {
+    if (request->contentLength() > FrameParser::MAX_FRAME_SIZE) {
+        request->send(413, "text/plain", "Body too large");
+        return;
+    }
+    auto body = bodies.find(request);
+    if (body == bodies.end() || body->second.length() == 0) {
+        request->send(400, "text/plain", "Missing body");
+        return;
+    }
+    PooledBuffer frame = std::move(body->second);
+    bodies.erase(body);
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(frame.data());
+
+    // Only initialize may come without a session, and it always opens one
+    bool known = request->hasHeader(SESSION_HEADER);
+    char method[FrameParser::MAX_METHOD_LENGTH];
+    if (!known && (!FrameParser::findMethod(data, frame.length(), Encoding::JSON, method, sizeof(method)) ||
+                   strcmp(method, "initialize") != 0)) {
+        request->send(400, "text/plain", "Missing Mcp-Session-Id");
+        return;
+    }
+
+    uint32_t sessionId = 0;
+    uint32_t exchangeId = 0;
+    char token[TOKEN_LENGTH + 1] = {};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Session* session = known ? findSession(request) : nullptr;
+        if (!known) {
+            for (auto& slot : sessions) {
+                if (slot.id == 0) {
+                    slot.id = takeId();
+                    newToken(slot.token, TOKEN_LENGTH);
+                    session = &slot;
+                    break;
+                }
+            }
+        }
+        if (session) {
+            sessionId = session->id;
+            memcpy(token, session->token, sizeof(token));
+        }
+    }
+    if (known && !sessionId) {
+        request->send(404, "text/plain", "Unknown session");
+        return;
+    }
+    if (!sessionId || (!known && server->onConnect(this, sessionId) < 0)) {
+        if (sessionId) {
+            std::lock_guard<std::mutex> lock(mutex);
+            findSession(sessionId)->id = 0;
+        }
+        request->send(503, "text/plain", "Server busy");
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& exchange : exchanges) {
+            if (exchange.id == 0) {
+                exchange.id = takeId();
+                exchange.session = sessionId;
+                exchange.request = request;
+                exchange.startedAt = millis();
+                exchangeId = exchange.id;
+                break;
+            }
+        }
+        inlineExchange = exchangeId;
+        inlineTask = xTaskGetCurrentTaskHandle();
+    }
+    if (!exchangeId) {
+        if (!known) {
+            endSession(sessionId, nullptr);
+        }
+        request->send(503, "text/plain", "Server busy");
+        return;
+    }
+
+    bool responds = server->onMessage(this, sessionId, data, frame.length());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inlineExchange = 0;
+        Exchange* exchange = findExchange(exchangeId);
+        if (!responds && exchange) {
+            release(*exchange);
+        }
+    }
+
+    AsyncWebServerResponse* response;
+    if (responds) {
+        response = request->beginChunkedResponse("application/json",
+            [this, exchangeId](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                return this->fillResponse(exchangeId, buffer, maxLen, index);
+            });
+    } else {
+        response = request->beginResponse(202);
+    }
+    response->addHeader(SESSION_HEADER, token);
+    request->send(response);
+}
+
+void HttpTransport::onStream(AsyncWebServerRequest* request) {
+    uint32_t sessionId = 0;
+    bool busy = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Session* session = findSession(request);
+        busy = session && session->stream;
+        if (session && !busy) {
+            session->stream = request;
+            session->events.clear();
+            sessionId = session->id;
+        }
+    }
+    if (!sessionId) {
+        if (busy) {
+            request->send(409, "text/plain", "Stream already open");
+        } else {
+            request->send(request->hasHeader(SESSION_HEADER) ? 404 : 400, "text/plain", "Unknown session");
+        }
+        return;
+    }
+
+    request->onDisconnect([this, request]() { this->forget(request); });
+    AsyncWebServerResponse* response = request->beginChunkedResponse("text/event-stream",
+        [this, sessionId](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            return this->fillStream(sessionId, buffer, maxLen);
+        });
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
+void HttpTransport::onDelete(AsyncWebServerRequest* request) {
+    uint32_t sessionId = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Session* session = findSession(request);
+        sessionId = session ? session->id : 0;
+    }
+    if (!sessionId) {
+        request->send(404, "text/plain", "Unknown session");
+        return;
+    }
+    endSession(sessionId, "Session ended");
+    request->send(204);
+}
+
+void HttpTransport::forget(AsyncWebServerRequest* request) {
+    bodies.erase(request);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& exchange : exchanges) {
+        if (exchange.id == 0 || exchange.request != request) {
+            continue;
+        }
+        // An unanswered exchange stays to absorb its answer, so later
+        // answers of the session still pair up with the right request
+        exchange.request = nullptr;
+        if (exchange.ready) {
+            release(exchange);
+        }
+    }
+    for (auto& session : sessions) {
+        if (session.id != 0 && session.stream == request) {
+            session.stream = nullptr;
+            session.events = PooledBuffer();
+        }
+    }
+}
+
+size_t HttpTransport::fillResponse(uint32_t exchangeId, uint8_t* buffer, size_t maxLen, size_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Exchange* exchange = findExchange(exchangeId);
+    if (!exchange) {
+        return 0;
+    }
+    if (!exchange->ready) {
+        return RESPONSE_TRY_AGAIN;
+    }
+
+    size_t length = exchange->response.length();
+    size_t count = index < length ? std::min(maxLen, length - index) : 0;
+    if (count == 0) {
+        release(*exchange);
+        return 0;
+    }
+    memcpy(buffer, exchange->response.data() + index, count);
+    return count;
+}
+
+size_t HttpTransport::fillStream(uint32_t sessionId, uint8_t* buffer, size_t maxLen) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Session* session = findSession(sessionId);
+    if (!session) {
+        return 0; // Session ended: so does its stream
+    }
+    size_t count = std::min(maxLen, session->events.length());
+    if (count == 0) {
+        return RESPONSE_TRY_AGAIN;
+    }
+    memcpy(buffer, session->events.data(), count);
+    session->events.consume(count);
+    return count;
+}
+
+bool HttpTransport::send(uint32_t connectionId, const char* data, size_t len) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Session* session = findSession(connectionId);
+    if (!session) {
+        return false;
+    }
+
+    // Notifications go out on the session's stream, if one is open
+    if (isNotification(data, len)) {
+        PooledBuffer& events = session->events;
+        size_t needed = events.length() + sizeof(SSE_PREFIX) - 1 + len + sizeof(SSE_SUFFIX) - 1;
+        if (!session->stream || needed > MAX_STREAM_BACKLOG ||
+            !events.reserve(std::min(std::max(needed, 2 * events.capacity()), MAX_STREAM_BACKLOG))) {
+            return false;
+        }
+        return events.append(SSE_PREFIX, sizeof(SSE_PREFIX) - 1) && events.append(data, len) &&
+               events.append(SSE_SUFFIX, sizeof(SSE_SUFFIX) - 1);
+    }
+
+    // Answers given while the frame is still inside onMessage() belong to
+    // it; queued requests are answered in order, so any other answer
+    // belongs to the session's oldest waiting exchange
+    Exchange* target = nullptr;
+    if (inlineExchange && inlineTask == xTaskGetCurrentTaskHandle()) {
+        target = findExchange(inlineExchange);
+    } else {
+        for (auto& exchange : exchanges) {
+            if (exchange.id != 0 && exchange.session == connectionId && !exchange.ready &&
+                (!target || exchange.id < target->id)) {
+                target = &exchange;
+            }
+        }
+    }
+    if (!target || target->ready) {
+        return false;
+    }
+    if (!target->request) {
+        release(*target); // The client gave up on this one
+        return true;
+    }
+    answer(*target, data, len);
+    return target->response.valid();
+}
+
+void HttpTransport::endSession(uint32_t sessionId, const char* reason) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Session* session = findSession(sessionId);
+        if (!session) {
+            return;
+        }
+        session->id = 0;
+        session->stream = nullptr;
+        session->events = PooledBuffer();
+
+        char body[96];
+        int length = snprintf(body, sizeof(body),
+                              "{\"jsonrpc\":\"2.0\",\"id\":null,\"error\":{\"code\":-32000,\"message\":\"%s\"}}",
+                              reason ? reason : "Session closed");
+        for (auto& exchange : exchanges) {
+            if (exchange.id == 0 || exchange.session != sessionId || exchange.ready) {
+                continue;
+            }
+            if (exchange.request) {
+                answer(exchange, body, static_cast<size_t>(length));
+            } else {
+                release(exchange);
+            }
+        }
+    }
+    server->onDisconnect(this, sessionId);
+}
+
+void HttpTransport::close(uint32_t connectionId) {
+    endSession(connectionId, "Session closed by server");
+}
+
+void HttpTransport::poll() {
+    uint32_t expired[MAX_EXCHANGES];
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint32_t now = millis();
+        for (auto& exchange : exchanges) {
+            if (exchange.id != 0 && !exchange.ready && now - exchange.startedAt >= RESPONSE_TIMEOUT &&
+                std::find(expired, expired + count, exchange.session) == expired + count) {
+                expired[count++] = exchange.session;
+            }
+        }
+    }
+
+    // An answer may still come; ending the session keeps it from being
+    // paired with a later request
+    for (size_t i = 0; i < count; i++) {
+        endSession(expired[i], "Request timed out");
+    }
+}
@@ -0,0 +1,108 @@
+#include "Log.h"
+#include "TaskTopology.h"
+
+using namespace mcp;
+
+static const char LEVEL_TAGS[] = {'-', 'E', 'W', 'I', 'D'};
+
+Log::Log()
+    : ring(MCP_LOG_RING_SIZE),
+      tap(MCP_LOG_TAP_LINES),
+      tapLevel(MCP_LOG_LEVEL_NONE),
+      output(nullptr),
+      fileSystem(nullptr),
+      drainTaskHandle(nullptr),
+      reportedDrops(0) {
+}
+
+bool Log::begin(Print* out) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        output = out;
+    }
+    if (drainTaskHandle) {
+        return true;
+    }
+    return TaskTopology::start(TaskTopology::LOG_DRAIN, drainTaskCode, this, &drainTaskHandle);
+}
+
+bool Log::logToFile(fs::FS& fs, const char* path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file) {
+        file.close();
+    }
+    fileSystem = &fs;
+    filePath = path;
+    file = fs.open(path, FILE_APPEND);
+    return static_cast<bool>(file);
+}
+
+void Log::drainTaskCode(void* parameter) {
+    static_cast<Log*>(parameter)->drainTask();
+}
+
+void Log::drainTask() {
+    while (true) {
+        if (!drain()) {
+            vTaskDelay(pdMS_TO_TICKS(DRAIN_INTERVAL));
+        }
+    }
+}
+
+bool Log::drain() {
+    char line[MAX_LINE];
+    size_t lines = 0;
+    LogRing::Entry entry;
+
+    // Bounded batch so a log storm cannot starve the idle task
+    while (lines < 32 && ring.read(entry)) {
+        int prefix = snprintf(line, sizeof(line), "[%8lu][%c] ", static_cast<unsigned long>(entry.timestamp),
+                              LEVEL_TAGS[entry.level < sizeof(LEVEL_TAGS) ? entry.level : 0]);
+        size_t length = prefix + LogRing::format(entry, line + prefix, sizeof(line) - prefix - 1);
+        ring.consume();
+        if (entry.level <= tapLevel.load(std::memory_order_relaxed)) {
+            tap.push(entry.level, line, length);
+        }
+        line[length++] = '\n';
+        emit(line, length);
+        lines++;
+    }
+
+    uint32_t drops = ring.getDropped();
+    if (drops != reportedDrops) {
+        int length = snprintf(line, sizeof(line), "[log] %lu records dropped (ring full)\n",
+                              static_cast<unsigned long>(drops - reportedDrops));
+        emit(line, length);
+        reportedDrops = drops;
+    }
+
+    if (lines) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (file) {
+            file.flush();
+            if (file.size() >= MAX_FILE_SIZE) {
+                rotateFile();
+            }
+        }
+    }
+    return lines > 0;
+}
+
+void Log::emit(const char* line, size_t length) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (output) {
+        output->write(reinterpret_cast<const uint8_t*>(line), length);
+    }
+    if (file) {
+        file.write(reinterpret_cast<const uint8_t*>(line), length);
+    }
+}
+
+void Log::rotateFile() {
+    // Keep one previous file: <path>.1
+    file.close();
+    String previous = filePath + ".1";
+    fileSystem->remove(previous);
+    fileSystem->rename(filePath, previous);
+    file = fileSystem->open(filePath, FILE_APPEND);
+}
@@ -0,0 +1,243 @@
+#include "LogRing.h"
+#include <stdio.h>
+
+using namespace mcp;
+
+LogRing::LogRing(size_t requested)
+    : buffer(nullptr),
+      capacity(64),
+      head(0),
+      tail(0),
+      dropped(0),
+      pendingLength(0) {
+    while (capacity < requested && capacity < LENGTH_MASK / 2) {
+        capacity *= 2;
+    }
+    buffer = new uint8_t[capacity]();
+}
+
+LogRing::~LogRing() {
+    delete[] buffer;
+}
+
+size_t LogRing::boundedLength(const char* s) {
+    size_t length = 0;
+    while (length < MAX_STRING && s[length]) {
+        length++;
+    }
+    return length;
+}
+
+bool LogRing::reserve(size_t length, uint8_t*& record) {
+    length = align(length);
+    if (length > MAX_RECORD || length > capacity / 2) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint32_t start = head.load(std::memory_order_relaxed);
+    uint32_t padding;
+    do {
+        // Records never wrap: skip the tail end of the buffer if too short
+        uint32_t pos = start & (capacity - 1);
+        padding = pos + length > capacity ? capacity - pos : 0;
+        if (start + padding + length - tail.load(std::memory_order_acquire) > capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    } while (!head.compare_exchange_weak(start, start + padding + length,
+                                         std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    if (padding) {
+        __atomic_store_n(reinterpret_cast<uint32_t*>(buffer + (start & (capacity - 1))),
+                         padding | PADDING | COMMITTED, __ATOMIC_RELEASE);
+    }
+    record = buffer + ((start + padding) & (capacity - 1));
+    return true;
+}
+
+void LogRing::publish(uint8_t* record, size_t length, uint8_t level, uint32_t timestamp, const char* format) {
+    memcpy(record + sizeof(uint32_t), &timestamp, sizeof(timestamp));
+    memcpy(record + 2 * sizeof(uint32_t), &format, sizeof(format));
+    // Header last: the consumer only looks at records whose header is set
+    uint32_t header = static_cast<uint32_t>(length) | (static_cast<uint32_t>(level & 0x07) << LEVEL_SHIFT) | COMMITTED;
+    __atomic_store_n(reinterpret_cast<uint32_t*>(record), header, __ATOMIC_RELEASE);
+}
+
+bool LogRing::read(Entry& entry) {
+    while (true) {
+        uint32_t start = tail.load(std::memory_order_relaxed);
+        if (start == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        uint8_t* record = buffer + (start & (capacity - 1));
+        uint32_t header = __atomic_load_n(reinterpret_cast<uint32_t*>(record), __ATOMIC_ACQUIRE);
+        if (!(header & COMMITTED)) {
+            return false; // Reserved but still being written
+        }
+
+        pendingLength = header & LENGTH_MASK;
+        if (header & PADDING) {
+            consume();
+            continue;
+        }
+
+        entry.level = (header >> LEVEL_SHIFT) & 0x07;
+        memcpy(&entry.timestamp, record + sizeof(uint32_t), sizeof(entry.timestamp));
+        memcpy(&entry.format, record + 2 * sizeof(uint32_t), sizeof(entry.format));
+        entry.args = record + HEADER_SIZE;
+        entry.argsSize = pendingLength - HEADER_SIZE; // Includes alignment; decoding stops at the format's end
+        return true;
+    }
+}
+
+void LogRing::consume() {
+    if (!pendingLength) {
+        return;
+    }
+    uint32_t start = tail.load(std::memory_order_relaxed);
+    // Cleared so a later record reserved here reads as uncommitted
+    memset(buffer + (start & (capacity - 1)), 0, pendingLength);
+    tail.store(start + pendingLength, std::memory_order_release);
+    pendingLength = 0;
+}
+
+size_t LogRing::format(const Entry& entry, char* out, size_t size) {
+    if (!size) {
+        return 0;
+    }
+    const char* f = entry.format ? entry.format : "";
+    const uint8_t* arg = entry.args;
+    const uint8_t* end = entry.args + entry.argsSize;
+    size_t n = 0;
+
+    while (*f && n + 1 < size) {
+        if (*f != '%') {
+            out[n++] = *f++;
+            continue;
+        }
+        if (f[1] == '%') {
+            out[n++] = '%';
+            f += 2;
+            continue;
+        }
+
+        // Rebuild the conversion with a length modifier matching the stored value
+        char spec[24];
+        size_t s = 0;
+        spec[s++] = *f++;
+        while (*f && strchr("-+ #0", *f) && s < 6) {
+            spec[s++] = *f++;
+        }
+        while (*f && ((*f >= '0' && *f <= '9') || *f == '.') && s < 14) {
+            spec[s++] = *f++;
+        }
+        while (*f && strchr("hlLqjzt", *f)) {
+            f++;
+        }
+        char conv = *f;
+        if (!conv) {
+            break;
+        }
+        f++;
+
+        if (arg >= end || *arg < ARG_INT32 || *arg > ARG_POINTER) {
+            // Argument missing (more conversions than arguments)
+            int w = snprintf(out + n, size - n, "?");
+            n += w > 0 ? static_cast<size_t>(w) : 0;
+            continue;
+        }
+
+        uint8_t type = *arg++;
+        int64_t i = 0;
+        double d = 0;
+        char str[MAX_STRING + 1] = "";
+        switch (type) {
+            case ARG_INT32: {
+                int32_t v;
+                memcpy(&v, arg, sizeof(v));
+                arg += sizeof(v);
+                i = v;
+                d = v;
+                break;
+            }
+            case ARG_UINT32: {
+                uint32_t v;
+                memcpy(&v, arg, sizeof(v));
+                arg += sizeof(v);
+                i = v;
+                d = v;
+                break;
+            }
+            case ARG_INT64:
+            case ARG_UINT64: {
+                uint64_t v;
+                memcpy(&v, arg, sizeof(v));
+                arg += sizeof(v);
+                i = static_cast<int64_t>(v);
+                d = type == ARG_INT64 ? static_cast<double>(i) : static_cast<double>(v);
+                break;
+            }
+            case ARG_DOUBLE:
+                memcpy(&d, arg, sizeof(d));
+                arg += sizeof(d);
+                i = static_cast<int64_t>(d);
+                break;
+            case ARG_STRING: {
+                uint8_t length = *arg++;
+                memcpy(str, arg, length);
+                str[length] = '\0';
+                arg += length;
+                break;
+            }
+            case ARG_POINTER: {
+                uintptr_t v;
+                memcpy(&v, arg, sizeof(v));
+                arg += sizeof(v);
+                i = static_cast<int64_t>(v);
+                break;
+            }
+        }
+
+        int w;
+        if (conv == 's') {
+            spec[s++] = 's';
+            spec[s] = '\0';
+            w = snprintf(out + n, size - n, spec, type == ARG_STRING ? str : "?");
+        } else if (strchr("fFeEgGaA", conv)) {
+            spec[s++] = conv;
+            spec[s] = '\0';
+            w = snprintf(out + n, size - n, spec, d);
+        } else if (conv == 'c') {
+            spec[s++] = 'c';
+            spec[s] = '\0';
+            w = snprintf(out + n, size - n, spec, static_cast<int>(i));
+        } else if (conv == 'p') {
+            spec[s++] = 'p';
+            spec[s] = '\0';
+            w = snprintf(out + n, size - n, spec, reinterpret_cast<void*>(static_cast<uintptr_t>(i)));
+        } else if (strchr("uxXo", conv)) {
+            spec[s++] = 'l';
+            spec[s++] = 'l';
+            spec[s++] = conv;
+            spec[s] = '\0';
+            // 32-bit arguments print as 32-bit (e.g. %x of -1 is ffffffff)
+            unsigned long long v = type == ARG_INT32 ? static_cast<uint32_t>(i) : static_cast<unsigned long long>(i);
+            w = snprintf(out + n, size - n, spec, v);
+        } else {
+            spec[s++] = 'l';
+            spec[s++] = 'l';
+            spec[s++] = 'd';
+            spec[s] = '\0';
+            long long v = type == ARG_UINT64 ? static_cast<long long>(static_cast<uint64_t>(i)) : static_cast<long long>(i);
+            w = snprintf(out + n, size - n, spec, v);
+        }
+        if (w < 0) {
+            break;
+        }
+        n += static_cast<size_t>(w) < size - n ? static_cast<size_t>(w) : size - n - 1;
+    }
+
+    out[n] = '\0';
+    return n;
+}
@@ -0,0 +1,44 @@
+#include "LogTap.h"
+#include <string.h>
+
+using namespace mcp;
+
+LogTap::LogTap(size_t slots) : lines(nullptr), capacity(1), head(0), tail(0), dropped(0) {
+    while (capacity < slots) {
+        capacity *= 2;
+    }
+    lines = new Line[capacity]();
+}
+
+LogTap::~LogTap() {
+    delete[] lines;
+}
+
+bool LogTap::push(uint8_t level, const char* text, size_t length) {
+    uint32_t start = head.load(std::memory_order_relaxed);
+    if (start - tail.load(std::memory_order_acquire) >= capacity) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Line& line = lines[start & (capacity - 1)];
+    line.level = level;
+    line.length = static_cast<uint8_t>(length < MAX_TEXT ? length : MAX_TEXT);
+    memcpy(line.text, text, line.length);
+    // Published after the slot is filled
+    head.store(start + 1, std::memory_order_release);
+    return true;
+}
+
+size_t LogTap::available() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+}
+
+const LogTap::Line& LogTap::peek(size_t index) const {
+    return lines[(tail.load(std::memory_order_relaxed) + index) & (capacity - 1)];
+}
+
+void LogTap::consume(size_t count) {
+    size_t ready = available();
+    tail.store(tail.load(std::memory_order_relaxed) + (count < ready ? count : ready), std::memory_order_release);
+}
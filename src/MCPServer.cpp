@@ -1,160 +1,1301 @@
 #include "MCPServer.h"
 #include "MCPTypes.h"
-#include <iostream>
+#include "JsonWriter.h"
+#include "Base64.h"
+#include "MetricsSystem.h"
+#include "Log.h"
+#include "Pagination.h"
+#include <algorithm>
 
 using namespace mcp;
 
+static const char* PROTOCOL_VERSION = "2024-11-05";
+
+static bool contains(JsonVariantConst list, const char *name) {
+    for (JsonVariantConst item : list.as<JsonArrayConst>()) {
+        if (item == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
 MCPServer::MCPServer(uint16_t port) : port_(port) {}
 
+void MCPServer::addTransport(Transport *transport) {
+    transport->attach(this);
+    transports.push_back(transport);
+}
+
+void MCPServer::setAdmissionConfig(const AdmissionControl::Config &config) {
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    admission.setConfig(config);
+}
+
 void MCPServer::begin(bool isConnected) {
-    // Initialization logic here
+    registerResource(MCPResource("MCP slow requests", RequestTracer::SLOW_RESOURCE_URI, "application/json",
+                                 "Most recent requests above the latency threshold", []() {
+        JsonDocument doc(&MemoryPool::getInstance());
+        RequestTracer::getInstance().writeSlowRequests(doc.to<JsonArray>());
+        std::string text;
+        serializeJson(doc, text);
+        return text;
+    }));
+
+    MetricsSystem &metrics = MetricsSystem::getInstance();
+    metrics.registerGauge("mcp.clients.active", "Connected MCP clients", "clients", "mcp");
+    metrics.registerCounter("mcp.clients.rejected", "Connections refused with all slots taken", "", "mcp");
+    metrics.registerCounter("mcp.clients.shed", "Connections refused on low heap", "", "mcp");
+    metrics.registerCounter("mcp.clients.evicted", "Idle clients disconnected", "", "mcp");
+    metrics.registerCounter("mcp.clients.dead", "Clients dropped after missing heartbeat pongs", "", "mcp");
+    metrics.registerHistogram("mcp.rtt", "WebSocket ping round trip, all clients", "ms", "mcp");
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+        metrics.registerHistogram("mcp.client." + String(i) + ".rtt", "WebSocket ping round trip of client slot " + String(i),
+                                  "ms", "mcp");
+    }
+    metrics.registerCounter("mcp.messages.rate_limited", "Messages refused by the per-client rate limit", "", "mcp");
+    metrics.registerCounter("mcp.messages.shed", "Messages refused on critical heap", "", "mcp");
+    metrics.registerCounter("mcp.replay.hits", "tools/call retries answered from the replay cache", "", "mcp");
+    metrics.registerCounter("mcp.log.sent", "Log lines forwarded to clients", "", "mcp");
+    metrics.registerCounter("mcp.log.limited", "Log lines withheld by the per-client rate limit", "", "mcp");
+    metrics.registerCounter("mcp.log.dropped", "Log lines lost to a full log tap", "", "mcp");
+    metrics.registerCounter("mcp.notify.sent", "Resource update notifications sent", "", "mcp");
+    metrics.registerCounter("mcp.notify.suppressed", "Resource value changes not notified (deadband or coalesced)", "", "mcp");
+    metrics.registerHistogram("mcp.deflate.ratio", "Compressed size of deflated messages", "%", "mcp");
+    metrics.registerHistogram("mcp.deflate.time", "CPU time spent deflating a message", "ms", "mcp");
+    metrics.registerCounter("mcp.deflate.saved", "Bytes saved by message compression", "bytes", "mcp");
+
+    if (!isConnected) {
+        return;
+    }
+
+    for (Transport *transport : transports) {
+        if (!transport->begin()) {
+            MCP_LOGE("Transport failed to start: %s", transport->name());
+        }
+    }
 }
 
 void MCPServer::handleClient() {
-    // Handle client logic
+    for (Transport *transport : transports) {
+        transport->poll();
+    }
+    evictIdleClients();
+    pingClients();
+    flushResourceUpdates();
+    flushLogs();
+
+    MCPRequest request;
+    while (requestQueue.pop(request)) {
+        dispatch(request);
+    }
+}
+
+int MCPServer::onConnect(Transport *transport, uint32_t connectionId) {
+    int slot = -1;
+    size_t active = 0;
+    AdmissionControl::Verdict verdict;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        active = sessions.active();
+        verdict = admission.admitConnection(active, ESP.getFreeHeap());
+        if (verdict == AdmissionControl::Verdict::ADMIT) {
+            slot = sessions.open(transport, connectionId, millis());
+        }
+        if (slot >= 0) {
+            admission.opened(slot, millis());
+            if (transport->supportsPing()) {
+                heartbeat.opened(slot, millis());
+            }
+            active++;
+        }
+    }
+
+    MetricsSystem &metrics = MetricsSystem::getInstance();
+    if (slot < 0) {
+        MCP_LOGW("拒绝客户端连接 (%s)", transport->name());
+        metrics.incrementCounter(verdict == AdmissionControl::Verdict::REJECT_LOW_HEAP ?
+                                 "mcp.clients.shed" : "mcp.clients.rejected");
+        return -1;
+    }
+    metrics.setGauge("mcp.clients.active", active);
+    return slot;
+}
+
+void MCPServer::onDisconnect(Transport *transport, uint32_t connectionId) {
+    size_t active = 0;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        int clientId = sessions.find(transport, connectionId);
+        if (clientId >= 0) {
+            const Session &session = sessions[clientId];
+            MCP_LOGI("客户端断开 - 客户端ID: %d 请求: %u 错误: %u RTT: %u ms", clientId,
+                     static_cast<unsigned>(session.requests), static_cast<unsigned>(session.errors),
+                     static_cast<unsigned>(session.rtt));
+            heartbeat.closed(clientId);
+            sessions.close(clientId);
+            updateLogTap();
+        }
+        active = sessions.active();
+    }
+    MetricsSystem::getInstance().setGauge("mcp.clients.active", active);
+}
+
+void MCPServer::evictIdleClients() {
+    Route idle[MAX_CLIENTS];
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        uint32_t now = millis();
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            Session *session = sessions.get(i);
+            if (session && !session->closing && admission.isIdle(i, now)) {
+                session->closing = true;
+                idle[count++] = {session->transport, session->connectionId, session->encoding, session->compress};
+            }
+        }
+    }
+
+    // Closed outside the lock: close() may call back into onDisconnect
+    for (size_t i = 0; i < count; i++) {
+        MCP_LOGI("断开空闲客户端 (%s)", idle[i].transport->name());
+        idle[i].transport->close(idle[i].connectionId);
+        MetricsSystem::getInstance().incrementCounter("mcp.clients.evicted");
+    }
+}
+
+void MCPServer::setHeartbeatConfig(const Heartbeat::Config &config) {
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    heartbeat.setConfig(config);
+}
+
+void MCPServer::setReplayBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    sessions.setReplayBudget(bytes);
+}
+
+void MCPServer::setLogRate(uint16_t linesPerSecond, uint16_t burst) {
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    logRate = linesPerSecond ? linesPerSecond : 1;
+    logBurst = burst ? burst : 1;
+}
+
+void MCPServer::pingClients() {
+    struct Probe {
+        Transport *transport;
+        uint32_t connectionId;
+        uint32_t sequence;
+        bool dead;
+    };
+    Probe probes[MAX_CLIENTS];
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        uint32_t now = millis();
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            Session *session = sessions.get(i);
+            if (!session || session->closing) {
+                continue;
+            }
+            uint32_t sequence = 0;
+            Heartbeat::Action action = heartbeat.poll(i, now, sequence);
+            if (action == Heartbeat::Action::NONE) {
+                continue;
+            }
+            bool dead = action == Heartbeat::Action::DEAD;
+            session->closing = dead;
+            probes[count++] = {session->transport, session->connectionId, sequence, dead};
+        }
+    }
+
+    // Outside the lock: abort() calls back into onDisconnect
+    uint32_t sentAt = micros();
+    for (size_t i = 0; i < count; i++) {
+        if (probes[i].dead) {
+            MCP_LOGI("断开无响应客户端 (%s)", probes[i].transport->name());
+            probes[i].transport->abort(probes[i].connectionId);
+            MetricsSystem::getInstance().incrementCounter("mcp.clients.dead");
+            continue;
+        }
+        // The pong echoes the payload, so the round trip needs no per-ping state
+        uint8_t payload[PING_PAYLOAD_SIZE];
+        memcpy(payload, &probes[i].sequence, sizeof(uint32_t));
+        memcpy(payload + sizeof(uint32_t), &sentAt, sizeof(uint32_t));
+        probes[i].transport->ping(probes[i].connectionId, payload, sizeof(payload));
+    }
+}
+
+void MCPServer::onPong(Transport *transport, uint32_t connectionId, const uint8_t *data, size_t len) {
+    // Unsolicited pongs (RFC 6455 5.5.3) carry no payload of ours
+    if (!data || len != PING_PAYLOAD_SIZE) {
+        return;
+    }
+    uint32_t sequence;
+    uint32_t sentAt;
+    memcpy(&sequence, data, sizeof(uint32_t));
+    memcpy(&sentAt, data + sizeof(uint32_t), sizeof(uint32_t));
+    double rtt = (micros() - sentAt) / 1000.0;
+
+    int clientId;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        clientId = sessions.find(transport, connectionId);
+        if (clientId < 0 || !heartbeat.pong(clientId, sequence)) {
+            return;
+        }
+        sessions[clientId].rtt = static_cast<float>(rtt);
+    }
+    MetricsSystem &metrics = MetricsSystem::getInstance();
+    metrics.recordHistogram("mcp.rtt", rtt);
+    metrics.recordHistogram("mcp.client." + String(clientId) + ".rtt", rtt);
+}
+
+bool MCPServer::answerPing(uint8_t clientId, const MCPRequest &request) {
+    // Answered on the transport's task rather than queued, so the client's
+    // round trip does not include waiting for the MCP task
+    if (strcmp(request.method(), "ping") == 0 && !request.doc["id"].isNull()) {
+        RequestId id = request.id;
+        transmitWritten(clientId, 48, [&](auto &writer) {
+            writer.beginObject().rawKey(JsonRpc::ID_KEY).value(id)
+                  .key("result").beginObject().endObject()
+                  .endObject();
+        });
+        return true;
+    }
+
+    // Heartbeat of earlier web clients: {"type":"ping"}
+    if (!request.method()[0] && request.doc["type"] == "ping") {
+        transmitWritten(clientId, 16, [](auto &writer) {
+            writer.beginObject().key("type").value("pong").endObject();
+        });
+        return true;
+    }
+    return false;
+}
+
+bool MCPServer::onMessage(Transport *transport, uint32_t connectionId, const uint8_t *data, size_t len,
+                          Encoding encoding) {
+    int clientId = -1;
+    AdmissionControl::Verdict verdict = AdmissionControl::Verdict::REJECT_FULL;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        clientId = sessions.find(transport, connectionId);
+        if (clientId >= 0) {
+            verdict = admission.admitMessage(clientId, millis(), ESP.getFreeHeap());
+            sessions[clientId].requests++;
+        }
+    }
+    if (clientId < 0) {
+        return false;
+    }
+
+    // Refused before parsing so an abusive client costs as little as possible
+    if (verdict != AdmissionControl::Verdict::ADMIT) {
+        bool shed = verdict == AdmissionControl::Verdict::REJECT_LOW_HEAP;
+        MetricsSystem::getInstance().incrementCounter(shed ? "mcp.messages.shed" : "mcp.messages.rate_limited");
+        sendError(clientId, RequestId(), -32000, shed ? "Server overloaded" : "Rate limit exceeded");
+        return true;
+    }
+
+    DeserializationError error;
+    MCPRequest request = parseFrame(clientId, data, len, encoding, error);
+    if (error) {
+        RequestTracer::getInstance().recordError();
+        sendError(clientId, RequestId(), -32700, "Parse error");
+        return true;
+    }
+    if (!request.id.isValid()) {
+        RequestTracer::getInstance().recordError();
+        sendError(clientId, RequestId(), -32600, "Invalid request id");
+        return true;
+    }
+
+    if (answerPing(clientId, request)) {
+        return true;
+    }
+
+    // Notifications and client responses carry no method or no id
+    if (!request.method()[0] || request.doc["id"].isNull()) {
+        return false;
+    }
+
+    RequestId id = request.id;
+    if (!submit(std::move(request))) {
+        RequestTracer::getInstance().recordError();
+        sendError(clientId, id, -32000, "Server busy");
+    }
+    return true;
+}
+
+bool MCPServer::submit(MCPRequest &&request) {
+    request.trace.mark(TracePhase::QUEUED);
+    return requestQueue.push(std::move(request));
+}
+
+void MCPServer::dispatch(MCPRequest &request) {
+    request.trace.mark(TracePhase::DISPATCHED);
+    dispatchTask = xTaskGetCurrentTaskHandle();
+    activeTrace = &request.trace;
+    JsonObject params = request.params();
+
+    switch (request.type) {
+        case MCPRequestType::INITIALIZE:
+            handleInitialize(request.clientId, request.id, params);
+            break;
+        case MCPRequestType::RESOURCES_LIST:
+            handleResourcesList(request.clientId, request.id, params);
+            break;
+        case MCPRequestType::RESOURCE_READ:
+            handleResourceRead(request.clientId, request.id, params);
+            break;
+        case MCPRequestType::RESOURCE_TEMPLATES_LIST:
+            handleResourceTemplatesList(request.clientId, request.id, params);
+            break;
+        case MCPRequestType::LOGGING_SET_LEVEL:
+            handleSetLogLevel(request.clientId, request.id, params);
+            break;
+        case MCPRequestType::SUBSCRIBE:
+            handleSubscribe(request.clientId, request.id, params);
+            break;
+        case MCPRequestType::UNSUBSCRIBE:
+            handleUnsubscribe(request.clientId, request.id, params);
+            break;
+        case MCPRequestType::TOOLS_LIST:
+            handleToolsList(request.clientId, request.id, params);
+            break;
+        case MCPRequestType::TOOLS_CALL:
+            handleToolsCall(request.clientId, request.id, params);
+            break;
+        default:
+            sendError(request.clientId, request.id, -32601, "Method not found");
+            break;
+    }
+
+    activeTrace = nullptr;
+    if (request.trace.elapsed(TracePhase::RECEIVED, TracePhase::SENT) > 0) {
+        RequestTracer::getInstance().complete(request.trace);
+    }
+}
+
+RequestTrace *MCPServer::currentTrace() {
+    // Transport tasks send concurrently with dispatch; only the dispatching
+    // task may stamp the active trace
+    return dispatchTask.load() == xTaskGetCurrentTaskHandle() ? activeTrace : nullptr;
+}
+
+void MCPServer::registerResource(const MCPResource &resource) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    resources.erase(resource.uri);
+    auto it = resources.emplace(resource.uri, resource).first;
+    it->second.notify.reset(resource.value, millis());
+}
+
+void MCPServer::unregisterResource(const std::string &uri) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    resources.erase(uri);
+}
+
+bool MCPServer::setResourceValue(const std::string &uri, const std::string &value) {
+    bool notify;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto it = resources.find(uri);
+        if (it == resources.end()) {
+            return false;
+        }
+        it->second.value = value;
+        notify = it->second.notify.update(value, millis());
+        if (notify && std::find(dueUpdates.begin(), dueUpdates.end(), uri) == dueUpdates.end()) {
+            dueUpdates.push_back(uri);
+        }
+    }
+    if (!notify) {
+        MetricsSystem::getInstance().incrementCounter("mcp.notify.suppressed");
+    }
+    return true;
+}
+
+bool MCPServer::setNotifyPolicy(const std::string &uri, const NotifyPolicy::Config &config) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = resources.find(uri);
+    if (it == resources.end()) {
+        return false;
+    }
+    it->second.notify.setConfig(config);
+    return true;
+}
+
+void MCPServer::flushResourceUpdates() {
+    std::vector<std::string> due;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        uint32_t now = millis();
+        if (now - lastNotifyPoll >= NOTIFY_POLL_INTERVAL) {
+            lastNotifyPoll = now;
+            for (auto &pair : resources) {
+                if (pair.second.notify.poll(now) &&
+                    std::find(dueUpdates.begin(), dueUpdates.end(), pair.first) == dueUpdates.end()) {
+                    dueUpdates.push_back(pair.first);
+                }
+            }
+        }
+        due.swap(dueUpdates);
+    }
+
+    // Sent from the MCP task whichever task set the value
+    for (const std::string &uri : due) {
+        broadcastResourceUpdate(uri);
+        MetricsSystem::getInstance().incrementCounter("mcp.notify.sent");
+    }
+}
+
+// MCP (syslog) level names onto MCP_LOG_LEVEL_x; -1 if unknown
+static int logLevelFromName(const char *name) {
+    static const struct {
+        const char *name;
+        uint8_t level;
+    } LEVELS[] = {
+        {"debug", MCP_LOG_LEVEL_DEBUG}, {"info", MCP_LOG_LEVEL_INFO}, {"notice", MCP_LOG_LEVEL_INFO},
+        {"warning", MCP_LOG_LEVEL_WARN}, {"error", MCP_LOG_LEVEL_ERROR}, {"critical", MCP_LOG_LEVEL_ERROR},
+        {"alert", MCP_LOG_LEVEL_ERROR}, {"emergency", MCP_LOG_LEVEL_ERROR},
+    };
+    for (const auto &entry : LEVELS) {
+        if (name && strcmp(name, entry.name) == 0) {
+            return entry.level;
+        }
+    }
+    return -1;
+}
+
+static const char *logLevelName(uint8_t level) {
+    switch (level) {
+        case MCP_LOG_LEVEL_ERROR: return "error";
+        case MCP_LOG_LEVEL_WARN: return "warning";
+        case MCP_LOG_LEVEL_DEBUG: return "debug";
+        default: return "info";
+    }
+}
+
+void MCPServer::updateLogTap() {
+    // The drain task only copies lines some session wants
+    uint8_t level = MCP_LOG_LEVEL_NONE;
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+        const Session *session = sessions.get(i);
+        if (session && session->logLevel > level) {
+            level = session->logLevel;
+        }
+    }
+    Log::getInstance().setTapLevel(level);
+}
+
+void MCPServer::flushLogs() {
+    uint32_t now = millis();
+    if (now - lastLogFlush < LOG_FLUSH_INTERVAL) {
+        return;
+    }
+    lastLogFlush = now;
+
+    LogTap &tap = Log::getInstance().getTap();
+    size_t count = std::min(tap.available(), MAX_LOG_BATCH);
+    // Lines the drain could not queue since the last flush; their levels
+    // are unknown, so every listening session is told
+    uint32_t dropped = tap.getDropped() - tapDropped;
+    tapDropped += dropped;
+    if (!count && !dropped) {
+        return;
+    }
+
+    // Lines each session gets, chosen under the lock and sent without it
+    struct Batch {
+        uint32_t lines;        // Bit per tap line
+        uint8_t level;         // Most severe line in the batch
+        size_t bytes;
+        uint32_t suppressed;   // Rate-limited lines to report
+        uint32_t overrun;      // Lines lost to the full tap to report
+    };
+    Batch batches[MAX_CLIENTS] = {};
+    uint32_t limited = 0;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            Session *session = sessions.get(i);
+            if (!session || !session->logLevel) {
+                continue;
+            }
+
+            // Token bucket; a long quiet spell only ever refills up to the burst
+            uint32_t elapsed = std::min<uint32_t>(now - session->logRefillAt, LOG_REFILL_CAP);
+            uint32_t refill = elapsed * logRate / 1000;
+            if (session->logTokens + refill >= logBurst) {
+                session->logTokens = logBurst;
+                session->logRefillAt = now;
+            } else if (refill) {
+                session->logTokens += refill;
+                session->logRefillAt += refill * 1000 / logRate;
+            }
+
+            Batch &batch = batches[i];
+            batch.level = MCP_LOG_LEVEL_DEBUG;
+            session->logOverrun += dropped;
+            for (size_t n = 0; n < count; n++) {
+                const LogTap::Line &line = tap.peek(n);
+                if (line.level > session->logLevel) {
+                    continue;
+                }
+                if (!session->logTokens) {
+                    session->logSuppressed++;
+                    limited++;
+                    continue;
+                }
+                session->logTokens--;
+                batch.lines |= 1u << n;
+                batch.bytes += line.length;
+                batch.level = std::min(batch.level, line.level);
+            }
+            if (batch.lines || session->logOverrun) {
+                batch.suppressed = session->logSuppressed;
+                session->logSuppressed = 0;
+                batch.overrun = session->logOverrun;
+                session->logOverrun = 0;
+            }
+            if (batch.overrun) {
+                batch.level = std::min<uint8_t>(batch.level, MCP_LOG_LEVEL_WARN);
+            }
+        }
+    }
+
+    uint32_t sent = 0;
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+        const Batch &batch = batches[i];
+        if (!batch.lines && !batch.overrun) {
+            continue;
+        }
+        char note[48];
+        int noteLength = batch.suppressed ? snprintf(note, sizeof(note), "(%lu lines dropped by rate limit)",
+                                                     static_cast<unsigned long>(batch.suppressed)) : 0;
+        char overrunNote[48];
+        int overrunLength = batch.overrun ? snprintf(overrunNote, sizeof(overrunNote), "(%lu lines dropped: log queue full)",
+                                                     static_cast<unsigned long>(batch.overrun)) : 0;
+
+        // One notification per batch; data holds the lines as printed on Serial
+        transmitWritten(i, 96 + batch.bytes + batch.bytes / 8 + noteLength + overrunLength + 2 * count, [&](auto &writer) {
+            writer.beginObject().rawKey(JsonRpc::METHOD_KEY).value("notifications/message")
+                  .key("params").beginObject()
+                      .key("level").value(logLevelName(batch.level))
+                      .key("logger").value(serverInfo.name)
+                      .key("data").beginArray();
+            if (overrunLength > 0) {
+                writer.value(overrunNote, static_cast<size_t>(overrunLength));
+            }
+            if (noteLength > 0) {
+                writer.value(note, static_cast<size_t>(noteLength));
+            }
+            for (size_t n = 0; n < count; n++) {
+                if (batch.lines & (1u << n)) {
+                    writer.value(tap.peek(n).text, tap.peek(n).length);
+                }
+            }
+            writer.endArray().endObject().endObject();
+        });
+        sent += __builtin_popcount(batch.lines);
+    }
+    tap.consume(count);
+
+    MetricsSystem &metrics = MetricsSystem::getInstance();
+    if (sent) {
+        metrics.incrementCounter("mcp.log.sent", sent);
+    }
+    if (limited) {
+        metrics.incrementCounter("mcp.log.limited", limited);
+    }
+    if (dropped) {
+        metrics.incrementCounter("mcp.log.dropped", dropped);
+    }
+}
+
+bool MCPServer::registerResourceTemplate(const MCPResourceTemplate &resourceTemplate) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    int id = templateMatcher.add(resourceTemplate.uriTemplate);
+    if (id == UriTemplateMatcher::NO_MATCH) {
+        MCP_LOGW("Invalid resource template: %s", resourceTemplate.uriTemplate.c_str());
+        return false;
+    }
+
+    // Map nodes keep their address, so templatesById stays valid
+    MCPResourceTemplate &stored = resourceTemplates[resourceTemplate.uriTemplate];
+    stored = resourceTemplate;
+    if (static_cast<size_t>(id) >= templatesById.size()) {
+        templatesById.resize(id + 1);
+    }
+    templatesById[id] = &stored;
+    return true;
+}
+
+void MCPServer::registerTool(const MCPTool &tool) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    tools[tool.name] = tool;
 }
 
 void MCPServer::handleInitialize(uint8_t clientId, const RequestId &id, const JsonObject &params) {
-    std::cout << "收到初始化请求 - 客户端ID: " << (int)clientId << std::endl;
-    std::cout << "请求参数: ";
-    serializeJson(params, std::cout);
-    std::cout << std::endl;
+    MCP_LOGD("收到初始化请求 - 客户端ID: %d", clientId);
+
+    // Optional binary encoding and compression; the client lists what it
+    // accepts in capabilities.experimental, e.g. "encodings": ["msgpack"],
+    // "compression": ["deflate"]. Both need binary frames.
+    JsonObjectConst offered = params["capabilities"]["experimental"];
+    bool binary = supportsBinary(clientId);
+    Encoding encoding = binary && contains(offered["encodings"], "msgpack") ? Encoding::MSGPACK : Encoding::JSON;
+    bool compress = binary && contains(offered["compression"], "deflate");
 
-    JsonDocument doc;
-    JsonObject result = doc["result"].to<JsonObject>();
-    result["serverName"] = serverInfo.name;
-    result["serverVersion"] = serverInfo.version;
+    if (RequestTrace *trace = currentTrace()) {
+        trace->mark(TracePhase::HANDLED);
+    }
+
+    // The initialize result itself is always JSON so the client can read
+    // the choice; everything after it uses the agreed encoding
+    transmitWritten(clientId, INITIALIZE_SIZE_HINT, [&](auto &writer) {
+        writer.beginObject().rawKey(JsonRpc::ID_KEY).value(id)
+              .key("result").beginObject()
+                  .key("protocolVersion").value(PROTOCOL_VERSION)
+                  .key("serverInfo").beginObject()
+                      .key("name").value(serverInfo.name)
+                      .key("version").value(serverInfo.version)
+                  .endObject()
+                  .key("capabilities").beginObject();
+        if (capabilities.supportsResources) {
+            writer.key("resources").beginObject().key("subscribe").value(capabilities.supportsSubscriptions).endObject();
+        }
+        writer.key("tools").beginObject().endObject();
+        writer.key("logging").beginObject().endObject();
+        if (encoding != Encoding::JSON || compress) {
+            writer.key("experimental").beginObject();
+            if (encoding == Encoding::MSGPACK) {
+                writer.key("encoding").value("msgpack");
+            }
+            if (compress) {
+                writer.key("compression").value("deflate");
+            }
+            writer.endObject();
+        }
+        writer.endObject()
+              // Fields read by the bundled web console
+              .key("serverName").value(serverInfo.name)
+              .key("serverVersion").value(serverInfo.version)
+              .endObject()
+              .endObject();
+    });
+
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    if (Session *session = sessions.get(clientId)) {
+        session->initialized = true;
+        session->encoding = encoding;
+        session->compress = compress;
+        strlcpy(session->protocolVersion, params["protocolVersion"] | "", sizeof(session->protocolVersion));
+    }
+}
 
-    sendResponse(clientId, id, MCPResponse(true, "Initialized", result));
+bool MCPServer::supportsBinary(uint8_t clientId) {
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    const Session *session = sessions.get(clientId);
+    return session && session->transport->supportsBinary();
 }
 
 void MCPServer::handleResourcesList(uint8_t clientId, const RequestId &id, const JsonObject &params) {
-    std::cout << "收到资源列表请求 - 客户端ID: " << (int)clientId << std::endl;
-    std::cout << "请求参数: ";
-    serializeJson(params, std::cout);
-    std::cout << std::endl;
+    MCP_LOGD("收到资源列表请求 - 客户端ID: %d", clientId);
+
+    MCPResponse response(true, "Resources Listed");
+    JsonArray resourcesArray = response.data["resources"].to<JsonArray>();
+
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        addPage(resources, params["cursor"].as<const char *>(), pageSize, response.data.as<JsonObject>(),
+                [&](const MCPResource &resource) {
+            JsonObject resObj = resourcesArray.add<JsonObject>();
+            resObj["uri"] = resource.uri;
+            resObj["name"] = resource.name;
+            resObj["mimeType"] = resource.type;
+            resObj["description"] = resource.value;
+        });
+    }
 
-    JsonDocument doc;
-    JsonArray resourcesArray = doc["resources"].to<JsonArray>();
+    sendResponse(clientId, id, response);
+}
+
+void MCPServer::handleResourceTemplatesList(uint8_t clientId, const RequestId &id, const JsonObject &params) {
+    MCP_LOGD("收到资源模板列表请求 - 客户端ID: %d", clientId);
 
-    JsonObject resObj = resourcesArray.add<JsonObject>();
-    resObj["name"] = "Resource1";
-    resObj["type"] = "Type1";
+    MCPResponse response(true, "Resource Templates Listed");
+    JsonArray templatesArray = response.data["resourceTemplates"].to<JsonArray>();
+
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        addPage(resourceTemplates, params["cursor"].as<const char *>(), pageSize, response.data.as<JsonObject>(),
+                [&](const MCPResourceTemplate &resourceTemplate) {
+            JsonObject entry = templatesArray.add<JsonObject>();
+            entry["uriTemplate"] = resourceTemplate.uriTemplate;
+            entry["name"] = resourceTemplate.name;
+            entry["mimeType"] = resourceTemplate.mimeType;
+            entry["description"] = resourceTemplate.description;
+        });
+    }
 
-    sendResponse(clientId, id, MCPResponse(true, "Resources Listed", doc.as<JsonVariant>()));
+    sendResponse(clientId, id, response);
 }
 
 void MCPServer::handleResourceRead(uint8_t clientId, const RequestId &id, const JsonObject &params) {
-    std::cout << "收到资源读取请求 - 客户端ID: " << (int)clientId << std::endl;
-    std::cout << "请求参数: ";
-    serializeJson(params, std::cout);
-    std::cout << std::endl;
+    MCP_LOGD("收到资源读取请求 - 客户端ID: %d", clientId);
 
-    if (!params["uri"].is<std::string>()) {
-        sendError(clientId, id, 400, "Invalid URI");
+    const char *uri = params["uri"];
+    if (!uri) {
+        sendError(clientId, id, -32602, "Invalid URI");
         return;
     }
 
-    JsonDocument doc;
-    JsonArray contents = doc["contents"].to<JsonArray>();
+    ResourceReader reader;
+    BlobSource blob;
+    ResourceTemplateReader templateReader;
+    UriParams uriParams;
+    std::string text;
+    std::string mimeType;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto it = resources.find(uri);
+        if (it != resources.end()) {
+            reader = it->second.reader;
+            blob = it->second.blob;
+            text = it->second.value;
+            mimeType = it->second.type;
+        } else {
+            // Concrete resources take precedence over templates
+            int match = templateMatcher.match(uri, uriParams);
+            if (match == UriTemplateMatcher::NO_MATCH) {
+                sendError(clientId, id, -32002, "Resource not found");
+                return;
+            }
+            templateReader = templatesById[match]->reader;
+            mimeType = templatesById[match]->mimeType;
+        }
+    }
+
+    // Readers run outside the registry lock; they may be slow
+    if (blob) {
+        sendBlob(clientId, id, uri, mimeType, blob, params);
+        return;
+    }
+    if (reader) {
+        text = reader();
+    } else if (templateReader && !templateReader(uriParams, text)) {
+        sendError(clientId, id, -32002, "Resource not found");
+        return;
+    }
+
+    MCPResponse response(true, "Resource Read");
+    JsonArray contents = response.data["contents"].to<JsonArray>();
     JsonObject content = contents.add<JsonObject>();
-    content["data"] = "Sample Data";
+    content["uri"] = uri;
+    content["mimeType"] = mimeType;
+    content["text"] = text;
+
+    sendResponse(clientId, id, response);
+}
+
+template <typename Build>
+static bool writeJson(PooledBuffer &buffer, Build &build) {
+    BufferOutput out(buffer.data(), buffer.valid() ? buffer.capacity() : 0);
+    JsonWriter<BufferOutput> writer(out);
+    build(writer);
+    buffer.setLength(out.length());
+    return buffer.valid() && writer.ok();
+}
+
+/**
+ * Write a message with a JsonWriter into a new buffer
+ * @param sizeHint Expected length; a larger message costs an extra measuring pass
+ */
+template <typename Build>
+static bool writeMessage(size_t sizeHint, Build &build, PooledBuffer &buffer) {
+    // One pass into a buffer of the hinted size; measure and redo only if it was too small
+    buffer = PooledBuffer(sizeHint);
+    if (writeJson(buffer, build)) {
+        return true;
+    }
+    CountingOutput counter;
+    JsonWriter<CountingOutput> measure(counter);
+    build(measure);
+    buffer = PooledBuffer(counter.length);
+    return writeJson(buffer, build);
+}
 
-    sendResponse(clientId, id, MCPResponse(true, "Resource Read", doc.as<JsonVariant>()));
+/**
+ * Write a JSON-RPC error response
+ */
+template <typename Writer>
+static void writeError(Writer &writer, const RequestId &id, int code, const std::string &message) {
+    writer.beginObject().rawKey(JsonRpc::ID_KEY).value(id)
+          .key("error").beginObject()
+              .key("code").value(static_cast<int32_t>(code))
+              .key("message").value(message)
+          .endObject()
+          .endObject();
+}
+
+/**
+ * Read a range of a blob and write it as base64, a piece at a time, so
+ * memory use does not depend on the range's size
+ * @param total Set to the number of bytes read
+ */
+template <typename Output>
+static bool writeBase64(const BlobReader &read, size_t offset, size_t length, Output &output, size_t &total) {
+    static constexpr size_t PIECE_SIZE = 384;
+    uint8_t piece[PIECE_SIZE];
+    char text[Base64Encoder::encodedLength(PIECE_SIZE + 2)];
+    Base64Encoder encoder;
+
+    total = 0;
+    while (total < length) {
+        size_t wanted = std::min(PIECE_SIZE, length - total);
+        size_t got = read(offset + total, piece, wanted);
+        total += got;
+        if (!output.write(text, encoder.update(piece, got, text))) {
+            return false;
+        }
+        if (got < wanted) {
+            break; // The resource shrank since its size was taken
+        }
+    }
+    return output.write(text, encoder.finish(text));
+}
+
+void MCPServer::sendBlob(uint8_t clientId, const RequestId &id, const char *uri, const std::string &mimeType,
+                         const BlobSource &blob, const JsonObject &params) {
+    size_t size = blob.size();
+    size_t offset = params["offset"].as<uint32_t>();
+    if (offset > size) {
+        sendError(clientId, id, -32602, "Offset beyond end of resource");
+        return;
+    }
+    size_t length = params["length"].is<uint32_t>() ? params["length"].as<uint32_t>() : MAX_BLOB_CHUNK;
+    if (length == 0) {
+        sendError(clientId, id, -32602, "Length must be positive");
+        return;
+    }
+    length = std::min({length, MAX_BLOB_CHUNK, size - offset});
+    // The range is read while it is encoded, so the read counts as serialization
+    if (RequestTrace *trace = currentTrace()) {
+        trace->mark(TracePhase::HANDLED);
+    }
+
+    size_t read = 0;
+    size_t sizeHint = BLOB_ENVELOPE_SIZE + strlen(uri) + mimeType.size() + Base64Encoder::encodedLength(length);
+    auto build = [&](auto &writer) {
+        writer.beginObject().rawKey(JsonRpc::ID_KEY).value(id)
+              .key("result").beginObject()
+                  .key("contents").beginArray()
+                      .beginObject()
+                          .key("uri").value(uri)
+                          .key("mimeType").value(mimeType)
+                          .key("blob").rawString([&](auto &output) {
+                              return writeBase64(blob.read, offset, length, output, read);
+                          })
+                      .endObject()
+                  .endArray()
+                  .key("offset").value(static_cast<uint64_t>(offset))
+                  .key("size").value(static_cast<uint64_t>(size));
+        if (offset + read < size) {
+            writer.key("nextOffset").value(static_cast<uint64_t>(offset + read));
+        }
+        writer.endObject().endObject();
+    };
+
+    PooledBuffer buffer;
+    if (!writeMessage(sizeHint, build, buffer)) {
+        // No memory for the range; the short error still fits
+        buffer = PooledBuffer();
+        sendError(clientId, id, -32603, "Response allocation failed");
+        return;
+    }
+    // A range that yields nothing would hand back nextOffset == offset forever
+    if (read == 0 && length > 0) {
+        sendError(clientId, id, -32603, "Resource read failed");
+        return;
+    }
+    markSerialized();
+    transmitJson(clientId, buffer);
 }
 
 void MCPServer::handleSubscribe(uint8_t clientId, const RequestId &id, const JsonObject &params) {
-    std::cout << "收到订阅请求 - 客户端ID: " << (int)clientId << std::endl;
-    std::cout << "请求参数: ";
-    serializeJson(params, std::cout);
-    std::cout << std::endl;
+    MCP_LOGD("收到订阅请求 - 客户端ID: %d", clientId);
 
-    if (!params["uri"].is<std::string>()) {
-        sendError(clientId, id, 400, "Invalid URI");
+    if (!params["uri"].is<const char*>()) {
+        sendError(clientId, id, -32602, "Invalid URI");
         return;
     }
 
-    sendResponse(clientId, id, MCPResponse(true, "Subscribed", JsonVariant()));
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        if (Session *session = sessions.get(clientId)) {
+            session->subscribe(params["uri"].as<const char *>());
+        }
+    }
+    sendResponse(clientId, id, MCPResponse(true, "Subscribed"));
 }
 
 void MCPServer::handleUnsubscribe(uint8_t clientId, const RequestId &id, const JsonObject &params) {
-    std::cout << "收到取消订阅请求 - 客户端ID: " << (int)clientId << std::endl;
-    std::cout << "请求参数: ";
-    serializeJson(params, std::cout);
-    std::cout << std::endl;
+    MCP_LOGD("收到取消订阅请求 - 客户端ID: %d", clientId);
 
-    if (!params["uri"].is<std::string>()) {
-        sendError(clientId, id, 400, "Invalid URI");
+    if (!params["uri"].is<const char*>()) {
+        sendError(clientId, id, -32602, "Invalid URI");
         return;
     }
 
-    sendResponse(clientId, id, MCPResponse(true, "Unsubscribed", JsonVariant()));
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        if (Session *session = sessions.get(clientId)) {
+            session->unsubscribe(params["uri"].as<const char *>());
+        }
+    }
+    sendResponse(clientId, id, MCPResponse(true, "Unsubscribed"));
 }
 
-void MCPServer::unregisterResource(const std::string &uri) {
-    JsonDocument doc;
-    JsonObject resource = doc.to<JsonObject>();
-    resource["uri"] = uri;
+void MCPServer::handleToolsList(uint8_t clientId, const RequestId &id, const JsonObject &params) {
+    MCP_LOGD("收到工具列表请求 - 客户端ID: %d", clientId);
+
+    MCPResponse response(true, "Tools Listed");
+    JsonArray toolsArray = response.data["tools"].to<JsonArray>();
+
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        addPage(tools, params["cursor"].as<const char *>(), pageSize, response.data.as<JsonObject>(),
+                [&](const MCPTool &entry) {
+            JsonObject tool = toolsArray.add<JsonObject>();
+            tool["name"] = entry.name;
+            tool["description"] = entry.description;
+            JsonDocument schema(&MemoryPool::getInstance());
+            deserializeJson(schema, entry.inputSchema);
+            tool["inputSchema"] = schema;
+        });
+    }
+
+    sendResponse(clientId, id, response);
+}
+
+void MCPServer::handleToolsCall(uint8_t clientId, const RequestId &id, const JsonObject &params) {
+    MCP_LOGD("收到工具调用请求 - 客户端ID: %d", clientId);
+
+    // A retry of a call already made: answer again without running the tool
+    if (replay(clientId, id)) {
+        return;
+    }
+
+    const char *name = params["name"];
+    ToolHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto it = name ? tools.find(name) : tools.end();
+        if (it == tools.end()) {
+            sendError(clientId, id, -32602, "Unknown tool");
+            return;
+        }
+        handler = it->second.handler;
+    }
+
+    std::string text;
+    bool ok = handler(params["arguments"].as<JsonObjectConst>(), text);
+    if (RequestTrace *trace = currentTrace()) {
+        trace->mark(TracePhase::HANDLED);
+    }
+
+    auto build = [&](auto &writer) {
+        writer.beginObject().rawKey(JsonRpc::ID_KEY).value(id)
+              .key("result").beginObject()
+                  .key("content").beginArray()
+                      .beginObject().key("type").value("text").key("text").value(text).endObject()
+                  .endArray()
+                  .key("isError").value(!ok)
+              .endObject()
+              .endObject();
+    };
+
+    // Envelope, content item and escaped text: room for some escapes
+    PooledBuffer buffer;
+    bool written = writeMessage(96 + text.size() + text.size() / 8, build, buffer);
+    if (!written) {
+        // The tool has run, so the client still gets an answer, and it is
+        // cached like any other so that a retry does not run the tool again
+        MCP_LOGW("No memory for the result of tool %s", name);
+        buffer = PooledBuffer();
+        auto failure = [&](auto &writer) { writeError(writer, id, -32603, "Response allocation failed"); };
+        if (!writeMessage(96, failure, buffer)) {
+            return;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        if (Session *session = sessions.get(clientId)) {
+            session->replay.store(id, buffer.data(), buffer.length());
+            if (!written) {
+                session->errors++;
+            }
+        }
+    }
+    markSerialized();
+    transmitJson(clientId, buffer);
+}
+
+bool MCPServer::replay(uint8_t clientId, const RequestId &id) {
+    PooledBuffer buffer;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        Session *session = sessions.get(clientId);
+        const std::string *response = session ? session->replay.find(id) : nullptr;
+        if (!response) {
+            return false;
+        }
+        // The cached bytes are copied out so the send happens without the lock
+        buffer = PooledBuffer(response->size());
+        if (!buffer.append(response->data(), response->size())) {
+            return false;
+        }
+    }
+
+    MCP_LOGD("重放缓存响应 - 客户端ID: %d", clientId);
+    MetricsSystem::getInstance().incrementCounter("mcp.replay.hits");
+    // Already serialized when it was cached
+    if (RequestTrace *trace = currentTrace()) {
+        trace->mark(TracePhase::HANDLED);
+    }
+    markSerialized();
+    transmitJson(clientId, buffer);
+    return true;
+}
+
+void MCPServer::handleSetLogLevel(uint8_t clientId, const RequestId &id, const JsonObject &params) {
+    MCP_LOGD("收到日志级别请求 - 客户端ID: %d", clientId);
+
+    int level = logLevelFromName(params["level"]);
+    if (level < 0) {
+        sendError(clientId, id, -32602, "Invalid log level");
+        return;
+    }
+    // Statements more verbose than MCP_LOG_LEVEL are compiled out (the
+    // default INFO build has no debug lines), so a lower level is accepted
+    // but only ever yields lines down to the compiled floor
+    level = std::min(level, MCP_LOG_LEVEL);
+
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        if (Session *session = sessions.get(clientId)) {
+            if (!session->logLevel) {
+                session->logTokens = logBurst;
+                session->logRefillAt = millis();
+            }
+            session->logLevel = static_cast<uint8_t>(level);
+        }
+        updateLogTap();
+    }
+    if (RequestTrace *trace = currentTrace()) {
+        trace->mark(TracePhase::HANDLED);
+    }
+
+    transmitWritten(clientId, 48, [&](auto &writer) {
+        writer.beginObject().rawKey(JsonRpc::ID_KEY).value(id)
+              .key("result").beginObject().endObject()
+              .endObject();
+    });
+}
+
+bool MCPServer::findRoute(uint8_t clientId, Route &route) {
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    const Session *session = sessions.get(clientId);
+    if (!session) {
+        return false;
+    }
+    route = {session->transport, session->connectionId, session->encoding, session->compress};
+    return true;
+}
+
+bool MCPServer::transmit(uint8_t clientId, const JsonDocument &doc) {
+    Route route;
+    if (!findRoute(clientId, route)) {
+        return false;
+    }
+
+    bool binary = route.encoding == Encoding::MSGPACK;
+    PooledBuffer buffer((binary ? measureMsgPack(doc) : measureJson(doc)) + 1);
+    if (!buffer.valid()) {
+        return false;
+    }
+    buffer.setLength(binary ? serializeMsgPack(doc, buffer.data(), buffer.capacity())
+                            : serializeJson(doc, buffer.data(), buffer.capacity()));
+    markSerialized();
+    return deliver(route, buffer, binary);
+}
+
+template <typename Build>
+bool MCPServer::transmitWritten(uint8_t clientId, size_t sizeHint, Build build) {
+    PooledBuffer buffer;
+    if (!writeMessage(sizeHint, build, buffer)) {
+        return false;
+    }
+    markSerialized();
+    return transmitJson(clientId, buffer);
+}
+
+bool MCPServer::transmitJson(uint8_t clientId, const PooledBuffer &buffer) {
+    Route route;
+    if (!findRoute(clientId, route)) {
+        return false;
+    }
+
+    if (route.encoding == Encoding::MSGPACK) {
+        // The writer only emits JSON; MessagePack sessions take the document path
+        JsonDocument doc(&MemoryPool::getInstance());
+        if (deserializeJson(doc, buffer.data(), buffer.length())) {
+            return false;
+        }
+        return transmit(clientId, doc);
+    }
+    return deliver(route, buffer, false);
+}
+
+void MCPServer::markSerialized() {
+    RequestTrace *trace = currentTrace();
+    if (trace) {
+        trace->mark(TracePhase::SERIALIZED);
+    }
+}
+
+bool MCPServer::deliver(const Route &route, const PooledBuffer &buffer, bool binary) {
+    RequestTrace *trace = currentTrace();
+    // No locks held here: transports may call back into onDisconnect()
+    bool sent;
+    if (route.compress && buffer.length() >= compressionThreshold) {
+        sent = transmitCompressed(route.transport, route.connectionId, buffer, binary);
+    } else if (binary) {
+        sent = route.transport->sendBinary(route.connectionId, reinterpret_cast<const uint8_t *>(buffer.data()),
+                                           buffer.length());
+    } else {
+        sent = route.transport->send(route.connectionId, buffer.data(), buffer.length());
+    }
+    if (trace && sent) {
+        trace->mark(TracePhase::SENT);
+    }
+    return sent;
+}
+
+bool MCPServer::transmitCompressed(Transport *transport, uint32_t connectionId, const PooledBuffer &buffer, bool binary) {
+    const uint8_t *raw = reinterpret_cast<const uint8_t *>(buffer.data());
+
+    // Capacity of the input size: output that does not shrink is not sent
+    PooledBuffer frame(buffer.length());
+    size_t compressed = 0;
+    uint32_t started = micros();
+    if (frame.valid()) {
+        uint8_t *out = reinterpret_cast<uint8_t *>(frame.data());
+        out[0] = binary ? FRAME_DEFLATE_MSGPACK : FRAME_DEFLATE_JSON;
+        std::lock_guard<std::mutex> lock(deflateMutex);
+        compressed = deflater.compress(raw, buffer.length(), out + 1, frame.capacity() - 1);
+    }
+    uint32_t elapsed = micros() - started;
+
+    if (compressed == 0) {
+        return binary ? transport->sendBinary(connectionId, raw, buffer.length())
+                      : transport->send(connectionId, buffer.data(), buffer.length());
+    }
+
+    MetricsSystem &metrics = MetricsSystem::getInstance();
+    metrics.recordHistogram("mcp.deflate.ratio", 100.0 * (compressed + 1) / buffer.length());
+    metrics.recordHistogram("mcp.deflate.time", elapsed / 1000.0);
+    metrics.incrementCounter("mcp.deflate.saved", buffer.length() - compressed - 1);
+    return transport->sendBinary(connectionId, reinterpret_cast<const uint8_t *>(frame.data()), compressed + 1);
 }
 
 void MCPServer::sendResponse(uint8_t clientId, const RequestId &id, const MCPResponse &response) {
-    std::cout << "发送响应 - 客户端ID: " << (int)clientId << std::endl;
-    std::cout << "响应内容: ";
-    JsonDocument doc;
+    if (RequestTrace *trace = currentTrace()) {
+        trace->mark(TracePhase::HANDLED);
+    }
+
+    JsonDocument doc(&MemoryPool::getInstance());
+    doc["jsonrpc"] = "2.0";
     doc["id"] = id;
-    doc["success"] = response.success;
-    doc["message"] = response.message;
-    doc["data"] = response.data;
-    serializeJson(doc, std::cout);
-    std::cout << std::endl;
+    if (response.success) {
+        doc["result"] = response.data;
+    } else {
+        doc["error"]["code"] = -32603;
+        doc["error"]["message"] = response.message;
+    }
 
-    std::string jsonResponse;
-    serializeJson(doc, jsonResponse);
-    // Transmit response
+    transmit(clientId, doc);
 }
 
 void MCPServer::sendError(uint8_t clientId, const RequestId &id, int code, const std::string &message) {
-    std::cout << "发送错误 - 客户端ID: " << (int)clientId << std::endl;
-    std::cout << "错误代码: " << code << std::endl;
-    std::cout << "错误信息: " << message << std::endl;
-
-    JsonDocument doc;
-    JsonObject error = doc["error"].to<JsonObject>();
-    error["code"] = code;
-    error["message"] = message;
+    MCP_LOGD("发送错误 - 客户端ID: %d 错误代码: %d 错误信息: %s", clientId, code, message.c_str());
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        if (Session *session = sessions.get(clientId)) {
+            session->errors++;
+        }
+    }
+    if (RequestTrace *trace = currentTrace()) {
+        trace->mark(TracePhase::HANDLED);
+    }
 
-    std::string jsonError;
-    serializeJson(doc, jsonError);
-    // Transmit error
+    transmitWritten(clientId, 64 + message.size(), [&](auto &writer) {
+        writeError(writer, id, code, message);
+    });
 }
 
 void MCPServer::broadcastResourceUpdate(const std::string &uri) {
-    JsonDocument doc;
-    JsonObject params = doc["params"].to<JsonObject>();
-    params["uri"] = uri;
+    JsonDocument doc(&MemoryPool::getInstance());
+    doc["jsonrpc"] = "2.0";
+    doc["method"] = "notifications/resources/updated";
+    doc["params"]["uri"] = uri;
 
-    // Broadcast logic
+    // Only to the sessions subscribed to the resource
+    bool subscribed[MAX_CLIENTS] = {};
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+            const Session *session = sessions.get(i);
+            subscribed[i] = session && session->isSubscribed(uri);
+        }
+    }
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+        if (subscribed[i]) {
+            transmit(i, doc);
+        }
+    }
 }
 
-MCPRequest MCPServer::parseRequest(const std::string &json) {
-    std::cout << "收到原始请求数据: " << json << std::endl;
+MCPRequest MCPServer::parseFrame(uint8_t clientId, const uint8_t *data, size_t len, Encoding encoding,
+                                 DeserializationError &error) {
+    MCPRequest request;
+    request.trace.begin(clientId);
+    request.clientId = clientId;
 
-    JsonDocument doc;
-    deserializeJson(doc, json);
+    error = frameParser.parse(data, len, request.doc, encoding);
+    request.trace.mark(TracePhase::PARSED);
+    if (error) {
+        return request; // type stays UNKNOWN
+    }
 
-    MCPRequest request;
-    request.type = MCPRequestType::INITIALIZE;
-    request.id = doc["id"];
-    request.params = doc["params"].as<JsonObject>();
+    request.type = requestTypeFromMethod(request.method());
+    request.id = request.doc["id"].as<RequestId>();
+    request.trace.setMethod(request.method(), request.type);
+    request.trace.id = request.id;
     return request;
 }
 
+MCPRequest MCPServer::parseRequest(uint8_t clientId, const std::string &json) {
+    DeserializationError error;
+    return parseFrame(clientId, reinterpret_cast<const uint8_t *>(json.data()), json.size(), Encoding::JSON, error);
+}
+
 std::string MCPServer::serializeResponse(const RequestId &id, const MCPResponse &response) {
-    JsonDocument doc;
+    JsonDocument doc(&MemoryPool::getInstance());
+    doc["jsonrpc"] = "2.0";
     doc["id"] = id;
-    doc["success"] = response.success;
-    doc["message"] = response.message;
-    doc["data"] = response.data;
+    doc["result"] = response.data;
 
     std::string jsonResponse;
     serializeJson(doc, jsonResponse);
@@ -0,0 +1,275 @@
+#include "MemoryPool.h"
+#include "MetricsSystem.h"
+#include <stdlib.h>
+
+using namespace mcp;
+
+namespace {
+
+constexpr size_t arenaSize() {
+    size_t total = 0;
+    for (size_t i = 0; i < MemoryPool::CLASS_COUNT; i++) {
+        total += MemoryPool::BLOCK_SIZES[i] * MemoryPool::BLOCK_COUNTS[i];
+    }
+    return total;
+}
+
+// Reserved in .bss so the pool never competes with the heap for its arena
+alignas(8) uint8_t arena[arenaSize()];
+
+} // namespace
+
+MemoryPool::MemoryPool()
+    : fallbacks(0),
+      failures(0),
+      publishedFallbacks(0),
+      publishedFailures(0),
+      metricsRegistered(false) {
+    uint8_t* cursor = arena;
+    for (size_t i = 0; i < CLASS_COUNT; i++) {
+        SizeClass& sizeClass = classes[i];
+        sizeClass.begin = cursor;
+        sizeClass.end = cursor + BLOCK_SIZES[i] * BLOCK_COUNTS[i];
+        sizeClass.freeList = nullptr;
+        sizeClass.inUse = 0;
+        sizeClass.highWater = 0;
+
+        // Thread blocks onto the free list back to front so allocation
+        // starts at the low end of each region
+        for (size_t b = BLOCK_COUNTS[i]; b > 0; b--) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(cursor + (b - 1) * BLOCK_SIZES[i]);
+            block->next = sizeClass.freeList;
+            sizeClass.freeList = block;
+        }
+        cursor = sizeClass.end;
+    }
+}
+
+int MemoryPool::classOf(const void* ptr) const {
+    const uint8_t* p = static_cast<const uint8_t*>(ptr);
+    for (size_t i = 0; i < CLASS_COUNT; i++) {
+        if (p >= classes[i].begin && p < classes[i].end) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void* MemoryPool::takeBlock(size_t size) {
+    // Smallest class that fits, else a nearby larger one (MAX_SPILL)
+    size_t fit = 0;
+    while (fit < CLASS_COUNT && BLOCK_SIZES[fit] < size) {
+        fit++;
+    }
+    for (size_t i = fit; i < CLASS_COUNT && i <= fit + MAX_SPILL; i++) {
+        if (i > fit && i == CLASS_COUNT - 1) {
+            break;
+        }
+        SizeClass& sizeClass = classes[i];
+        if (!sizeClass.freeList) {
+            continue;
+        }
+        FreeBlock* block = sizeClass.freeList;
+        sizeClass.freeList = block->next;
+        sizeClass.inUse++;
+        if (sizeClass.inUse > sizeClass.highWater) {
+            sizeClass.highWater = sizeClass.inUse;
+        }
+        return block;
+    }
+    return nullptr;
+}
+
+void* MemoryPool::allocate(size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        void* block = takeBlock(size);
+        if (block) {
+            return block;
+        }
+        fallbacks++;
+    }
+
+    void* ptr = malloc(size);
+    if (!ptr) {
+        std::lock_guard<std::mutex> lock(mutex);
+        failures++;
+    }
+    return ptr;
+}
+
+void MemoryPool::deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    int index = classOf(ptr);
+    if (index < 0) {
+        free(ptr);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    SizeClass& sizeClass = classes[index];
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = sizeClass.freeList;
+    sizeClass.freeList = block;
+    sizeClass.inUse--;
+}
+
+void* MemoryPool::reallocate(void* ptr, size_t newSize) {
+    if (!ptr) {
+        return allocate(newSize);
+    }
+
+    int index = classOf(ptr);
+    if (index < 0) {
+        void* grown = realloc(ptr, newSize);
+        if (!grown && newSize > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            failures++;
+        }
+        return grown;
+    }
+
+    size_t blockSize = BLOCK_SIZES[index];
+    // Shrinking (ArduinoJson's shrinkToFit) keeps the block unless a smaller
+    // class would fit, which returns the large block to its pool
+    bool fits = newSize <= blockSize;
+    bool smallerClassFits = index > 0 && newSize <= BLOCK_SIZES[index - 1];
+    if (fits && !smallerClassFits) {
+        return ptr;
+    }
+
+    void* moved = allocate(newSize);
+    if (!moved) {
+        return fits ? ptr : nullptr;
+    }
+    memcpy(moved, ptr, fits ? newSize : blockSize);
+    deallocate(ptr);
+    return moved;
+}
+
+MemoryPool::ClassStats MemoryPool::getClassStats(size_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (index >= CLASS_COUNT) {
+        return ClassStats{0, 0, 0, 0};
+    }
+    return ClassStats{BLOCK_SIZES[index], BLOCK_COUNTS[index],
+                      classes[index].inUse, classes[index].highWater};
+}
+
+uint32_t MemoryPool::getFallbackCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fallbacks;
+}
+
+uint32_t MemoryPool::getFailureCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failures;
+}
+
+void MemoryPool::publishMetrics() {
+    MetricsSystem& metrics = MetricsSystem::getInstance();
+
+    if (!metricsRegistered) {
+        for (size_t i = 0; i < CLASS_COUNT; i++) {
+            String prefix = "mem.pool." + String(BLOCK_SIZES[i]);
+            metrics.registerGauge(prefix + ".inuse", "Pool blocks in use", "blocks", "memory");
+            metrics.registerGauge(prefix + ".highwater", "Pool blocks high-water mark", "blocks", "memory");
+        }
+        metrics.registerCounter("mem.pool.fallbacks", "Pool requests served from the heap", "", "memory");
+        metrics.registerCounter("mem.pool.failures", "Pool requests that could not be served", "", "memory");
+        metricsRegistered = true;
+    }
+
+    uint32_t fallbackDelta;
+    uint32_t failureDelta;
+    ClassStats stats[CLASS_COUNT];
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < CLASS_COUNT; i++) {
+            stats[i] = ClassStats{BLOCK_SIZES[i], BLOCK_COUNTS[i], classes[i].inUse, classes[i].highWater};
+        }
+        fallbackDelta = fallbacks - publishedFallbacks;
+        failureDelta = failures - publishedFailures;
+        publishedFallbacks = fallbacks;
+        publishedFailures = failures;
+    }
+
+    for (size_t i = 0; i < CLASS_COUNT; i++) {
+        String prefix = "mem.pool." + String(stats[i].blockSize);
+        metrics.setGauge(prefix + ".inuse", stats[i].inUse);
+        metrics.setGauge(prefix + ".highwater", stats[i].highWater);
+    }
+    if (fallbackDelta) {
+        metrics.incrementCounter("mem.pool.fallbacks", fallbackDelta);
+    }
+    if (failureDelta) {
+        metrics.incrementCounter("mem.pool.failures", failureDelta);
+    }
+}
+
+PooledBuffer::PooledBuffer(size_t capacity)
+    : data_(static_cast<char*>(MemoryPool::getInstance().allocate(capacity))),
+      capacity_(data_ ? capacity : 0),
+      length_(0) {
+}
+
+PooledBuffer::~PooledBuffer() {
+    MemoryPool::getInstance().deallocate(data_);
+}
+
+PooledBuffer::PooledBuffer(PooledBuffer&& other) noexcept
+    : data_(other.data_), capacity_(other.capacity_), length_(other.length_) {
+    other.data_ = nullptr;
+    other.capacity_ = 0;
+    other.length_ = 0;
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) noexcept {
+    if (this != &other) {
+        MemoryPool::getInstance().deallocate(data_);
+        data_ = other.data_;
+        capacity_ = other.capacity_;
+        length_ = other.length_;
+        other.data_ = nullptr;
+        other.capacity_ = 0;
+        other.length_ = 0;
+    }
+    return *this;
+}
+
+bool PooledBuffer::append(const void* bytes, size_t len) {
+    if (!data_ || length_ + len > capacity_) {
+        return false;
+    }
+    memcpy(data_ + length_, bytes, len);
+    length_ += len;
+    return true;
+}
+
+bool PooledBuffer::reserve(size_t capacity) {
+    if (capacity <= capacity_) {
+        return true;
+    }
+    PooledBuffer grown(capacity);
+    if (!grown.valid()) {
+        return false;
+    }
+    if (length_ > 0) {
+        memcpy(grown.data_, data_, length_);
+    }
+    grown.length_ = length_;
+    *this = std::move(grown);
+    return true;
+}
+
+void PooledBuffer::consume(size_t len) {
+    if (len >= length_) {
+        length_ = 0;
+        return;
+    }
+    memmove(data_, data_ + len, length_ - len);
+    length_ -= len;
+}
@@ -0,0 +1,201 @@
+#include "MetricsExporter.h"
+
+using namespace mcp;
+
+MetricsExporter::MetricsExporter(Format format, bool allTime, uint32_t changedSince)
+    : format(format),
+      allTime(allTime),
+      changedSince(changedSince),
+      sequence(MetricsSystem::getInstance().getChangeSequence()),
+      stage(Stage::HEADER),
+      firstMetric(true),
+      pendingOffset(0) {
+}
+
+size_t MetricsExporter::fill(uint8_t* buffer, size_t maxLen) {
+    size_t written = 0;
+
+    while (written < maxLen) {
+        if (pendingOffset >= pending.length()) {
+            if (stage == Stage::DONE) {
+                break;
+            }
+            pending = "";
+            pendingOffset = 0;
+            renderNext();
+            continue;
+        }
+
+        size_t chunk = std::min(maxLen - written, pending.length() - pendingOffset);
+        memcpy(buffer + written, pending.c_str() + pendingOffset, chunk);
+        pendingOffset += chunk;
+        written += chunk;
+    }
+
+    return written;
+}
+
+void MetricsExporter::renderNext() {
+    switch (stage) {
+        case Stage::HEADER:
+            if (format == Format::STATS_JSON) {
+                renderStatsHeader();
+            } else if (format == Format::METRICS_DELTA) {
+                renderDeltaHeader();
+            }
+            stage = Stage::METRICS;
+            break;
+
+        case Stage::METRICS: {
+            MetricsSystem::MetricInfo info;
+            MetricValue value;
+            uint32_t since = format == Format::METRICS_DELTA ? changedSince : 0;
+            if (!MetricsSystem::getInstance().nextMetric(cursor, info, value, since)) {
+                stage = Stage::FOOTER;
+                break;
+            }
+            cursor = info.name;
+            if (format == Format::OPENMETRICS) {
+                renderOpenMetrics(info, value);
+            } else {
+                renderStatsMetric(info, value);
+            }
+            firstMetric = false;
+            break;
+        }
+
+        case Stage::FOOTER:
+            pending = format == Format::OPENMETRICS ? "# EOF\n" : "}}";
+            stage = Stage::DONE;
+            break;
+
+        case Stage::DONE:
+            break;
+    }
+}
+
+void MetricsExporter::renderStatsHeader() {
+    MetricsSystem& metrics = MetricsSystem::getInstance();
+    // Runs on the web server task: all-time figures come from the summary
+    // the MCP task keeps, never from a scan of the log
+    auto get = [&](const char* name) {
+        return allTime ? metrics.getHistorySummary(name) : metrics.getMetric(name);
+    };
+
+    MetricValue total = get("mcp.requests.total");
+    MetricValue errors = get("mcp.requests.errors");
+    MetricValue timeouts = get("mcp.requests.timeouts");
+    MetricValue duration = get("mcp.request.duration");
+    double avgDuration = duration.histogram.count > 0 ?
+                         duration.histogram.sum / duration.histogram.count : 0.0;
+
+    pending.reserve(320);
+    pending = "{\"requests\":{\"total\":";
+    pending += formatNumber(total.counter);
+    pending += ",\"errors\":";
+    pending += formatNumber(errors.counter);
+    pending += ",\"timeouts\":";
+    pending += formatNumber(timeouts.counter);
+    pending += ",\"avg_duration\":";
+    pending += formatNumber(avgDuration);
+    pending += ",\"max_duration\":";
+    pending += formatNumber(duration.histogram.max);
+    pending += ",\"p99_duration\":";
+    pending += formatNumber(MetricsSystem::histogramQuantile(duration, 0.99));
+    pending += "},\"system\":{\"wifi_signal\":";
+    pending += formatNumber(metrics.getMetric("system.wifi.signal").gauge);
+    pending += ",\"free_heap\":";
+    pending += formatNumber(metrics.getMetric("system.heap.free").gauge);
+    pending += ",\"min_heap\":";
+    pending += formatNumber(metrics.getMetric("system.heap.min").gauge);
+    pending += ",\"uptime\":";
+    pending += formatNumber(millis());
+    pending += "},\"metrics\":{";
+}
+
+void MetricsExporter::renderDeltaHeader() {
+    pending = "{\"seq\":";
+    pending += String(sequence);
+    pending += ",\"since\":";
+    pending += String(changedSince);
+    pending += ",\"metrics\":{";
+}
+
+void MetricsExporter::renderOpenMetrics(const MetricsSystem::MetricInfo& info, const MetricValue& value) {
+    String name = sanitizeName(info.name);
+    String help = info.description;
+    help.replace("\\", "\\\\");
+    help.replace("\n", "\\n");
+
+    switch (info.type) {
+        case MetricsSystem::MetricType::COUNTER:
+            // The family is named without the _total its sample carries
+            if (name.endsWith("_total")) {
+                name.remove(name.length() - 6);
+            }
+            pending = "# TYPE " + name + " counter\n# HELP " + name + " " + help + "\n";
+            pending += name + "_total " + formatNumber(value.counter) + "\n";
+            break;
+
+        case MetricsSystem::MetricType::GAUGE:
+            pending = "# TYPE " + name + " gauge\n# HELP " + name + " " + help + "\n";
+            pending += name + " " + formatNumber(value.gauge) + "\n";
+            break;
+
+        case MetricsSystem::MetricType::HISTOGRAM: {
+            const auto& hist = value.histogram;
+            pending.reserve(96 + HISTOGRAM_BUCKETS * (name.length() + 32));
+            pending = "# TYPE " + name + " histogram\n# HELP " + name + " " + help + "\n";
+            uint32_t cumulative = 0;
+            for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+                cumulative += hist.buckets[i];
+                pending += name + "_bucket{le=\"";
+                pending += i < HISTOGRAM_BUCKETS - 1 ? formatNumber(HISTOGRAM_BOUNDS[i]) : String("+Inf");
+                pending += "\"} " + String(cumulative) + "\n";
+            }
+            pending += name + "_count " + String(hist.count) + "\n";
+            pending += name + "_sum " + formatNumber(hist.sum) + "\n";
+            break;
+        }
+    }
+}
+
+void MetricsExporter::renderStatsMetric(const MetricsSystem::MetricInfo& info, const MetricValue& value) {
+    pending = firstMetric ? "\"" : ",\"";
+    pending += info.name + "\":";
+
+    switch (info.type) {
+        case MetricsSystem::MetricType::COUNTER:
+            pending += formatNumber(value.counter);
+            break;
+        case MetricsSystem::MetricType::GAUGE:
+            pending += formatNumber(value.gauge);
+            break;
+        case MetricsSystem::MetricType::HISTOGRAM:
+            pending += "{\"count\":" + String(value.histogram.count);
+            pending += ",\"sum\":" + formatNumber(value.histogram.sum);
+            pending += ",\"min\":" + formatNumber(value.histogram.min);
+            pending += ",\"max\":" + formatNumber(value.histogram.max);
+            pending += ",\"p50\":" + formatNumber(MetricsSystem::histogramQuantile(value, 0.5));
+            pending += ",\"p99\":" + formatNumber(MetricsSystem::histogramQuantile(value, 0.99));
+            pending += "}";
+            break;
+    }
+}
+
+String MetricsExporter::sanitizeName(const String& name) {
+    String out = name;
+    for (size_t i = 0; i < out.length(); i++) {
+        char c = out[i];
+        if (!isalnum(c) && c != '_' && c != ':') {
+            out.setCharAt(i, '_');
+        }
+    }
+    return out;
+}
+
+String MetricsExporter::formatNumber(double value) {
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%.10g", value);
+    return String(buffer);
+}
@@ -0,0 +1,81 @@
+#include "MetricsStream.h"
+#include "MetricsExporter.h"
+#include "MetricsSystem.h"
+
+using namespace mcp;
+
+MetricsStream::MetricsStream()
+    : events(ENDPOINT),
+      interval(DEFAULT_INTERVAL),
+      lastPush(0),
+      sentSequence(0),
+      started(false) {
+}
+
+void MetricsStream::begin(AsyncWebServer& server) {
+    if (started) {
+        return;
+    }
+
+    events.onConnect([](AsyncEventSourceClient* client) {
+        uint32_t sequence = 0;
+        String snapshot = render(0, sequence);
+        client->send(snapshot.c_str(), "snapshot", sequence, RECONNECT_DELAY);
+    });
+    server.addHandler(&events);
+
+    MetricsSystem& metrics = MetricsSystem::getInstance();
+    metrics.registerCounter("sse.metrics.deltas", "Metric delta events pushed", "events", "network");
+    metrics.registerCounter("sse.metrics.coalesced", "Delta ticks deferred for slow clients", "events", "network");
+
+    // Deltas start from the current state; new clients get a snapshot first
+    sentSequence = metrics.getChangeSequence();
+    started = true;
+}
+
+void MetricsStream::setInterval(uint32_t intervalMs) {
+    interval = std::max(intervalMs, MIN_INTERVAL);
+}
+
+void MetricsStream::poll() {
+    if (!started || millis() - lastPush < interval) {
+        return;
+    }
+    lastPush = millis();
+
+    MetricsSystem& metrics = MetricsSystem::getInstance();
+    if (events.count() == 0) {
+        sentSequence = metrics.getChangeSequence();
+        return;
+    }
+    if (metrics.getChangeSequence() == sentSequence) {
+        return;
+    }
+
+    // A slow client is still draining earlier events; let changes pile up
+    // into one larger delta instead of queueing another small one
+    if (events.avgPacketsWaiting() > MAX_PACKETS_WAITING) {
+        metrics.incrementCounter("sse.metrics.coalesced");
+        return;
+    }
+
+    // Counted before rendering so the counter's own change rides in this delta
+    metrics.incrementCounter("sse.metrics.deltas");
+    uint32_t sequence = 0;
+    String delta = render(sentSequence, sequence);
+    events.send(delta.c_str(), "delta", sequence);
+    sentSequence = sequence;
+}
+
+String MetricsStream::render(uint32_t changedSince, uint32_t& sequence) {
+    MetricsExporter exporter(MetricsExporter::Format::METRICS_DELTA, false, changedSince);
+    sequence = exporter.getSequence();
+
+    String out;
+    uint8_t chunk[256];
+    size_t len;
+    while ((len = exporter.fill(chunk, sizeof(chunk))) > 0) {
+        out.concat(reinterpret_cast<const char*>(chunk), len);
+    }
+    return out;
+}
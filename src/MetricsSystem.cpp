@@ -1,4 +1,8 @@
 #include "MetricsSystem.h"
+#include "AdmissionControl.h"
+#include "MemoryPool.h"
+#include "RequestTracer.h"
+#include "TaskTopology.h"
 #include <WiFi.h>
 #include <mutex>
 #include <ArduinoJson.h>
@@ -9,15 +13,25 @@ using namespace mcp;
 // Constants
 static const char* BOOT_METRICS_FILE = "/boot_metrics.bin";
 static const char* CONFIG_FILE = "/metrics_config.json";
-static const uint32_t SAVE_INTERVAL = 60000; // 1 minute
-static const size_t MAX_METRICS = 50;
+
+// Everything the firmware registers, by owner; a new metric needs room here
+static constexpr size_t SYSTEM_METRICS = 4;   // initializeSystemMetrics()
+static constexpr size_t MCP_METRICS = 17 + AdmissionControl::MAX_SLOTS;  // MCPServer::begin(), RTT per client slot
+static constexpr size_t NETWORK_METRICS = 5;  // NetworkManager, MetricsStream
+static constexpr size_t POOL_METRICS = 2 * MemoryPool::CLASS_COUNT + 2;
+static constexpr size_t TASK_METRICS = 2 * TaskTopology::COUNT + portNUM_PROCESSORS;
+static constexpr size_t TRACE_METRICS = 3 + RequestTracer::TRACED_TYPES * RequestTracer::STAGE_COUNT;
+static constexpr size_t MAX_METRICS =
+    SYSTEM_METRICS + MCP_METRICS + NETWORK_METRICS + POOL_METRICS + TASK_METRICS + TRACE_METRICS;
+static_assert(MAX_METRICS <= 128, "Metric budget above 128; trim per-instance metrics");
 
 // Static members initialization
-std::mutex MetricsSystem::metricsMutex;
+std::recursive_mutex MetricsSystem::metricsMutex;
 
 MetricsSystem::MetricsSystem() 
-    : lastSaveTime(0)
-    , initialized(false) {
+    : initialized(false)
+    , definitionsDirty(false)
+    , changeSequence(0) {
 }
 
 MetricsSystem::~MetricsSystem() {
@@ -25,7 +39,7 @@ MetricsSystem::~MetricsSystem() {
 }
 
 bool MetricsSystem::begin() {
-    std::lock_guard<std::mutex> lock(metricsMutex);
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
     
     if (initialized) {
         return true;
@@ -51,14 +65,13 @@ bool MetricsSystem::begin() {
     initializeSystemMetrics();
 
     initialized = true;
-    lastSaveTime = millis();
     return true;
 }
 
 void MetricsSystem::end() {
-    std::lock_guard<std::mutex> lock(metricsMutex);
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
     if (initialized) {
-        saveBootMetrics();
+        persist();
         logger.end();
         initialized = false;
     }
@@ -66,14 +79,20 @@ void MetricsSystem::end() {
 
 void MetricsSystem::registerMetric(const String& name, MetricType type, const String& description,
                                    const String& unit, const String& category) {
-    std::lock_guard<std::mutex> lock(metricsMutex);
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
 
-    if (metrics.size() >= MAX_METRICS) {
-        log_w("Max metrics limit reached, ignoring: %s", name.c_str());
+    if (metrics.size() >= MAX_METRICS && metrics.find(name) == metrics.end()) {
+        log_e("Metric budget of %u exhausted, not registered: %s", static_cast<unsigned>(MAX_METRICS), name.c_str());
         return;
     }
 
     MetricInfo info = {name, type, description, unit, category};
+    auto existing = metrics.find(name);
+    if (existing == metrics.end() || existing->second.type != type ||
+        existing->second.description != description || existing->second.unit != unit ||
+        existing->second.category != category) {
+        definitionsDirty = true;
+    }
     metrics[name] = info;
 
     MetricValue value = {millis(), {}};
@@ -105,18 +124,160 @@ void MetricsSystem::registerHistogram(const String& name, const String& descript
                                       const String& unit, const String& category) {
     registerMetric(name, MetricType::HISTOGRAM, description, unit, category);
 }
-MetricValue MetricsSystem::getMetric(const String& name, bool fromBoot) {
-    std::lock_guard<std::mutex> lock(metricsMutex);
+
+void MetricsSystem::initializeSystemMetrics() {
+    registerGauge("system.wifi.signal", "WiFi signal strength", "dBm", "system");
+    registerGauge("system.heap.free", "Free heap memory", "bytes", "system");
+    registerGauge("system.heap.min", "Minimum free heap since boot", "bytes", "system");
+    registerGauge("system.uptime", "Time since boot", "ms", "system");
+}
+
+bool MetricsSystem::hasMetric(const String& name) {
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
+    return metrics.find(name) != metrics.end();
+}
+
+void MetricsSystem::incrementCounter(const String& name, int64_t value) {
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
 
     auto it = metrics.find(name);
-    if (it == metrics.end()) {
+    if (it == metrics.end() || it->second.type != MetricType::COUNTER) {
+        return;
+    }
+
+    MetricValue& metric = bootMetrics[name];
+    metric.counter += value;
+    metric.timestamp = millis();
+    if (value != 0) {
+        changedAt[name] = ++changeSequence;
+    }
+}
+
+void MetricsSystem::setGauge(const String& name, double value) {
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
+
+    auto it = metrics.find(name);
+    if (it == metrics.end() || it->second.type != MetricType::GAUGE) {
+        return;
+    }
+
+    MetricValue& metric = bootMetrics[name];
+    if (metric.gauge != value) {
+        changedAt[name] = ++changeSequence;
+    }
+    metric.gauge = value;
+    metric.timestamp = millis();
+}
+
+void MetricsSystem::recordHistogram(const String& name, double value) {
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
+
+    auto it = metrics.find(name);
+    if (it == metrics.end() || it->second.type != MetricType::HISTOGRAM) {
+        return;
+    }
+
+    MetricValue& metric = bootMetrics[name];
+    auto& hist = metric.histogram;
+    if (hist.count == 0) {
+        hist.min = value;
+        hist.max = value;
+    } else {
+        hist.min = std::min(hist.min, value);
+        hist.max = std::max(hist.max, value);
+    }
+    hist.value = value;
+    hist.sum += value;
+    hist.count++;
+
+    size_t bucket = 0;
+    while (bucket < HISTOGRAM_BUCKETS - 1 && value > HISTOGRAM_BOUNDS[bucket]) {
+        bucket++;
+    }
+    hist.buckets[bucket]++;
+    metric.timestamp = millis();
+    changedAt[name] = ++changeSequence;
+}
+
+double MetricsSystem::histogramQuantile(const MetricValue& value, double quantile) {
+    const auto& hist = value.histogram;
+    if (hist.count == 0) {
+        return 0.0;
+    }
+
+    // Walk the buckets until the target rank is reached, then interpolate
+    // linearly inside that bucket, clamped to the observed min/max.
+    double rank = quantile * hist.count;
+    uint32_t seen = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (hist.buckets[i] == 0 || seen + hist.buckets[i] < rank) {
+            seen += hist.buckets[i];
+            continue;
+        }
+        double lower = i == 0 ? hist.min : HISTOGRAM_BOUNDS[i - 1];
+        double upper = i == HISTOGRAM_BUCKETS - 1 ? hist.max : HISTOGRAM_BOUNDS[i];
+        double fraction = (rank - seen) / hist.buckets[i];
+        double estimate = lower + (upper - lower) * fraction;
+        return std::max(hist.min, std::min(hist.max, estimate));
+    }
+    return hist.max;
+}
+
+MetricValue MetricsSystem::getMetric(const String& name, bool fromBoot) {
+    MetricType type;
+    {
+        std::lock_guard<std::recursive_mutex> lock(metricsMutex);
+        auto it = metrics.find(name);
+        if (it == metrics.end()) {
+            return MetricValue{};
+        }
+        if (fromBoot) {
+            return bootMetrics[name];
+        }
+        type = it->second.type;
+    }
+    return summarize(name, type);
+}
+
+MetricValue MetricsSystem::getHistorySummary(const String& name) {
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
+    if (metrics.find(name) == metrics.end()) {
         return MetricValue{};
     }
+    auto it = historySummaries.find(name);
+    if (it == historySummaries.end()) {
+        historySummaries[name] = MetricValue{};
+        pendingSummaries.push_back(name);
+        return MetricValue{};
+    }
+    return it->second;
+}
+
+void MetricsSystem::summarizeHistory(bool all) {
+    std::vector<std::pair<String, MetricType>> names;
+    {
+        std::lock_guard<std::recursive_mutex> lock(metricsMutex);
+        if (all) {
+            for (const auto& pair : historySummaries) {
+                names.emplace_back(pair.first, metrics[pair.first].type);
+            }
+        } else {
+            for (const String& name : pendingSummaries) {
+                names.emplace_back(name, metrics[name].type);
+            }
+        }
+        pendingSummaries.clear();
+    }
 
-    if (fromBoot) {
-        return bootMetrics[name];
+    // Scan without the metrics lock so updates from other tasks never wait on flash
+    for (const auto& entry : names) {
+        MetricValue value = summarize(entry.first, entry.second);
+        std::lock_guard<std::recursive_mutex> lock(metricsMutex);
+        historySummaries[entry.first] = value;
     }
+}
 
+MetricValue MetricsSystem::summarize(const String& name, MetricType type) {
     std::vector<uLogger::Record> records;
     logger.queryMetrics(name.c_str(), 0, records); // Fetch records
 
@@ -125,7 +286,7 @@ MetricValue MetricsSystem::getMetric(const String& name, bool fromBoot) {
     }
 
     MetricValue result = {millis(), {}};
-    switch (it->second.type) {
+    switch (type) {
         case MetricType::COUNTER:
             result.counter = 0;
             for (const auto& record : records) {
@@ -151,6 +312,72 @@ MetricValue MetricsSystem::getMetric(const String& name, bool fromBoot) {
     return result;
 }
 
+std::vector<MetricValue> MetricsSystem::getMetricHistory(const String& name, uint32_t seconds) {
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
+
+    std::vector<MetricValue> history;
+    if (metrics.find(name) == metrics.end()) {
+        return history;
+    }
+
+    uint64_t now = millis();
+    uint64_t startTime = (seconds == 0 || now < seconds * 1000ULL) ? 0 : now - seconds * 1000ULL;
+
+    std::vector<uLogger::Record> records;
+    logger.queryMetrics(name.c_str(), startTime, records);
+
+    for (const auto& record : records) {
+        MetricValue value = {record.timestamp, {}};
+        memcpy(&value.histogram, record.data,
+               std::min<size_t>(record.dataSize, sizeof(value.histogram)));
+        history.push_back(value);
+    }
+    return history;
+}
+
+std::map<String, MetricsSystem::MetricInfo> MetricsSystem::getMetrics(const String& category) {
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
+
+    if (category.isEmpty()) {
+        return metrics;
+    }
+
+    std::map<String, MetricInfo> filtered;
+    for (const auto& pair : metrics) {
+        if (pair.second.category == category) {
+            filtered[pair.first] = pair.second;
+        }
+    }
+    return filtered;
+}
+
+bool MetricsSystem::nextMetric(const String& after, MetricInfo& info, MetricValue& value,
+                               uint32_t changedSince) {
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
+
+    auto it = after.isEmpty() ? metrics.begin() : metrics.upper_bound(after);
+    if (changedSince > 0) {
+        while (it != metrics.end()) {
+            auto changed = changedAt.find(it->first);
+            if (changed != changedAt.end() && changed->second > changedSince) {
+                break;
+            }
+            ++it;
+        }
+    }
+    if (it == metrics.end()) {
+        return false;
+    }
+
+    info = it->second;
+    value = bootMetrics[it->first];
+    return true;
+}
+
+uint32_t MetricsSystem::getChangeSequence() {
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
+    return changeSequence;
+}
 
 MetricValue MetricsSystem::calculateHistogram(const std::vector<MetricValue>& values) {
     MetricValue result = {millis(), {.histogram = {0.0, 0.0, 0.0, 0.0, 0}}};
@@ -176,7 +403,7 @@ MetricValue MetricsSystem::calculateHistogram(const std::vector<MetricValue>& va
 }
 
 void MetricsSystem::updateSystemMetrics() {
-    std::lock_guard<std::mutex> lock(metricsMutex);
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
     
     // Update WiFi signal strength if connected
     if (WiFi.status() == WL_CONNECTED) {
@@ -187,16 +414,55 @@ void MetricsSystem::updateSystemMetrics() {
     setGauge("system.heap.free", ESP.getFreeHeap());
     setGauge("system.heap.min", ESP.getMinFreeHeap());
     setGauge("system.uptime", millis());
+}
+
+void MetricsSystem::persist() {
+    {
+        std::lock_guard<std::recursive_mutex> lock(metricsMutex);
+        if (!initialized) {
+            return;
+        }
+
+        snapshotHistory();
+        // The definitions only change when a metric is first registered, so
+        // most calls leave the file alone
+        if (definitionsDirty && saveBootMetrics()) {
+            definitionsDirty = false;
+        }
+    }
+    // The history just grew
+    summarizeHistory(true);
+}
 
-    // Check if it's time to save boot metrics
-    uint32_t now = millis();
-    if (now - lastSaveTime >= SAVE_INTERVAL) {
-        saveBootMetrics();
-        lastSaveTime = now;
+void MetricsSystem::snapshotHistory() {
+    // History is written once per persist() rather than on every update,
+    // so hot paths (request tracing) never touch the filesystem. Counters are
+    // logged as deltas so getMetric(name, false) can sum them.
+    for (const auto& pair : bootMetrics) {
+        const MetricInfo& info = metrics[pair.first];
+        switch (info.type) {
+            case MetricType::COUNTER: {
+                int64_t delta = pair.second.counter - loggedCounters[pair.first];
+                if (delta != 0) {
+                    logger.logMetric(pair.first.c_str(), &delta, sizeof(delta));
+                    loggedCounters[pair.first] = pair.second.counter;
+                }
+                break;
+            }
+            case MetricType::GAUGE:
+                logger.logMetric(pair.first.c_str(), &pair.second.gauge, sizeof(pair.second.gauge));
+                break;
+            case MetricType::HISTOGRAM:
+                if (pair.second.histogram.count > 0) {
+                    logger.logMetric(pair.first.c_str(), &pair.second.histogram,
+                                     sizeof(pair.second.histogram));
+                }
+                break;
+        }
     }
 }
 bool MetricsSystem::saveBootMetrics() {
-    std::lock_guard<std::mutex> lock(metricsMutex);
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
 
     File file = LittleFS.open(BOOT_METRICS_FILE, "w");
     if (!file) {
@@ -227,7 +493,7 @@ bool MetricsSystem::saveBootMetrics() {
 }
 
 bool MetricsSystem::loadBootMetrics() {
-    std::lock_guard<std::mutex> lock(metricsMutex);
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
     
     File file = LittleFS.open(BOOT_METRICS_FILE, "r");
     if (!file) {
@@ -265,7 +531,7 @@ bool MetricsSystem::loadBootMetrics() {
 }
 
 void MetricsSystem::resetBootMetrics() {
-    std::lock_guard<std::mutex> lock(metricsMutex);
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
     
     bootMetrics.clear();
     for (const auto& pair : metrics) {
@@ -282,9 +548,9 @@ void MetricsSystem::resetBootMetrics() {
                 break;
         }
         bootMetrics[pair.first] = value;
+        changedAt[pair.first] = ++changeSequence;
     }
-    
-    saveBootMetrics();
+    definitionsDirty = true;
 }
 
 bool MetricsSystem::isInitialized() const {
@@ -292,7 +558,16 @@ bool MetricsSystem::isInitialized() const {
 }
 
 void MetricsSystem::clearHistory() {
-    std::lock_guard<std::mutex> lock(metricsMutex);
+    std::lock_guard<std::recursive_mutex> lock(metricsMutex);
     logger.clear();
     resetBootMetrics();
+}
+
+// The logger serializes file access itself; metricsMutex is not held during reads
+size_t MetricsSystem::getHistorySize() {
+    return logger.getFileSize();
+}
+
+size_t MetricsSystem::readHistory(size_t offset, uint8_t* buffer, size_t len) {
+    return logger.readRaw(offset, buffer, len);
 }
\ No newline at end of file
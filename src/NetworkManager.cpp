@@ -5,89 +5,121 @@
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
 #include "NetworkManager.h"
+#include "MetricsExporter.h"
+#include "MetricsSystem.h"
+#include "Log.h"
+#include "TaskTopology.h"
+#include <memory>
 #include <esp_random.h>
+#include <algorithm>
 
 const char* NetworkManager::SETUP_PAGE_PATH = "/wifi_setup.html";
 
 NetworkManager::NetworkManager() 
-    : state(NetworkState::INIT),
+    : eventQueue(nullptr),
+      webServerStarted(false),
+      credentialUsed(),
+      currentCredential(0),
+      connectOrderCount(0),
+      connectOrderPos(0),
+      everConnected(false),
       server(80),
       ws("/ws"),
-      connectAttempts(0),
+      fastConnect(),
+      fastConnectPending(false),
+      leaseCheckStart(0),
       lastConnectAttempt(0) {
 }
 
 void NetworkManager::begin() {
-    Serial.println("\n=== Starting Network Manager ===");
+    MCP_LOGD("=== Starting Network Manager ===");
     
     // Initialize LittleFS if not already initialized
     if (!LittleFS.begin(false)) {
-        Serial.println("LittleFS Mount Failed - Formatting...");
+        MCP_LOGW("LittleFS Mount Failed - Formatting...");
         if (!LittleFS.begin(true)) {
-            Serial.println("LittleFS Mount Failed Even After Format!");
+            MCP_LOGE("LittleFS Mount Failed Even After Format!");
             return;
         }
     }
-    Serial.println("LittleFS mounted successfully");
+    MCP_LOGI("LittleFS mounted successfully");
 
+    // WiFi events arrive on the system event task; they are only queued here
+    // and handled by the network task
+    eventQueue = xQueueCreate(EVENT_QUEUE_SIZE, sizeof(PendingEvent));
     WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info) {
-        if (static_cast<system_event_id_t>(event) == SYSTEM_EVENT_STA_DISCONNECTED) {
-            Serial.println("WiFi disconnected event received");
-            if (state == NetworkState::CONNECTED) {
-                state = NetworkState::CONNECTION_FAILED;
-                queueRequest(NetworkRequest::Type::CHECK_CONNECTION);
-            }
-        }
-    });
+        postEvent(NetworkEvent::GOT_IP);
+    }, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info) {
+        postEvent(NetworkEvent::DISCONNECTED, info.wifi_sta_disconnected.reason);
+    }, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+
+    mcp::MetricsSystem& metrics = mcp::MetricsSystem::getInstance();
+    metrics.registerHistogram("wifi.connect.duration", "Time from WiFi.begin to connected", "ms", "network");
+    metrics.registerCounter("wifi.connect.fast", "Connections made with the cached BSSID/channel/lease", "", "network");
+    metrics.registerCounter("wifi.connect.full", "Connections that needed a full scan and DHCP", "", "network");
+
+    // Connection state is managed here; keep the SDK from rewriting flash on
+    // every begin() or reconnecting behind the state machine's back
+    WiFi.persistent(false);
+    WiFi.setAutoReconnect(false);
 
     // Create network task
-    xTaskCreatePinnedToCore(
-        networkTaskCode,
-        "NetworkTask",
-        8192,
-        this,
-        1,
-        &networkTaskHandle,
-        0
-    );
-    Serial.println("Network task created");
+    if (!mcp::TaskTopology::start(mcp::TaskTopology::NETWORK, networkTaskCode, this, &networkTaskHandle)) {
+        MCP_LOGE("Failed to create network task!");
+        return;
+    }
+    MCP_LOGD("Network task created");
     
     // Check credentials and start appropriate mode
     if (loadCredentials()) {
-        Serial.println("Credentials found - Attempting to connect to WiFi");
-        state = NetworkState::CONNECTING;
-        queueRequest(NetworkRequest::Type::CONNECT);
+        MCP_LOGI("Credentials found - Attempting to connect to WiFi");
+        postEvent(NetworkEvent::START_STA);
     } else {
-        Serial.println("No credentials found - Starting AP mode");
-        state = NetworkState::AP_MODE;
-        queueRequest(NetworkRequest::Type::START_AP);
+        MCP_LOGI("No credentials found - Starting AP mode");
+        postEvent(NetworkEvent::START_AP);
     }
     
-    Serial.println("=== Network Manager Started ===\n");
+    MCP_LOGD("=== Network Manager Started ===");
 }
 
 void NetworkManager::setupWebServer() {
-    Serial.println("Setting up web server...");
-    
-    ws.onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client,
-                     AwsEventType type, void* arg, uint8_t* data, size_t len) {
-        this->onWebSocketEvent(server, client, type, arg, data, len);
-    });
+    // Runs on every connect and AP start; handlers must only be added once
+    if (webServerStarted) {
+        return;
+    }
+    MCP_LOGD("Setting up web server...");
     
+    // MCP traffic on /ws is handled by MCPServer's WebSocketTransport
     server.addHandler(&ws);
 
-    // Serve static files
-    server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
+    // Metrics export, streamed so the payload is never built in RAM
+    server.on("/metrics", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        this->handleMetrics(request);
+    });
+
+    server.on("/api/stats", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        this->handleStats(request);
+    });
+
+    // Live metric deltas for the dashboard
+    metricsStream.begin(server);
+
+    // Serve static files: pre-compressed, ETag-validated, hot pages pinned in RAM
+    assets.begin(LittleFS);
+    assets.cache("/index.html");
+    assets.cache(SETUP_PAGE_PATH);
+    server.addHandler(&assets);
     
     // Handle root path
     server.on("/", HTTP_GET, [this](AsyncWebServerRequest *request) {
-        Serial.println("Received request for root page");
+        MCP_LOGD("Received request for root page");
         this->handleRoot(request);
     });
     
     // Handle save credentials
     server.on("/save", HTTP_POST, [this](AsyncWebServerRequest *request) {
-        Serial.println("Received save credentials request");
+        MCP_LOGD("Received save credentials request");
         this->handleSave(request);
     });
     
@@ -97,43 +129,27 @@ void NetworkManager::setupWebServer() {
     });
 
     server.begin();
-    Serial.println("Web server started");
+    webServerStarted = true;
+    MCP_LOGI("Web server started");
 }
 
 void NetworkManager::handleRoot(AsyncWebServerRequest *request) {
-    Serial.println("\n=== Handling Root Request ===");
-    Serial.print("Current state: ");
-    switch (state) {
-        case NetworkState::INIT:
-            Serial.println("INIT");
-            break;
-        case NetworkState::CONNECTING:
-            Serial.println("CONNECTING");
-            break;
-        case NetworkState::CONNECTED:
-            Serial.println("CONNECTED");
-            break;
-        case NetworkState::AP_MODE:
-            Serial.println("AP_MODE");
-            break;
-        case NetworkState::CONNECTION_FAILED:
-            Serial.println("CONNECTION_FAILED");
-            break;
-    }
+    MCP_LOGD("=== Handling Root Request ===");
+    MCP_LOGD("Current state: %s", mcp::NetworkStateMachine::stateName(getState()));
 
-    if (state == NetworkState::AP_MODE) {
-        Serial.println("Serving WiFi setup page");
-        if (LittleFS.exists(SETUP_PAGE_PATH)) {
-            request->send(LittleFS, SETUP_PAGE_PATH, "text/html");
-        } else {
-            Serial.println("ERROR: Setup page not found in filesystem!");
+    if (getState() == NetworkState::AP_MODE) {
+        MCP_LOGD("Serving WiFi setup page");
+        if (!assets.send(request, SETUP_PAGE_PATH)) {
+            MCP_LOGE("Setup page not found in filesystem!");
             request->send(500, "text/plain", "Setup page not found in filesystem");
         }
     } else {
-        Serial.println("Serving main page");
-        request->send(LittleFS, "/index.html", "text/html");
+        MCP_LOGD("Serving main page");
+        if (!assets.send(request, "/index.html")) {
+            request->send(404, "text/plain", "Main page not found in filesystem");
+        }
     }
-    Serial.println("=== End Root Request ===\n");
+    MCP_LOGD("=== End Root Request ===");
 }
 
 void NetworkManager::handleSave(AsyncWebServerRequest *request) {
@@ -149,149 +165,40 @@ void NetworkManager::handleSave(AsyncWebServerRequest *request) {
         request->send(400, "text/plain", "SSID cannot be empty");
         return;
     }
+    if (ssid.length() > MAX_SSID_LENGTH || password.length() > MAX_PASSWORD_LENGTH) {
+        request->send(400, "text/plain", "SSID or password too long");
+        return;
+    }
     
-    saveCredentials(ssid, password);
+    // Stored and ranked on the network task, which owns the credential state
+    if (!postCredentials(ssid, password)) {
+        request->send(503, "text/plain", "Busy, try again");
+        return;
+    }
     request->send(200, "text/plain", "Credentials saved");
 }
 
 void NetworkManager::handleStatus(AsyncWebServerRequest *request) {
     AsyncResponseStream *response = request->beginResponseStream("application/json");
-    response->print(getNetworkStatusJson(state, getSSID(), getIPAddress()));
+    response->print(getNetworkStatusJson(getState(), getSSID(), getIPAddress()));
     request->send(response);
 }
 
-void NetworkManager::onWebSocketEvent(AsyncWebSocket* server, 
-                                    AsyncWebSocketClient* client,
-                                    AwsEventType type, 
-                                    void* arg, 
-                                    uint8_t* data, 
-                                    size_t len) {
-    Serial.print("onWebSocketEvent type =");    
-    Serial.println(type);                                    
-    switch (type) {
-        case WS_EVT_CONNECT:
-            Serial.println("WebSocket client connected");
-            //client->text(getNetworkStatusJson(state, getSSID(), getIPAddress()));
-            break;
-        case WS_EVT_DISCONNECT:
-            Serial.println("WebSocket client disconnected");
-            break;
-        case WS_EVT_ERROR:
-            Serial.println("WebSocket error");
-            break;
-        case WS_EVT_DATA:
-            Serial.println("WebSocket data received");
-            if (len > 0) {
-                // 将接收到的数据转换为字符串
-                String message = String((char*)data, len);
-                Serial.print("Received message: ");
-                Serial.println(message);
-                
-                // 解析JSON消息
-                DynamicJsonDocument doc(1024);
-                DeserializationError error = deserializeJson(doc, message);
-                
-                if (error) {
-                    Serial.print("JSON parsing failed: ");
-                    Serial.println(error.c_str());
-                    return;
-                }
-                
-                // 处理不同类型的消息
-                if (doc.containsKey("method")) {
-                    String method = doc["method"].as<String>();
-                    Serial.print("Method: ");
-                    Serial.println(method);
-                    
-                    // 处理初始化请求
-                    if (method == "initialize") {
-                        DynamicJsonDocument response(1024);
-                        response["jsonrpc"] = "2.0";
-                        response["id"] = doc["id"];
-                        response["result"]["serverName"] = "ESP32-MCP-Server";
-                        response["result"]["serverVersion"] = "1.0.0";
-                        String responseStr;
-                        serializeJson(response, responseStr);
-                        client->text(responseStr);
-                    }
-                    // 处理资源列表请求
-                    else if (method == "resources/list") {
-                        DynamicJsonDocument response(1024);
-                        response["jsonrpc"] = "2.0";
-                        response["id"] = doc["id"];
-                        JsonArray resources = response["result"]["resources"].to<JsonArray>();
-                        
-                        // 添加示例资源
-                        JsonObject resource1 = resources.createNestedObject();
-                        resource1["name"] = "LED";
-                        resource1["uri"] = "led://status";
-                        resource1["type"] = "boolean";
-                        
-                        String responseStr;
-                        serializeJson(response, responseStr);
-                        client->text(responseStr);
-                    }
-                    // 处理tools/list请求
-                    else if (method == "tools/list") {
-                        DynamicJsonDocument response(1024);
-                        response["jsonrpc"] = "2.0";
-                        response["id"] = doc["id"];
-                        JsonObject result = response.createNestedObject("result");
-                        JsonArray tools = result.createNestedArray("tools");
-                        JsonObject tool = tools.createNestedObject();
-                        tool["name"] = "led_control";
-                        tool["description"] = "控制ESP32板载LED的开关";
-                        JsonObject inputSchema = tool.createNestedObject("inputSchema");
-                        inputSchema["type"] = "object";
-                        JsonObject props = inputSchema.createNestedObject("properties");
-                        JsonObject onProp = props.createNestedObject("on");
-                        onProp["type"] = "boolean";
-                        onProp["description"] = "true为打开LED，false为关闭LED";
-                        JsonArray required = inputSchema.createNestedArray("required");
-                        required.add("on");
-                        String responseStr;
-                        serializeJson(response, responseStr);
-                        client->text(responseStr);
-                    }
-                    // 处理tools/call请求
-                    else if (method == "tools/call") {
-                        String toolName = doc["params"]["name"].as<String>();
-                        if (toolName == "led_control") {
-                            if (!doc["params"]["arguments"].containsKey("on")) {
-                                DynamicJsonDocument errorResp(256);
-                                errorResp["jsonrpc"] = "2.0";
-                                errorResp["id"] = doc["id"];
-                                JsonObject result = errorResp.createNestedObject("result");
-                                JsonArray contentArr = result.createNestedArray("content");
-                                JsonObject contentObj = contentArr.createNestedObject();
-                                contentObj["type"] = "text";
-                                contentObj["text"] = "参数错误，缺少on字段";
-                                result["isError"] = true;
-                                String errorStr;
-                                serializeJson(errorResp, errorStr);
-                                client->text(errorStr);
-                                return;
-                            }
-                            bool on = doc["params"]["arguments"]["on"].as<bool>();
-                            digitalWrite(2, on ? HIGH : LOW); // GPIO2
-                            DynamicJsonDocument resp(256);
-                            resp["jsonrpc"] = "2.0";
-                            resp["id"] = doc["id"];
-                            JsonObject result = resp.createNestedObject("result");
-                            JsonArray contentArr = result.createNestedArray("content");
-                            JsonObject contentObj = contentArr.createNestedObject();
-                            contentObj["type"] = "text";
-                            contentObj["text"] = on ? "LED已打开" : "LED已关闭";
-                            result["isError"] = false;
-                            String respStr;
-                            serializeJson(resp, respStr);
-                            client->text(respStr);
-                        }
-                    }
-                }
-            }
-            break;
-    }
+void NetworkManager::handleMetrics(AsyncWebServerRequest *request) {
+    auto exporter = std::make_shared<mcp::MetricsExporter>(mcp::MetricsExporter::Format::OPENMETRICS);
+    request->send(request->beginChunkedResponse(mcp::MetricsExporter::OPENMETRICS_CONTENT_TYPE,
+        [exporter](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            return exporter->fill(buffer, maxLen);
+        }));
+}
+
+void NetworkManager::handleStats(AsyncWebServerRequest *request) {
+    bool allTime = request->hasParam("period") && request->getParam("period")->value() == "all";
+    auto exporter = std::make_shared<mcp::MetricsExporter>(mcp::MetricsExporter::Format::STATS_JSON, allTime);
+    request->send(request->beginChunkedResponse("application/json",
+        [exporter](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            return exporter->fill(buffer, maxLen);
+        }));
 }
 
 void NetworkManager::networkTaskCode(void* parameter) {
@@ -300,135 +207,319 @@ void NetworkManager::networkTaskCode(void* parameter) {
 }
 
 void NetworkManager::networkTask() {
-    NetworkRequest request;
-    TickType_t lastCheck = xTaskGetTickCount();
+    PendingEvent pending;
+    unsigned long lastRssiSample = millis();
     
     while (true) {
-        // Process any pending requests
-        if (!requestQueue.empty()) {
-            request = requestQueue.front();
-            requestQueue.pop();
-            handleRequest(request);
+        // Sleep until an event arrives or the state machine's timer is due
+        uint32_t wait = machine.timeUntilTimeout(millis());
+        if (machine.getState() == NetworkState::CONNECTED) {
+            wait = std::min<uint32_t>(wait, RSSI_SAMPLE_INTERVAL);
+        }
+        if (lease.isActive()) {
+            // Replies are read from the socket while a request is out
+            wait = std::min<uint32_t>(wait, lease.isWaiting() ? LEASE_POLL_INTERVAL : lease.timeUntilDue(millis()));
         }
-        
-        // Periodic connection check
-        if (state == NetworkState::CONNECTED && 
-            (xTaskGetTickCount() - lastCheck) >= pdMS_TO_TICKS(RECONNECT_INTERVAL)) {
-            queueRequest(NetworkRequest::Type::CHECK_CONNECTION);
-            lastCheck = xTaskGetTickCount();
+        TickType_t ticks = wait == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(wait);
+
+        if (xQueueReceive(eventQueue, &pending, ticks) == pdTRUE) {
+            dispatch(pending);
+            memset(pending.password, 0, sizeof(pending.password));
+        } else {
+            perform(machine.poll(millis()));
+        }
+
+        serviceLease();
+
+        // Signal history for ranking comes from the published gauge
+        if (machine.getState() == NetworkState::CONNECTED && millis() - lastRssiSample >= RSSI_SAMPLE_INTERVAL) {
+            ranker.recordRssi(currentCredential,
+                              mcp::MetricsSystem::getInstance().getMetric("system.wifi.signal").gauge);
+            lastRssiSample = millis();
         }
-        
-        // Yield to other tasks
-        vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
 
-void NetworkManager::handleRequest(const NetworkRequest& request) {
-    Serial.printf("\n=== Handling Request Type: %d ===\n", static_cast<int>(request.type));
-    switch (request.type) {
-        case NetworkRequest::Type::CONNECT:
-            Serial.println("Processing CONNECT request");
-            connect();
-            break;
-        case NetworkRequest::Type::START_AP:
-            Serial.println("Processing START_AP request");
-            startAP();
-            break;
-        case NetworkRequest::Type::CHECK_CONNECTION:
-            Serial.println("Processing CHECK_CONNECTION request");
-            checkConnection();
-            break;
+bool NetworkManager::postEvent(NetworkEvent event, uint8_t reason) {
+    PendingEvent pending = {};
+    pending.event = event;
+    pending.reason = reason;
+    if (!eventQueue || xQueueSend(eventQueue, &pending, 0) != pdTRUE) {
+        MCP_LOGW("Network event %s dropped", mcp::NetworkStateMachine::eventName(event));
+        return false;
     }
-    Serial.println("=== Request Handled ===\n");
+    return true;
 }
 
-void NetworkManager::connect() {
-    Serial.println("\n=== Starting WiFi Connection ===");
+bool NetworkManager::postCredentials(const String& ssid, const String& password) {
+    PendingEvent pending = {};
+    pending.event = NetworkEvent::CREDENTIALS_SAVED;
+    strlcpy(pending.ssid, ssid.c_str(), sizeof(pending.ssid));
+    strlcpy(pending.password, password.c_str(), sizeof(pending.password));
+    bool queued = eventQueue && xQueueSend(eventQueue, &pending, 0) == pdTRUE;
+    memset(pending.password, 0, sizeof(pending.password));
+    if (!queued) {
+        MCP_LOGW("Network event %s dropped", mcp::NetworkStateMachine::eventName(pending.event));
+    }
+    return queued;
+}
+
+void NetworkManager::dispatch(const PendingEvent& pending) {
+    NetworkEvent event = pending.event;
+    uint8_t reason = pending.reason;
+    if (event == NetworkEvent::CREDENTIALS_SAVED) {
+        saveCredentials(pending.ssid, pending.password);
+    }
+
+    NetworkState before = machine.getState();
+    NetworkAction action = machine.handle(event, reason);
+    if (machine.getState() != before) {
+        MCP_LOGI("Network: %s --%s(%u)--> %s", mcp::NetworkStateMachine::stateName(before),
+                 mcp::NetworkStateMachine::eventName(event), reason,
+                 mcp::NetworkStateMachine::stateName(machine.getState()));
+    }
+    perform(action);
+}
+
+void NetworkManager::perform(NetworkAction action) {
+    // An action may resolve straight into a follow-up event (retry, give up)
+    while (action != NetworkAction::NONE) {
+        NetworkEvent next = NetworkEvent::NONE;
+        switch (action) {
+            case NetworkAction::BEGIN_CONNECT:
+                next = beginConnect();
+                break;
+            case NetworkAction::ON_CONNECTED:
+                onConnected();
+                break;
+            case NetworkAction::ON_CONNECT_FAILED:
+                next = onConnectFailed();
+                break;
+            case NetworkAction::ON_LINK_LOST:
+                // Jittered even on the first retry: every device behind a
+                // restarting AP sees the loss at the same moment
+                MCP_LOGW("WiFi connection lost (reason %u)", machine.getLastReason());
+                stopLease();
+                next = scheduleReconnect();
+                break;
+            case NetworkAction::ON_LEASE:
+                onLease();
+                break;
+            case NetworkAction::START_AP:
+                startAP();
+                break;
+            case NetworkAction::NONE:
+                break;
+        }
+        action = next == NetworkEvent::NONE ? NetworkAction::NONE : machine.handle(next);
+    }
+}
+
+NetworkManager::NetworkEvent NetworkManager::beginConnect() {
+    MCP_LOGD("=== Starting WiFi Connection ===");
     
     // Check if credentials are valid
-    if (!credentials.valid) {
-        Serial.println("ERROR: Invalid credentials - Starting AP mode");
-        startAP();
-        return;
+    if (!hasCredentials()) {
+        MCP_LOGE("Invalid credentials - Starting AP mode");
+        return NetworkEvent::GIVE_UP;
     }
 
-    // Check if we've exceeded max connection attempts
-    if (connectAttempts >= MAX_CONNECT_ATTEMPTS) {
-        Serial.printf("ERROR: Max connection attempts (%d) reached - Starting AP mode\n", MAX_CONNECT_ATTEMPTS);
-        startAP();
-        return;
+    // A round tries every stored network once, best ranked first
+    bool firstOfCycle = backoff.attempts() == 0 && connectOrderPos == 0;
+    if (connectOrderPos >= connectOrderCount) {
+        connectOrderCount = ranker.rank(credentialUsed, connectOrder);
+        connectOrderPos = 0;
     }
+    currentCredential = connectOrder[connectOrderPos++];
+    const Credential& credential = credentials[currentCredential];
 
-    Serial.print("Attempting to connect to WiFi: ");
-    Serial.println(credentials.ssid);
-    Serial.printf("Connection attempt %d of %d\n", connectAttempts + 1, MAX_CONNECT_ATTEMPTS);
+    MCP_LOGI("Attempting to connect to WiFi: %s", credential.ssid.c_str());
+    MCP_LOGI("Round %u, network %u of %u (score %.2f)", backoff.attempts() + 1,
+             static_cast<unsigned>(connectOrderPos), static_cast<unsigned>(connectOrderCount),
+             ranker.score(currentCredential));
     
-    state = NetworkState::CONNECTING;
     WiFi.mode(WIFI_STA);
-    WiFi.begin(credentials.ssid.c_str(), credentials.password.c_str());
-    
-    connectAttempts++;
+
+    // Fast path: join the last good BSSID on its channel with the last lease,
+    // skipping both the channel scan and the wait for DHCP (onConnected()
+    // has the DHCP server confirm the lease once the link is up)
+    stopLease();
+    fastConnectPending = firstOfCycle && loadFastConnect() && fastConnect.ssid == credential.ssid;
+    if (fastConnectPending) {
+        MCP_LOGI("Fast connect: channel %d, IP %s", fastConnect.channel, fastConnect.ip.toString().c_str());
+        WiFi.config(fastConnect.ip, fastConnect.gateway, fastConnect.subnet, fastConnect.dns);
+        WiFi.begin(credential.ssid.c_str(), credential.password.c_str(), fastConnect.channel, fastConnect.bssid);
+    } else {
+        WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // Back to DHCP
+        WiFi.begin(credential.ssid.c_str(), credential.password.c_str());
+    }
     lastConnectAttempt = millis();
 
-    // Schedule a connection check
-    queueRequest(NetworkRequest::Type::CHECK_CONNECTION);
-    Serial.println("=== WiFi Connection Initiated ===\n");
-}
-
-void NetworkManager::checkConnection() {
-    Serial.println("\n=== Checking Connection Status ===");
-    if (state == NetworkState::CONNECTING) {
-        wl_status_t status = WiFi.status();
-        Serial.printf("WiFi Status: %d (", status);
-        switch (status) {
-            case WL_IDLE_STATUS: Serial.println("IDLE)"); break;
-            case WL_NO_SSID_AVAIL: Serial.println("NO SSID AVAILABLE)"); break;
-            case WL_CONNECT_FAILED: Serial.println("CONNECT FAILED)"); break;
-            case WL_CONNECTION_LOST: Serial.println("CONNECTION LOST)"); break;
-            case WL_DISCONNECTED: Serial.println("DISCONNECTED)"); break;
-            case WL_CONNECTED: Serial.println("CONNECTED)"); break;
-            default: Serial.println("UNKNOWN)"); break;
-        }
-        
-        if (status == WL_CONNECTED) {
-            Serial.println("WiFi Connected Successfully!");
-            Serial.print("IP Address: ");
-            Serial.println(WiFi.localIP());
-            state = NetworkState::CONNECTED;
-            connectAttempts = 0;  // Reset attempts on successful connection
-            setupWebServer();
-            ws.textAll(getNetworkStatusJson(state, getSSID(), getIPAddress()));
-        } else if (millis() - lastConnectAttempt >= CONNECT_TIMEOUT) {
-            Serial.println("Connection timeout!");
-            if (connectAttempts >= MAX_CONNECT_ATTEMPTS) {
-                Serial.println("Max attempts reached - Starting AP mode");
-                startAP();
-            } else {
-                Serial.printf("Retrying connection (attempt %d of %d)\n", connectAttempts + 1, MAX_CONNECT_ATTEMPTS);
-                state = NetworkState::CONNECTION_FAILED;
-                queueRequest(NetworkRequest::Type::CONNECT);
-            }
-        } else {
-            Serial.println("Still connecting...");
-            queueRequest(NetworkRequest::Type::CHECK_CONNECTION);
+    // GOT_IP or DISCONNECTED ends the attempt; the timer catches silence
+    machine.armTimer(lastConnectAttempt, fastConnectPending ? FAST_CONNECT_TIMEOUT : CONNECT_TIMEOUT);
+    MCP_LOGD("=== WiFi Connection Initiated ===");
+    return NetworkEvent::NONE;
+}
+
+void NetworkManager::onConnected() {
+    MCP_LOGI("WiFi Connected Successfully! IP Address: %s", WiFi.localIP().toString().c_str());
+    mcp::MetricsSystem& metrics = mcp::MetricsSystem::getInstance();
+    metrics.recordHistogram("wifi.connect.duration", millis() - lastConnectAttempt);
+    metrics.incrementCounter(fastConnectPending ? "wifi.connect.fast" : "wifi.connect.full");
+    if (fastConnectPending) {
+        // The cached lease is only a guess until the DHCP server agrees.
+        // Restarting the DHCP client would clear the address first and start
+        // over with a DISCOVER, so the server is asked directly and the
+        // address stays in use meanwhile. serviceLease() reads the answer.
+        startLease();
+    }
+    fastConnectPending = false;
+    everConnected = true;
+    backoff.reset();
+    connectOrderCount = 0;
+    connectOrderPos = 0;
+    ranker.recordRssi(currentCredential, WiFi.RSSI());
+    ranker.recordSuccess(currentCredential);
+    saveCredentialStats(currentCredential);
+    if (!lease.isConfirming()) {
+        saveFastConnect();
+    }
+    setupWebServer();
+    ws.textAll(getNetworkStatusJson(getState(), getSSID(), getIPAddress()));
+}
+
+void NetworkManager::onLease() {
+    saveFastConnect(); // Writes only when the lease changed
+    ws.textAll(getNetworkStatusJson(getState(), getSSID(), getIPAddress()));
+}
+
+void NetworkManager::startLease() {
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    if (!leaseSocket.begin(mcp::DhcpLease::CLIENT_PORT)) {
+        MCP_LOGW("DHCP client port unavailable - handing the cached lease to DHCP");
+        handLeaseToDhcp();
+        return;
+    }
+    leaseCheckStart = millis();
+    lease.start(static_cast<uint32_t>(fastConnect.ip), mac, esp_random(), leaseCheckStart);
+}
+
+void NetworkManager::serviceLease() {
+    if (!lease.isActive()) {
+        return;
+    }
+
+    uint32_t now = millis();
+    uint8_t packet[mcp::DhcpLease::MAX_REPLY_SIZE];
+    while (leaseSocket.parsePacket() > 0) {
+        int length = leaseSocket.read(packet, sizeof(packet));
+        if (length <= 0) {
+            continue;
         }
-    } else if (state == NetworkState::CONNECTED) {
-        if (WiFi.status() != WL_CONNECTED) {
-            Serial.println("WiFi connection lost!");
-            state = NetworkState::CONNECTION_FAILED;
-            connectAttempts = 0;  // Reset attempts for reconnection
-            queueRequest(NetworkRequest::Type::CONNECT);
-        } else {
-            Serial.println("Connection still active");
+        bool confirming = lease.isConfirming();
+        mcp::DhcpLease::Reply reply = lease.receive(packet, length, now);
+        if (reply == mcp::DhcpLease::Reply::ACK && confirming) {
+            MCP_LOGI("DHCP confirmed the cached lease %s for %u s", fastConnect.ip.toString().c_str(),
+                     static_cast<unsigned>(lease.getLeaseTime()));
+            saveFastConnect();
+        } else if (reply == mcp::DhcpLease::Reply::NAK) {
+            MCP_LOGW("DHCP refused the cached lease %s - switching to DHCP", fastConnect.ip.toString().c_str());
+            clearFastConnect();
+            handLeaseToDhcp();
+            return;
         }
     }
-    Serial.println("=== Connection Check Complete ===\n");
+
+    // A server with no record of this client stays silent (RFC 2131 4.3.2)
+    if (lease.isConfirming() && now - leaseCheckStart >= LEASE_CHECK_TIMEOUT) {
+        MCP_LOGW("DHCP did not confirm the cached lease - switching to DHCP");
+        clearFastConnect();
+        handLeaseToDhcp();
+        return;
+    }
+
+    uint8_t request[mcp::DhcpLease::REQUEST_SIZE];
+    uint32_t destination = 0;
+    switch (lease.poll(now, request, destination)) {
+        case mcp::DhcpLease::Action::SEND:
+            leaseSocket.beginPacket(IPAddress(destination), mcp::DhcpLease::SERVER_PORT);
+            leaseSocket.write(request, sizeof(request));
+            leaseSocket.endPacket();
+            break;
+        case mcp::DhcpLease::Action::EXPIRED:
+            MCP_LOGW("Lease of %s ran out unrenewed - switching to DHCP", fastConnect.ip.toString().c_str());
+            clearFastConnect();
+            handLeaseToDhcp();
+            break;
+        case mcp::DhcpLease::Action::NONE:
+            break;
+    }
+}
+
+void NetworkManager::stopLease() {
+    lease.stop();
+    leaseSocket.stop();
+}
+
+void NetworkManager::handLeaseToDhcp() {
+    stopLease();
+    // Only once the cached address is known to be unusable: this clears it
+    // and the DHCP client starts over; onLease() saves what it is given
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+}
+
+NetworkManager::NetworkEvent NetworkManager::onConnectFailed() {
+    // Abort whatever the driver is still trying; the resulting ASSOC_LEAVE
+    // disconnect is filtered by the state machine
+    WiFi.disconnect();
+
+    if (fastConnectPending) {
+        // AP moved channel, was replaced or the lease is gone: forget it and scan
+        MCP_LOGW("Fast connect failed - falling back to full scan");
+        fastConnectPending = false;
+        clearFastConnect();
+        connectOrderPos--; // Same network again, this time with a scan
+        return NetworkEvent::RETRY;
+    }
+
+    uint8_t reason = machine.getLastReason();
+    if (mcp::NetworkStateMachine::isAuthFailure(reason)) {
+        MCP_LOGE("Authentication failed for %s (reason %u)", credentials[currentCredential].ssid.c_str(), reason);
+    } else {
+        MCP_LOGW("Connection to %s failed (reason %u)", credentials[currentCredential].ssid.c_str(), reason);
+    }
+    ranker.recordFailure(currentCredential);
+    saveCredentialStats(currentCredential);
+    return scheduleReconnect();
+}
+
+NetworkManager::NetworkEvent NetworkManager::scheduleReconnect() {
+    if (connectOrderPos < connectOrderCount) {
+        // More networks left in this round: try the next one right away
+        return NetworkEvent::RETRY;
+    }
+
+    // Round exhausted: wait a jittered, exponentially growing delay
+    connectOrderCount = 0;
+    connectOrderPos = 0;
+    uint32_t delay = backoff.next(esp_random());
+
+    // Until the device has joined a network once, give up after a few
+    // rounds so the user can fix the credentials in AP mode
+    if (!everConnected && backoff.attempts() >= MAX_CONNECT_ATTEMPTS) {
+        MCP_LOGE("Max connection rounds (%d) reached - Starting AP mode", MAX_CONNECT_ATTEMPTS);
+        return NetworkEvent::GIVE_UP;
+    }
+
+    machine.armTimer(millis(), delay);
+    MCP_LOGI("Next connection round in %u ms", delay);
+    return NetworkEvent::NONE;
 }
 
 void NetworkManager::startAP() {
-    Serial.println("\n=== Starting Access Point Mode ===");
+    MCP_LOGD("=== Starting Access Point Mode ===");
     
-    state = NetworkState::AP_MODE;
     WiFi.mode(WIFI_AP);
     
     // Configure AP IP address
@@ -436,9 +527,9 @@ void NetworkManager::startAP() {
     IPAddress gateway(192,168,4,1);
     IPAddress subnet(255,255,255,0);
     
-    Serial.println("Configuring AP with static IP...");
+    MCP_LOGD("Configuring AP with static IP...");
     if (!WiFi.softAPConfig(local_IP, gateway, subnet)) {
-        Serial.println("ERROR: AP Config Failed!");
+        MCP_LOGE("AP Config Failed!");
         return;
     }
     
@@ -446,25 +537,23 @@ void NetworkManager::startAP() {
         apSSID = generateUniqueSSID();
     }
     
-    Serial.print("Starting AP with SSID: ");
-    Serial.println(apSSID);
+    MCP_LOGI("Starting AP with SSID: %s", apSSID.c_str());
     
     if (!WiFi.softAP(apSSID.c_str())) {
-        Serial.println("ERROR: AP Start Failed!");
+        MCP_LOGE("AP Start Failed!");
         return;
     }
     
-    Serial.print("AP IP address: ");
-    Serial.println(WiFi.softAPIP());
+    MCP_LOGI("AP IP address: %s", WiFi.softAPIP().toString().c_str());
     
     // Initialize web server
-    Serial.println("Initializing web server...");
+    MCP_LOGD("Initializing web server...");
     setupWebServer();
-    Serial.println("Web server initialized");
+    MCP_LOGD("Web server initialized");
     
     // Notify all connected clients
-    ws.textAll(getNetworkStatusJson(state, apSSID, WiFi.softAPIP().toString()));
-    Serial.println("=== AP Mode Ready ===\n");
+    ws.textAll(getNetworkStatusJson(getState(), apSSID, WiFi.softAPIP().toString()));
+    MCP_LOGD("=== AP Mode Ready ===");
 }
 
 String NetworkManager::generateUniqueSSID() {
@@ -475,63 +564,194 @@ String NetworkManager::generateUniqueSSID() {
 }
 
 bool NetworkManager::loadCredentials() {
-    Serial.println("\n=== Loading WiFi Credentials ===");
+    MCP_LOGD("=== Loading WiFi Credentials ===");
     
     preferences.begin("network", true);
-    credentials.ssid = preferences.getString("ssid", "");
-    credentials.password = preferences.getString("pass", "");
+    for (size_t i = 0; i < MAX_CREDENTIALS; i++) {
+        credentials[i].ssid = preferences.getString(credentialKey("ssid", i).c_str(), "");
+        credentials[i].password = preferences.getString(credentialKey("pass", i).c_str(), "");
+        credentialUsed[i] = !credentials[i].ssid.isEmpty();
+
+        mcp::CredentialRanker::Stats stats;
+        if (credentialUsed[i] &&
+            preferences.getBytes(credentialKey("wstat", i).c_str(), &stats, sizeof(stats)) == sizeof(stats)) {
+            ranker.setStats(i, stats);
+        } else {
+            ranker.clear(i);
+        }
+
+        if (credentialUsed[i]) {
+            MCP_LOGD("Network %u: %s (score %.2f)", static_cast<unsigned>(i),
+                     credentials[i].ssid.c_str(), ranker.score(i));
+        }
+    }
     preferences.end();
     
-    Serial.print("SSID: ");
-    Serial.println(credentials.ssid.isEmpty() ? "Not found" : credentials.ssid);
-    Serial.print("Password: ");
-    Serial.println(credentials.password.isEmpty() ? "Not found" : "********");
-    
-    credentials.valid = !credentials.ssid.isEmpty();
-    Serial.print("Credentials valid: ");
-    Serial.println(credentials.valid ? "Yes" : "No");
+    bool valid = hasCredentials();
+    MCP_LOGD("Credentials valid: %s", valid ? "Yes" : "No");
     
-    if (!credentials.valid) {
-        Serial.println("No valid credentials found - Will start in AP mode");
+    if (!valid) {
+        MCP_LOGI("No valid credentials found - Will start in AP mode");
     }
     
-    Serial.println("==============================\n");
-    return credentials.valid;
+    return valid;
 }
 
 void NetworkManager::saveCredentials(const String& ssid, const String& password) {
-    Serial.println("\n=== Saving WiFi Credentials ===");
-    Serial.print("SSID: ");
-    Serial.println(ssid);
-    Serial.println("Password: ********");
+    MCP_LOGD("=== Saving WiFi Credentials ===");
+    MCP_LOGI("SSID: %s, Password: ********", ssid.c_str());
+
+    // Update an existing entry, else take a free slot, else replace the worst ranked
+    int slot = -1;
+    for (size_t i = 0; i < MAX_CREDENTIALS && slot < 0; i++) {
+        if (credentialUsed[i] && credentials[i].ssid == ssid) {
+            slot = i;
+        }
+    }
+    for (size_t i = 0; i < MAX_CREDENTIALS && slot < 0; i++) {
+        if (!credentialUsed[i]) {
+            slot = i;
+            ranker.clear(i);
+        }
+    }
+    if (slot < 0) {
+        uint8_t order[MAX_CREDENTIALS];
+        slot = order[ranker.rank(credentialUsed, order) - 1];
+        MCP_LOGI("Replacing lowest ranked network: %s", credentials[slot].ssid.c_str());
+        ranker.clear(slot);
+    }
     
     preferences.begin("network", false);
-    preferences.putString("ssid", ssid);
-    preferences.putString("pass", password);
+    preferences.putString(credentialKey("ssid", slot).c_str(), ssid);
+    preferences.putString(credentialKey("pass", slot).c_str(), password);
     preferences.end();
+    saveCredentialStats(slot);
     
-    credentials.ssid = ssid;
-    credentials.password = password;
-    credentials.valid = true;
-    
-    connectAttempts = 0;
-    Serial.println("Credentials saved successfully");
-    Serial.println("Initiating connection...");
-    queueRequest(NetworkRequest::Type::CONNECT);
-    Serial.println("=== Credentials Saved ===\n");
+    credentials[slot].ssid = ssid;
+    credentials[slot].password = password;
+    credentialUsed[slot] = true;
+
+    // The network the user just entered is tried first
+    connectOrderCount = ranker.rank(credentialUsed, connectOrder);
+    std::rotate(connectOrder, std::find(connectOrder, connectOrder + connectOrderCount, slot),
+                std::find(connectOrder, connectOrder + connectOrderCount, slot) + 1);
+    connectOrderPos = 0;
+    backoff.reset();
+
+    MCP_LOGI("Credentials saved successfully - Initiating connection...");
+    MCP_LOGD("=== Credentials Saved ===");
+}
+
+void NetworkManager::saveCredentialStats(int slot) {
+    if (slot < 0 || slot >= static_cast<int>(MAX_CREDENTIALS)) {
+        return;
+    }
+    const mcp::CredentialRanker::Stats& stats = ranker.getStats(slot);
+    preferences.begin("network", false);
+    preferences.putBytes(credentialKey("wstat", slot).c_str(), &stats, sizeof(stats));
+    preferences.end();
+}
+
+bool NetworkManager::hasCredentials() const {
+    for (size_t i = 0; i < MAX_CREDENTIALS; i++) {
+        if (credentialUsed[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+String NetworkManager::credentialKey(const char* prefix, size_t slot) {
+    // Slot 0 keeps the original single-network keys
+    return slot == 0 && strcmp(prefix, "wstat") != 0 ? String(prefix) : String(prefix) + slot;
 }
 
 void NetworkManager::clearCredentials() {
-    Serial.println("\n=== Clearing WiFi Credentials ===");
+    MCP_LOGD("=== Clearing WiFi Credentials ===");
     preferences.begin("network", false);
     preferences.clear();
     preferences.end();
     
-    credentials.ssid = "";
-    credentials.password = "";
-    credentials.valid = false;
-    Serial.println("Credentials cleared successfully");
-    Serial.println("=== Credentials Cleared ===\n");
+    for (size_t i = 0; i < MAX_CREDENTIALS; i++) {
+        credentials[i].ssid = "";
+        credentials[i].password = "";
+        credentialUsed[i] = false;
+        ranker.clear(i);
+    }
+    currentCredential = 0;
+    connectOrderCount = 0;
+    connectOrderPos = 0;
+    fastConnect.valid = false;
+    MCP_LOGI("Credentials cleared successfully");
+}
+
+bool NetworkManager::loadFastConnect() {
+    if (fastConnect.valid) {
+        return true;
+    }
+
+    preferences.begin("network", true);
+    fastConnect.ssid = preferences.getString("fc_ssid", "");
+    bool complete = preferences.getBytes("fc_bssid", fastConnect.bssid, sizeof(fastConnect.bssid)) == sizeof(fastConnect.bssid);
+    fastConnect.channel = preferences.getInt("fc_chan", 0);
+    fastConnect.ip = IPAddress(preferences.getUInt("fc_ip", 0));
+    fastConnect.gateway = IPAddress(preferences.getUInt("fc_gw", 0));
+    fastConnect.subnet = IPAddress(preferences.getUInt("fc_mask", 0));
+    fastConnect.dns = IPAddress(preferences.getUInt("fc_dns", 0));
+    preferences.end();
+
+    fastConnect.valid = complete && !fastConnect.ssid.isEmpty() && fastConnect.channel > 0 &&
+                        static_cast<uint32_t>(fastConnect.ip) != 0;
+    return fastConnect.valid;
+}
+
+void NetworkManager::saveFastConnect() {
+    uint8_t* bssid = WiFi.BSSID();
+    int32_t channel = WiFi.channel();
+    if (!bssid || channel <= 0) {
+        return;
+    }
+
+    // Only write flash when the association actually changed
+    const String& ssid = credentials[currentCredential].ssid;
+    if (fastConnect.valid && fastConnect.ssid == ssid && fastConnect.channel == channel &&
+        memcmp(fastConnect.bssid, bssid, sizeof(fastConnect.bssid)) == 0 &&
+        fastConnect.ip == WiFi.localIP() && fastConnect.gateway == WiFi.gatewayIP()) {
+        return;
+    }
+
+    fastConnect.ssid = ssid;
+    memcpy(fastConnect.bssid, bssid, sizeof(fastConnect.bssid));
+    fastConnect.channel = channel;
+    fastConnect.ip = WiFi.localIP();
+    fastConnect.gateway = WiFi.gatewayIP();
+    fastConnect.subnet = WiFi.subnetMask();
+    fastConnect.dns = WiFi.dnsIP();
+    fastConnect.valid = true;
+
+    preferences.begin("network", false);
+    preferences.putString("fc_ssid", fastConnect.ssid);
+    preferences.putBytes("fc_bssid", fastConnect.bssid, sizeof(fastConnect.bssid));
+    preferences.putInt("fc_chan", fastConnect.channel);
+    preferences.putUInt("fc_ip", static_cast<uint32_t>(fastConnect.ip));
+    preferences.putUInt("fc_gw", static_cast<uint32_t>(fastConnect.gateway));
+    preferences.putUInt("fc_mask", static_cast<uint32_t>(fastConnect.subnet));
+    preferences.putUInt("fc_dns", static_cast<uint32_t>(fastConnect.dns));
+    preferences.end();
+    MCP_LOGI("Saved association for fast reconnect");
+}
+
+void NetworkManager::clearFastConnect() {
+    fastConnect.valid = false;
+    preferences.begin("network", false);
+    preferences.remove("fc_ssid");
+    preferences.remove("fc_bssid");
+    preferences.remove("fc_chan");
+    preferences.remove("fc_ip");
+    preferences.remove("fc_gw");
+    preferences.remove("fc_mask");
+    preferences.remove("fc_dns");
+    preferences.end();
 }
 
 String NetworkManager::getNetworkStatusJson(NetworkState state, const String& ssid, const String& ip) {
@@ -562,22 +782,34 @@ String NetworkManager::getNetworkStatusJson(NetworkState state, const String& ss
     return response;
 }
 
+AsyncWebServer& NetworkManager::getWebServer() {
+    return server;
+}
+
+AsyncWebSocket& NetworkManager::getWebSocket() {
+    return ws;
+}
+
+mcp::MetricsStream& NetworkManager::getMetricsStream() {
+    return metricsStream;
+}
+
 bool NetworkManager::isConnected() {
-    return state == NetworkState::CONNECTED && WiFi.status() == WL_CONNECTED;
+    return getState() == NetworkState::CONNECTED && WiFi.status() == WL_CONNECTED;
 }
 
 String NetworkManager::getIPAddress() {
-    return state == NetworkState::AP_MODE ? 
+    return getState() == NetworkState::AP_MODE ? 
            WiFi.softAPIP().toString() : 
            WiFi.localIP().toString();
 }
 
 String NetworkManager::getSSID() {
-    return state == NetworkState::AP_MODE ? 
+    return getState() == NetworkState::AP_MODE ? 
            apSSID : 
-           credentials.ssid;
+           credentials[currentCredential].ssid;
 }
 
-void NetworkManager::queueRequest(NetworkRequest::Type type, const String &message) {
-    requestQueue.push({type, message});
+NetworkManager::NetworkState NetworkManager::getState() const {
+    return machine.getState();
 }
\ No newline at end of file
@@ -1,72 +1,124 @@
-#include <queue>
 #include <WiFi.h>
+#include <WiFiUdp.h>
 #include <Preferences.h>
 #include <AsyncTCP.h>
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
-
-struct NetworkRequest {
-    enum class Type {
-        CONNECT,
-        START_AP,
-        CHECK_CONNECTION
-    };
-    Type type;
-    String message;
-};
+#include "MetricsStream.h"
+#include "StaticAssets.h"
+#include "ReconnectPolicy.h"
+#include "NetworkStateMachine.h"
+#include "DhcpLease.h"
+#include <freertos/queue.h>
 
 class NetworkManager {
 public:
-    enum class NetworkState {
-        INIT,
-        CONNECTING,
-        CONNECTED,
-        CONNECTION_FAILED,
-        AP_MODE
-    };
+    using NetworkState = mcp::NetworkStateMachine::State;
 
     NetworkManager();
     void begin();
-    void connect();
-    void checkConnection();
     bool isConnected();
+    NetworkState getState() const;
     String getIPAddress();
     String getSSID();
+    AsyncWebServer& getWebServer();
+    AsyncWebSocket& getWebSocket();
+    mcp::MetricsStream& getMetricsStream();
 
 private:
-    NetworkState state;
+    using NetworkEvent = mcp::NetworkStateMachine::Event;
+    using NetworkAction = mcp::NetworkStateMachine::Action;
+    static constexpr size_t MAX_SSID_LENGTH = 32;      // 802.11 limit
+    static constexpr size_t MAX_PASSWORD_LENGTH = 64;  // WPA2 passphrase or PSK
+    struct PendingEvent {
+        NetworkEvent event;
+        uint8_t reason;
+        // CREDENTIALS_SAVED only: the network to store and try first
+        char ssid[MAX_SSID_LENGTH + 1];
+        char password[MAX_PASSWORD_LENGTH + 1];
+    };
+
+    mcp::NetworkStateMachine machine;    // Owned by the network task
+    QueueHandle_t eventQueue;            // WiFi/web events -> network task
+    bool webServerStarted;
     Preferences preferences;
     String apSSID;
-    struct {
+    static constexpr size_t MAX_CREDENTIALS = mcp::CredentialRanker::MAX_CREDENTIALS;
+    struct Credential {
         String ssid;
         String password;
-        bool valid;
-    } credentials;
+    };
+    Credential credentials[MAX_CREDENTIALS];
+    bool credentialUsed[MAX_CREDENTIALS];
+    mcp::CredentialRanker ranker;
+    mcp::ExponentialBackoff backoff;     // Delay between connection rounds
+    uint8_t connectOrder[MAX_CREDENTIALS];
+    size_t currentCredential;            // Slot being tried or connected
+    size_t connectOrderCount;            // Networks in the current round
+    size_t connectOrderPos;              // Next network to try in the round
+    bool everConnected;                  // AP fallback only applies before the first success
     AsyncWebServer server;
     AsyncWebSocket ws;
-    int connectAttempts;
+    mcp::MetricsStream metricsStream;
+    mcp::StaticAssets assets;
+    // Last good association, reused to skip the scan and DHCP on reconnect
+    struct {
+        bool valid;
+        String ssid;
+        uint8_t bssid[6];
+        int32_t channel;
+        IPAddress ip;
+        IPAddress gateway;
+        IPAddress subnet;
+        IPAddress dns;
+    } fastConnect;
+    bool fastConnectPending;   // Current attempt uses the cached BSSID/channel/lease
+    mcp::DhcpLease lease;      // Renews the cached lease after a fast connect
+    WiFiUDP leaseSocket;       // DHCP client port while lease is active
+    unsigned long leaseCheckStart;
     unsigned long lastConnectAttempt;
     TaskHandle_t networkTaskHandle;
     void networkTask();
-    void handleRequest(const NetworkRequest& request);
+    bool postEvent(NetworkEvent event, uint8_t reason = 0);
+    bool postCredentials(const String& ssid, const String& password);
+    void dispatch(const PendingEvent& pending);
+    void perform(NetworkAction action);
+    NetworkEvent beginConnect();
+    void onConnected();
+    void onLease();
+    void startLease();
+    void serviceLease();
+    void stopLease();
+    void handLeaseToDhcp();
+    NetworkEvent onConnectFailed();
     void startAP();
     String generateUniqueSSID();
     bool loadCredentials();
     void saveCredentials(const String& ssid, const String& password);
+    void saveCredentialStats(int slot);
+    bool hasCredentials() const;
+    static String credentialKey(const char* prefix, size_t slot);
+    NetworkEvent scheduleReconnect();
     void clearCredentials();
+    bool loadFastConnect();
+    void saveFastConnect();
+    void clearFastConnect();
     String getNetworkStatusJson(NetworkState state, const String& ssid, const String& ip);
-    void queueRequest(NetworkRequest::Type type, const String &message = "");
     void setupWebServer();
     void handleRoot(AsyncWebServerRequest *request);
     void handleSave(AsyncWebServerRequest *request);
     void handleStatus(AsyncWebServerRequest *request);
-    void onWebSocketEvent(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+    void handleMetrics(AsyncWebServerRequest *request);
+    void handleStats(AsyncWebServerRequest *request);
     static void networkTaskCode(void* parameter);
 
     // Constants
-    static const int MAX_CONNECT_ATTEMPTS = 5;
+    static const int MAX_CONNECT_ATTEMPTS = 5;  // Connection rounds before AP fallback (first boot only)
     static const unsigned long CONNECT_TIMEOUT = 10000; // 10 seconds
-    static const unsigned long RECONNECT_INTERVAL = 5000; // 5 seconds
+    static const unsigned long FAST_CONNECT_TIMEOUT = 2000; // Direct connect to a cached BSSID
+    static const unsigned long LEASE_CHECK_TIMEOUT = 15000; // DHCP confirming a cached lease
+    static const unsigned long LEASE_POLL_INTERVAL = 100; // Reading replies to a lease request
+    static const unsigned long RSSI_SAMPLE_INTERVAL = 30000; // Signal history for ranking
+    static const UBaseType_t EVENT_QUEUE_SIZE = 8;
     static const char* SETUP_PAGE_PATH;
-    std::queue<NetworkRequest> requestQueue;
 }; 
\ No newline at end of file
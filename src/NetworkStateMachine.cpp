@@ -0,0 +1,124 @@
+#include "NetworkStateMachine.h"
+
+using namespace mcp;
+
+using S = NetworkStateMachine::State;
+using E = NetworkStateMachine::Event;
+using A = NetworkStateMachine::Action;
+
+const NetworkStateMachine::Transition NetworkStateMachine::TRANSITIONS[] = {
+    // from                  event                 to                    action
+    {S::INIT,              E::START_STA,         S::CONNECTING,        A::BEGIN_CONNECT},
+    {S::INIT,              E::START_AP,          S::AP_MODE,           A::START_AP},
+
+    {S::CONNECTING,        E::GOT_IP,            S::CONNECTED,         A::ON_CONNECTED},
+    {S::CONNECTING,        E::DISCONNECTED,      S::CONNECTION_FAILED, A::ON_CONNECT_FAILED},
+    {S::CONNECTING,        E::TIMEOUT,           S::CONNECTION_FAILED, A::ON_CONNECT_FAILED},
+    {S::CONNECTING,        E::GIVE_UP,           S::AP_MODE,           A::START_AP},
+
+    {S::CONNECTED,         E::DISCONNECTED,      S::CONNECTION_FAILED, A::ON_LINK_LOST},
+    {S::CONNECTED,         E::GOT_IP,            S::CONNECTED,         A::ON_LEASE},
+
+    {S::CONNECTION_FAILED, E::RETRY,             S::CONNECTING,        A::BEGIN_CONNECT},
+    {S::CONNECTION_FAILED, E::TIMEOUT,           S::CONNECTING,        A::BEGIN_CONNECT},
+    {S::CONNECTION_FAILED, E::GIVE_UP,           S::AP_MODE,           A::START_AP},
+    // The SDK may still finish an association we already gave up on
+    {S::CONNECTION_FAILED, E::GOT_IP,            S::CONNECTED,         A::ON_CONNECTED},
+
+    {S::INIT,              E::CREDENTIALS_SAVED, S::CONNECTING,        A::BEGIN_CONNECT},
+    {S::CONNECTING,        E::CREDENTIALS_SAVED, S::CONNECTING,        A::BEGIN_CONNECT},
+    {S::CONNECTED,         E::CREDENTIALS_SAVED, S::CONNECTING,        A::BEGIN_CONNECT},
+    {S::CONNECTION_FAILED, E::CREDENTIALS_SAVED, S::CONNECTING,        A::BEGIN_CONNECT},
+    {S::AP_MODE,           E::CREDENTIALS_SAVED, S::CONNECTING,        A::BEGIN_CONNECT},
+};
+
+const size_t NetworkStateMachine::TRANSITION_COUNT = sizeof(TRANSITIONS) / sizeof(TRANSITIONS[0]);
+
+NetworkStateMachine::NetworkStateMachine()
+    : state(State::INIT),
+      timerArmed(false),
+      timerStart(0),
+      timerDuration(0),
+      lastReason(0) {
+}
+
+NetworkStateMachine::Action NetworkStateMachine::handle(Event event, uint8_t reason) {
+    if (event == Event::DISCONNECTED) {
+        // Leaving an association to start a new attempt reports ASSOC_LEAVE;
+        // that is our own doing, not a failure of the attempt now in flight
+        if (reason == REASON_ASSOC_LEAVE && state != State::CONNECTED) {
+            return Action::NONE;
+        }
+        lastReason = reason;
+    }
+
+    for (size_t i = 0; i < TRANSITION_COUNT; i++) {
+        const Transition& t = TRANSITIONS[i];
+        if (t.from == state && t.event == event) {
+            state = t.to;
+            timerArmed = false;
+            return t.action;
+        }
+    }
+    return Action::NONE;
+}
+
+void NetworkStateMachine::armTimer(uint32_t now, uint32_t duration) {
+    timerArmed = true;
+    timerStart = now;
+    timerDuration = duration;
+}
+
+uint32_t NetworkStateMachine::timeUntilTimeout(uint32_t now) const {
+    if (!timerArmed) {
+        return UINT32_MAX;
+    }
+    uint32_t elapsed = now - timerStart;
+    return elapsed >= timerDuration ? 0 : timerDuration - elapsed;
+}
+
+NetworkStateMachine::Action NetworkStateMachine::poll(uint32_t now) {
+    if (!timerArmed || timeUntilTimeout(now) > 0) {
+        return Action::NONE;
+    }
+    timerArmed = false;
+    return handle(Event::TIMEOUT);
+}
+
+bool NetworkStateMachine::isAuthFailure(uint8_t reason) {
+    switch (reason) {
+        case 2:   // WIFI_REASON_AUTH_EXPIRE
+        case 15:  // WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT
+        case 202: // WIFI_REASON_AUTH_FAIL
+        case 204: // WIFI_REASON_HANDSHAKE_TIMEOUT
+            return true;
+        default:
+            return false;
+    }
+}
+
+const char* NetworkStateMachine::stateName(State s) {
+    switch (s) {
+        case State::INIT: return "INIT";
+        case State::CONNECTING: return "CONNECTING";
+        case State::CONNECTED: return "CONNECTED";
+        case State::CONNECTION_FAILED: return "CONNECTION_FAILED";
+        case State::AP_MODE: return "AP_MODE";
+    }
+    return "UNKNOWN";
+}
+
+const char* NetworkStateMachine::eventName(Event e) {
+    switch (e) {
+        case Event::NONE: return "NONE";
+        case Event::START_STA: return "START_STA";
+        case Event::START_AP: return "START_AP";
+        case Event::GOT_IP: return "GOT_IP";
+        case Event::DISCONNECTED: return "DISCONNECTED";
+        case Event::TIMEOUT: return "TIMEOUT";
+        case Event::RETRY: return "RETRY";
+        case Event::GIVE_UP: return "GIVE_UP";
+        case Event::CREDENTIALS_SAVED: return "CREDENTIALS_SAVED";
+    }
+    return "UNKNOWN";
+}
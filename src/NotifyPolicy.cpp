@@ -0,0 +1,85 @@
+#include "NotifyPolicy.h"
+#include <cmath>
+#include <cstdlib>
+
+using namespace mcp;
+
+NotifyPolicy::NotifyPolicy(const Config &config)
+    : config(config),
+      lastNumber(0),
+      lastNumeric(false),
+      lastSent(0),
+      pending(false),
+      pendingNumber(0),
+      pendingNumeric(false) {
+}
+
+bool NotifyPolicy::parseNumber(const std::string &text, double &number) {
+    if (text.empty()) {
+        return false;
+    }
+    char *end = nullptr;
+    number = strtod(text.c_str(), &end);
+    return end && *end == '\0' && std::isfinite(number);
+}
+
+void NotifyPolicy::reset(const std::string &value, uint32_t now) {
+    double number = 0;
+    bool numeric = parseNumber(value, number);
+    markSent(value, number, numeric, now);
+}
+
+bool NotifyPolicy::isSignificant(const std::string &text, double number, bool numeric) const {
+    if (!numeric || !lastNumeric) {
+        return text != lastText;
+    }
+    double delta = std::fabs(number - lastNumber);
+    double threshold = config.deadbandPercent ? std::fabs(lastNumber) * config.deadband / 100.0 : config.deadband;
+    return delta > 0 && delta >= threshold;
+}
+
+void NotifyPolicy::markSent(const std::string &text, double number, bool numeric, uint32_t now) {
+    lastText = text;
+    lastNumber = number;
+    lastNumeric = numeric;
+    lastSent = now;
+    pending = false;
+    pendingText.clear();
+}
+
+bool NotifyPolicy::update(const std::string &value, uint32_t now) {
+    double number = 0;
+    bool numeric = parseNumber(value, number);
+
+    // Judged against the last notified value; a change that reverts before
+    // a coalesced notification goes out cancels it
+    if (!isSignificant(value, number, numeric)) {
+        pending = false;
+        return false;
+    }
+
+    if (now - lastSent >= config.minInterval) {
+        markSent(value, number, numeric, now);
+        return true;
+    }
+
+    pending = true;
+    pendingText = value;
+    pendingNumber = number;
+    pendingNumeric = numeric;
+    return false;
+}
+
+bool NotifyPolicy::poll(uint32_t now) {
+    if (pending && now - lastSent >= config.minInterval) {
+        std::string text;
+        text.swap(pendingText);
+        markSent(text, pendingNumber, pendingNumeric, now);
+        return true;
+    }
+    if (config.maxInterval && now - lastSent >= config.maxInterval) {
+        lastSent = now; // Heartbeat: value unchanged, baseline kept
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,109 @@
+#include "ReconnectPolicy.h"
+#include <algorithm>
+
+using namespace mcp;
+
+ExponentialBackoff::ExponentialBackoff(uint32_t baseDelay, uint32_t maxDelay)
+    : baseDelay(std::max<uint32_t>(baseDelay, 1)),
+      maxDelay(std::max(maxDelay, baseDelay)),
+      attempt(0) {
+}
+
+uint32_t ExponentialBackoff::window() const {
+    // Stop doubling once the cap is reached so the shift cannot overflow
+    uint32_t delay = baseDelay;
+    for (uint32_t i = 0; i < attempt && delay < maxDelay; i++) {
+        delay = delay > maxDelay / 2 ? maxDelay : delay * 2;
+    }
+    return std::min(delay, maxDelay);
+}
+
+uint32_t ExponentialBackoff::next(uint32_t random) {
+    uint32_t delay = random % (window() + 1);
+    attempt++;
+    return delay;
+}
+
+CredentialRanker::CredentialRanker() {
+    for (size_t i = 0; i < MAX_CREDENTIALS; i++) {
+        clear(i);
+    }
+}
+
+void CredentialRanker::clear(size_t slot) {
+    if (slot < MAX_CREDENTIALS) {
+        stats[slot] = Stats{0.0f, 0, 0, 0, 0};
+    }
+}
+
+void CredentialRanker::setStats(size_t slot, const Stats& value) {
+    if (slot < MAX_CREDENTIALS) {
+        stats[slot] = value;
+    }
+}
+
+void CredentialRanker::recordRssi(size_t slot, int rssi) {
+    if (slot >= MAX_CREDENTIALS || rssi >= 0) {
+        return; // 0 means "not associated" on ESP32
+    }
+    Stats& s = stats[slot];
+    if (!s.hasRssi) {
+        s.rssi = rssi;
+        s.hasRssi = 1;
+    } else {
+        s.rssi += RSSI_ALPHA * (rssi - s.rssi);
+    }
+}
+
+void CredentialRanker::recordSuccess(size_t slot) {
+    if (slot < MAX_CREDENTIALS) {
+        stats[slot].successes++;
+        trimHistory(stats[slot]);
+    }
+}
+
+void CredentialRanker::recordFailure(size_t slot) {
+    if (slot < MAX_CREDENTIALS) {
+        stats[slot].failures++;
+        trimHistory(stats[slot]);
+    }
+}
+
+void CredentialRanker::trimHistory(Stats& s) {
+    // Halving keeps the ratio while letting recent behavior dominate
+    if (s.successes + s.failures > MAX_HISTORY) {
+        s.successes /= 2;
+        s.failures /= 2;
+    }
+}
+
+float CredentialRanker::score(size_t slot) const {
+    if (slot >= MAX_CREDENTIALS) {
+        return 0.0f;
+    }
+    const Stats& s = stats[slot];
+
+    float signal = 0.5f;
+    if (s.hasRssi) {
+        signal = (s.rssi - RSSI_FLOOR) / (RSSI_CEILING - RSSI_FLOOR);
+        signal = std::min(1.0f, std::max(0.0f, signal));
+    }
+    // Laplace smoothing: no history scores 0.5
+    float success = (s.successes + 1.0f) / (s.successes + s.failures + 2.0f);
+
+    return SIGNAL_WEIGHT * signal + (1.0f - SIGNAL_WEIGHT) * success;
+}
+
+size_t CredentialRanker::rank(const bool used[MAX_CREDENTIALS], uint8_t order[MAX_CREDENTIALS]) const {
+    size_t count = 0;
+    for (size_t i = 0; i < MAX_CREDENTIALS; i++) {
+        if (used[i]) {
+            order[count++] = i;
+        }
+    }
+    // Stable so equal scores keep slot (i.e. save) order
+    std::stable_sort(order, order + count, [this](uint8_t a, uint8_t b) {
+        return score(a) > score(b);
+    });
+    return count;
+}
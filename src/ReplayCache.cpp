@@ -0,0 +1,49 @@
+#include "ReplayCache.h"
+
+using namespace mcp;
+
+void ReplayCache::setBudget(size_t bytes) {
+    budget = bytes;
+    evict(0);
+}
+
+bool ReplayCache::store(const RequestId &id, const char *response, size_t len) {
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->id == id) {
+            used -= it->response.size();
+            entries.erase(it);
+            break;
+        }
+    }
+    if (len > budget) {
+        return false;
+    }
+
+    evict(len);
+    entries.push_front(Entry{id, std::string(response, len)});
+    used += len;
+    return true;
+}
+
+const std::string *ReplayCache::find(const RequestId &id) {
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->id == id) {
+            // Few entries per session: a scan beats maintaining an index
+            entries.splice(entries.begin(), entries, it);
+            return &entries.front().response;
+        }
+    }
+    return nullptr;
+}
+
+void ReplayCache::clear() {
+    entries.clear();
+    used = 0;
+}
+
+void ReplayCache::evict(size_t needed) {
+    while (!entries.empty() && used + needed > budget) {
+        used -= entries.back().response.size();
+        entries.pop_back();
+    }
+}
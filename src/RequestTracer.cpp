@@ -0,0 +1,129 @@
+#include "RequestTracer.h"
+#include "MetricsSystem.h"
+#include "MCPTypes.h"
+
+using namespace mcp;
+
+namespace {
+
+// Intervals recorded per method, each spanning two consecutive phases
+struct TraceStage {
+    const char* name;
+    TracePhase from;
+    TracePhase to;
+};
+
+const TraceStage TRACE_STAGES[] = {
+    {"parse",     TracePhase::RECEIVED,   TracePhase::PARSED},
+    {"queue",     TracePhase::QUEUED,     TracePhase::DISPATCHED},
+    {"handler",   TracePhase::DISPATCHED, TracePhase::HANDLED},
+    {"serialize", TracePhase::HANDLED,    TracePhase::SERIALIZED},
+    {"send",      TracePhase::SERIALIZED, TracePhase::SENT},
+    {"total",     TracePhase::RECEIVED,   TracePhase::SENT},
+};
+static_assert(sizeof(TRACE_STAGES) / sizeof(TRACE_STAGES[0]) == RequestTracer::STAGE_COUNT,
+              "STAGE_COUNT sizes the metric registry");
+
+// Metric name of each MCPRequestType, in enum order
+const char* const TRACED_TYPE_NAMES[] = {
+    "initialize",
+    "resources_list",
+    "resources_read",
+    "resources_subscribe",
+    "resources_unsubscribe",
+    "tools_list",
+    "tools_call",
+    "resources_templates_list",
+    "logging_setLevel",
+    "other",
+};
+static_assert(sizeof(TRACED_TYPE_NAMES) / sizeof(TRACED_TYPE_NAMES[0]) == RequestTracer::TRACED_TYPES,
+              "One metric name per request type");
+
+const char* REQUESTS_TOTAL = "mcp.requests.total";
+const char* REQUESTS_ERRORS = "mcp.requests.errors";
+const char* REQUEST_DURATION = "mcp.request.duration";
+
+} // namespace
+
+RequestTracer::RequestTracer()
+    : slowHead(0),
+      slowCount(0),
+      slowThresholdUs(DEFAULT_SLOW_THRESHOLD_US) {
+    memset(registered, 0, sizeof(registered));
+    MetricsSystem& metrics = MetricsSystem::getInstance();
+    metrics.registerCounter(REQUESTS_TOTAL, "MCP requests completed", "", "mcp");
+    metrics.registerCounter(REQUESTS_ERRORS, "MCP requests that failed to parse or dispatch", "", "mcp");
+    metrics.registerHistogram(REQUEST_DURATION, "MCP request latency, all methods", "ms", "mcp");
+}
+
+void RequestTracer::setSlowThreshold(uint32_t thresholdUs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    slowThresholdUs = thresholdUs;
+}
+
+String RequestTracer::metricPrefix(MCPRequestType type) {
+    size_t index = static_cast<size_t>(type);
+    if (index >= TRACED_TYPES) {
+        index = static_cast<size_t>(MCPRequestType::UNKNOWN);
+    }
+    String name = TRACED_TYPE_NAMES[index];
+    if (!registered[index]) {
+        registered[index] = true;
+        MetricsSystem& metrics = MetricsSystem::getInstance();
+        for (const auto& stage : TRACE_STAGES) {
+            String metric = "mcp." + name + "." + stage.name;
+            metrics.registerHistogram(metric, String("MCP ") + name + " " + stage.name + " latency",
+                                      "ms", "mcp");
+        }
+    }
+    return "mcp." + name + ".";
+}
+
+void RequestTracer::complete(const RequestTrace& trace) {
+    uint32_t total = trace.total();
+    String prefix;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        prefix = metricPrefix(trace.type);
+
+        if (total >= slowThresholdUs) {
+            SlowEntry& entry = slowRing[slowHead];
+            entry.trace = trace;
+            entry.completedAt = millis();
+            slowHead = (slowHead + 1) % SLOW_RING_SIZE;
+            if (slowCount < SLOW_RING_SIZE) {
+                slowCount++;
+            }
+        }
+    }
+
+    MetricsSystem& metrics = MetricsSystem::getInstance();
+    for (const auto& stage : TRACE_STAGES) {
+        metrics.recordHistogram(prefix + stage.name, trace.elapsed(stage.from, stage.to) / 1000.0);
+    }
+    metrics.recordHistogram(REQUEST_DURATION, total / 1000.0);
+    metrics.incrementCounter(REQUESTS_TOTAL);
+}
+
+void RequestTracer::recordError() {
+    MetricsSystem::getInstance().incrementCounter(REQUESTS_ERRORS);
+}
+
+void RequestTracer::writeSlowRequests(JsonArray out) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint32_t now = millis();
+    for (size_t i = 0; i < slowCount; i++) {
+        const SlowEntry& entry = slowRing[(slowHead + SLOW_RING_SIZE - 1 - i) % SLOW_RING_SIZE];
+        JsonObject obj = out.add<JsonObject>();
+        obj["method"] = entry.trace.method;
+        obj["id"] = entry.trace.id;
+        obj["client"] = entry.trace.clientId;
+        obj["ageMs"] = now - entry.completedAt;
+        JsonObject stages = obj["stagesUs"].to<JsonObject>();
+        for (const auto& stage : TRACE_STAGES) {
+            stages[stage.name] = entry.trace.elapsed(stage.from, stage.to);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#include "SessionTable.h"
+#include <algorithm>
+
+using namespace mcp;
+
+bool Session::subscribe(const std::string &uri) {
+    auto it = std::lower_bound(subscriptions.begin(), subscriptions.end(), uri);
+    if (it != subscriptions.end() && *it == uri) {
+        return false;
+    }
+    subscriptions.insert(it, uri);
+    return true;
+}
+
+bool Session::unsubscribe(const std::string &uri) {
+    auto it = std::lower_bound(subscriptions.begin(), subscriptions.end(), uri);
+    if (it == subscriptions.end() || *it != uri) {
+        return false;
+    }
+    subscriptions.erase(it);
+    return true;
+}
+
+bool Session::isSubscribed(const std::string &uri) const {
+    return std::binary_search(subscriptions.begin(), subscriptions.end(), uri);
+}
+
+int SessionTable::open(Transport *transport, uint32_t connectionId, uint32_t now) {
+    for (uint8_t i = 0; i < CAPACITY; i++) {
+        if (!sessions[i].transport) {
+            Session &session = sessions[i];
+            session.transport = transport;
+            session.connectionId = connectionId;
+            session.openedAt = now;
+            return i;
+        }
+    }
+    return NONE;
+}
+
+void SessionTable::close(uint8_t clientId) {
+    if (clientId >= CAPACITY) {
+        return;
+    }
+    // Assigning a fresh session releases the subscription and replay memory
+    sessions[clientId] = Session();
+    sessions[clientId].replay.setBudget(replayBudget);
+}
+
+int SessionTable::find(const Transport *transport, uint32_t connectionId) const {
+    for (uint8_t i = 0; i < CAPACITY; i++) {
+        if (sessions[i].transport && sessions[i].transport == transport && sessions[i].connectionId == connectionId) {
+            return i;
+        }
+    }
+    return NONE;
+}
+
+Session *SessionTable::get(uint8_t clientId) {
+    return clientId < CAPACITY && sessions[clientId].transport ? &sessions[clientId] : nullptr;
+}
+
+const Session *SessionTable::get(uint8_t clientId) const {
+    return clientId < CAPACITY && sessions[clientId].transport ? &sessions[clientId] : nullptr;
+}
+
+size_t SessionTable::active() const {
+    size_t count = 0;
+    for (const Session &session : sessions) {
+        if (session.transport) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void SessionTable::setReplayBudget(size_t bytes) {
+    replayBudget = bytes;
+    for (Session &session : sessions) {
+        session.replay.setBudget(bytes);
+    }
+}
@@ -0,0 +1,189 @@
+#include "StaticAssets.h"
+#include "Log.h"
+
+using namespace mcp;
+
+StaticAssets::StaticAssets()
+    : fs(nullptr),
+      hasManifest(false),
+      cachedBytes(0) {
+}
+
+bool StaticAssets::begin(fs::FS& filesystem) {
+    if (fs) {
+        return hasManifest;
+    }
+    fs = &filesystem;
+
+    File manifest = fs->open(MANIFEST_PATH, "r");
+    if (!manifest) {
+        MCP_LOGW("Asset manifest not found - serving data/ files as-is");
+        return false;
+    }
+
+    // One "<path> <hash> <gzip> <size>" entry per line
+    while (manifest.available()) {
+        String line = manifest.readStringUntil('\n');
+        int first = line.indexOf(' ');
+        int second = line.indexOf(' ', first + 1);
+        int third = line.indexOf(' ', second + 1);
+        if (first <= 0 || second <= first || third <= second) {
+            continue;
+        }
+        Asset& asset = assets[line.substring(0, first)];
+        asset.etag = "\"" + line.substring(first + 1, second) + "\"";
+        asset.gzipped = line.substring(second + 1, third) == "1";
+        asset.size = line.substring(third + 1).toInt();
+        asset.ramLength = 0;
+    }
+    manifest.close();
+
+    hasManifest = true;
+    MCP_LOGI("Loaded %u assets from manifest", static_cast<unsigned>(assets.size()));
+    return true;
+}
+
+StaticAssets::Asset* StaticAssets::find(const String& path) {
+    auto it = assets.find(path);
+    if (it != assets.end()) {
+        return &it->second;
+    }
+    if (!fs || hasManifest || path.endsWith("/") || !fs->exists(path)) {
+        return nullptr;
+    }
+
+    // Unstaged upload: remember the file so later lookups skip the flash probe
+    Asset& asset = assets[path];
+    asset.gzipped = false;
+    asset.size = 0;
+    asset.ramLength = 0;
+    return &asset;
+}
+
+bool StaticAssets::exists(const String& path) {
+    return find(path) != nullptr;
+}
+
+bool StaticAssets::cache(const String& path) {
+    Asset* asset = find(path);
+    if (!asset) {
+        return false;
+    }
+    if (asset->ram) {
+        return true;
+    }
+
+    File file = fs->open(asset->gzipped ? path + ".gz" : path, "r");
+    if (!file) {
+        return false;
+    }
+    size_t length = file.size();
+    if (length > MAX_CACHED_FILE || cachedBytes + length > RAM_CACHE_BUDGET) {
+        file.close();
+        return false;
+    }
+
+    std::unique_ptr<uint8_t[]> data(new (std::nothrow) uint8_t[length]);
+    if (!data || file.read(data.get(), length) != length) {
+        file.close();
+        return false;
+    }
+    file.close();
+
+    asset->ram = std::move(data);
+    asset->ramLength = length;
+    cachedBytes += length;
+    return true;
+}
+
+bool StaticAssets::canHandle(AsyncWebServerRequest* request) {
+    if (request->method() != HTTP_GET) {
+        return false;
+    }
+    return find(request->url()) != nullptr;
+}
+
+void StaticAssets::handleRequest(AsyncWebServerRequest* request) {
+    if (!send(request, request->url())) {
+        request->send(404);
+    }
+}
+
+bool StaticAssets::send(AsyncWebServerRequest* request, const String& path) {
+    Asset* asset = find(path);
+    if (!asset) {
+        return false;
+    }
+
+    bool hasEtag = !asset->etag.isEmpty();
+    bool versioned = hasEtag && request->hasParam("v") &&
+                     asset->etag == "\"" + request->getParam("v")->value() + "\"";
+    const char* cacheControl = versioned ? IMMUTABLE_CACHE : REVALIDATE_CACHE;
+
+    if (hasEtag && request->hasHeader("If-None-Match") &&
+        matchesEtag(request->header("If-None-Match"), asset->etag)) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", asset->etag);
+        response->addHeader("Cache-Control", cacheControl);
+        request->send(response);
+        return true;
+    }
+
+    AsyncWebServerResponse* response;
+    if (asset->ram) {
+        response = request->beginResponse_P(200, contentType(path), asset->ram.get(), asset->ramLength);
+        if (asset->gzipped) {
+            response->addHeader("Content-Encoding", "gzip");
+        }
+    } else if (asset->gzipped) {
+        response = request->beginResponse(*fs, path + ".gz", contentType(path));
+        response->addHeader("Content-Encoding", "gzip");
+    } else {
+        // Also picks up an unlisted <path>.gz on unstaged uploads
+        response = request->beginResponse(*fs, path, contentType(path));
+    }
+
+    if (hasEtag) {
+        response->addHeader("ETag", asset->etag);
+        response->addHeader("Cache-Control", cacheControl);
+    }
+    request->send(response);
+    return true;
+}
+
+bool StaticAssets::matchesEtag(const String& ifNoneMatch, const String& etag) {
+    if (etag.isEmpty()) {
+        return false;
+    }
+
+    int start = 0;
+    int length = ifNoneMatch.length();
+    while (start < length) {
+        int end = ifNoneMatch.indexOf(',', start);
+        if (end < 0) {
+            end = length;
+        }
+        String tag = ifNoneMatch.substring(start, end);
+        tag.trim();
+        if (tag.startsWith("W/")) {
+            tag.remove(0, 2);
+        }
+        if (tag == "*" || tag == etag) {
+            return true;
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+const char* StaticAssets::contentType(const String& path) {
+    if (path.endsWith(".html")) return "text/html";
+    if (path.endsWith(".css")) return "text/css";
+    if (path.endsWith(".js")) return "application/javascript";
+    if (path.endsWith(".json")) return "application/json";
+    if (path.endsWith(".svg")) return "image/svg+xml";
+    if (path.endsWith(".png")) return "image/png";
+    if (path.endsWith(".jpg")) return "image/jpeg";
+    if (path.endsWith(".ico")) return "image/x-icon";
+    return "text/plain";
+}
@@ -0,0 +1,101 @@
+#include "TaskProfiler.h"
+#include "MetricsSystem.h"
+#include "TaskTopology.h"
+#include <algorithm>
+
+using namespace mcp;
+
+TaskProfiler::TaskProfiler()
+    : previous(),
+      previousCount(0),
+      previousTotal(0),
+      coreMetricsRegistered(false) {
+}
+
+String TaskProfiler::metricPrefix(const char* taskName) {
+    // Task names are free-form ("async_tcp", "IDLE0", "Tmr Svc")
+    String prefix = "task.";
+    for (const char* c = taskName; *c; c++) {
+        prefix += isalnum(static_cast<unsigned char>(*c)) ? static_cast<char>(tolower(*c)) : '_';
+    }
+    return prefix;
+}
+
+bool TaskProfiler::isProfiled(const char* taskName) {
+    for (const TaskConfig* config : TaskTopology::ALL) {
+        if (strcmp(config->name, taskName) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t TaskProfiler::sample() {
+#if configUSE_TRACE_FACILITY
+    // Only the MCP task samples; keep the snapshot off its stack
+    static TaskStatus_t tasks[MAX_TASKS];
+    uint32_t total = 0;
+    UBaseType_t count = uxTaskGetSystemState(tasks, MAX_TASKS, &total);
+    MetricsSystem& metrics = MetricsSystem::getInstance();
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        if (!isProfiled(tasks[i].pcTaskName)) {
+            continue;
+        }
+        String prefix = metricPrefix(tasks[i].pcTaskName);
+        if (!metrics.hasMetric(prefix + ".stack_free")) {
+            metrics.registerGauge(prefix + ".stack_free", "Lowest free stack of the task", "bytes", "tasks");
+#if configGENERATE_RUN_TIME_STATS
+            metrics.registerGauge(prefix + ".cpu", "Share of one core used by the task", "%", "tasks");
+#endif
+        }
+        // StackType_t is a byte on ESP32, so the high-water mark is in bytes
+        metrics.setGauge(prefix + ".stack_free", tasks[i].usStackHighWaterMark * sizeof(StackType_t));
+    }
+
+#if configGENERATE_RUN_TIME_STATS
+    if (!coreMetricsRegistered) {
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            metrics.registerGauge("cpu.core" + String(core) + ".load", "Core busy time (100 - idle)", "%", "tasks");
+        }
+        coreMetricsRegistered = true;
+    }
+
+    // Shares are over the interval since the previous sample, so the first
+    // sample only establishes the baseline
+    uint32_t elapsed = total - previousTotal;
+    if (previousCount > 0 && elapsed > 0) {
+        for (UBaseType_t i = 0; i < count; i++) {
+            const Previous* before = nullptr;
+            for (size_t j = 0; j < previousCount && !before; j++) {
+                if (previous[j].taskNumber == tasks[i].xTaskNumber) {
+                    before = &previous[j];
+                }
+            }
+            if (!before) {
+                continue; // Task created since the last sample
+            }
+            float share = 100.0f * (tasks[i].ulRunTimeCounter - before->runTime) / elapsed;
+            if (isProfiled(tasks[i].pcTaskName)) {
+                metrics.setGauge(metricPrefix(tasks[i].pcTaskName) + ".cpu", share);
+            }
+
+            for (int core = 0; core < portNUM_PROCESSORS; core++) {
+                if (tasks[i].xHandle == xTaskGetIdleTaskHandleForCPU(core)) {
+                    metrics.setGauge("cpu.core" + String(core) + ".load", std::max(0.0f, 100.0f - share));
+                }
+            }
+        }
+    }
+
+    previousCount = count;
+    for (UBaseType_t i = 0; i < count; i++) {
+        previous[i] = Previous{tasks[i].xTaskNumber, tasks[i].ulRunTimeCounter};
+    }
+    previousTotal = total;
+#endif
+    return count;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,257 @@
+#include "TcpTransport.h"
+#include "MCPServer.h"
+#include "FrameParser.h"
+#include "RequestTracer.h"
+#include "Log.h"
+#include <algorithm>
+
+using namespace mcp;
+
+TcpTransport::TcpTransport(uint16_t port)
+    : port(port),
+      nextId(1),
+      listener(nullptr) {
+    for (auto& conn : connections) {
+        conn.id = 0;
+        conn.client = nullptr;
+        conn.overflow = false;
+    }
+}
+
+TcpTransport::~TcpTransport() {
+    delete listener;
+}
+
+TcpTransport::Connection* TcpTransport::find(uint32_t id) {
+    for (auto& conn : connections) {
+        if (conn.id == id && id != 0) {
+            return &conn;
+        }
+    }
+    return nullptr;
+}
+
+TcpTransport::Connection* TcpTransport::allocate() {
+    for (auto& conn : connections) {
+        if (conn.id == 0) {
+            conn.id = nextId++;
+            if (nextId == 0) {
+                nextId = 1;
+            }
+            conn.line = PooledBuffer();
+            conn.overflow = false;
+            return &conn;
+        }
+    }
+    return nullptr;
+}
+
+void TcpTransport::release(uint32_t id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Connection* conn = find(id);
+        if (!conn) {
+            return;
+        }
+        conn->id = 0;
+        conn->client = nullptr;
+        conn->line = PooledBuffer();
+        conn->pending = PooledBuffer();
+    }
+    server->onDisconnect(this, id);
+}
+
+bool TcpTransport::enqueue(Connection& conn, const char* data, size_t len) {
+    size_t needed = conn.pending.length() + len;
+    if (needed > MAX_PENDING) {
+        return false;
+    }
+    if (needed > conn.pending.capacity() &&
+        !conn.pending.reserve(std::min(std::max(needed, 2 * conn.pending.capacity()), MAX_PENDING))) {
+        return false;
+    }
+    return conn.pending.append(data, len);
+}
+
+bool TcpTransport::write(Connection& conn, const char* data, size_t len) {
+    // Nothing new goes on the wire ahead of queued output
+    if (conn.pending.length() > 0) {
+        size_t flushed = 0;
+        if (!writeSome(conn, conn.pending.data(), conn.pending.length(), flushed)) {
+            return false;
+        }
+        conn.pending.consume(flushed);
+    }
+
+    size_t written = 0;
+    if (conn.pending.length() == 0 && !writeSome(conn, data, len, written)) {
+        return false;
+    }
+    return written == len || enqueue(conn, data + written, len - written);
+}
+
+bool TcpTransport::send(uint32_t connectionId, const char* data, size_t len) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Connection* conn = find(connectionId);
+        if (!conn) {
+            return false;
+        }
+        if (write(*conn, data, len) && write(*conn, "\n", 1)) {
+            return true;
+        }
+    }
+
+    // A frame that can be neither sent nor queued would leave a gap in the
+    // stream, so the peer is dropped instead
+    MCP_LOGW("TCP connection %u failed or fell too far behind, closing", static_cast<unsigned>(connectionId));
+    close(connectionId);
+    return false;
+}
+
+void TcpTransport::onBytes(uint32_t id, const uint8_t* data, size_t len) {
+    // Only the reading context touches the line buffer, so no lock is held
+    // while frames are handed to the server (which may call send()).
+    Connection* conn = find(id);
+    if (!conn) {
+        return;
+    }
+
+    while (len > 0) {
+        const uint8_t* newline = static_cast<const uint8_t*>(memchr(data, '\n', len));
+        size_t chunk = newline ? static_cast<size_t>(newline - data) : len;
+
+        if (!conn->overflow) {
+            if (newline && conn->line.length() == 0) {
+                // Common case: a whole line inside one segment, no copy
+                size_t lineLen = chunk;
+                if (lineLen > 0 && data[lineLen - 1] == '\r') {
+                    lineLen--;
+                }
+                if (lineLen > 0) {
+                    server->onMessage(this, id, data, lineLen);
+                }
+            } else {
+                if (!conn->line.valid()) {
+                    conn->line = PooledBuffer(FrameParser::MAX_FRAME_SIZE);
+                }
+                if (!conn->line.append(data, chunk)) {
+                    conn->overflow = true;
+                    conn->line.clear();
+                    RequestTracer::getInstance().recordError();
+                } else if (newline) {
+                    size_t lineLen = conn->line.length();
+                    if (lineLen > 0 && conn->line.data()[lineLen - 1] == '\r') {
+                        lineLen--;
+                    }
+                    if (lineLen > 0) {
+                        server->onMessage(this, id, reinterpret_cast<const uint8_t*>(conn->line.data()), lineLen);
+                    }
+                    conn->line.clear();
+                }
+            }
+        }
+
+        if (!newline) {
+            break;
+        }
+        conn->overflow = false;
+        data += chunk + 1;
+        len -= chunk + 1;
+    }
+}
+
+bool TcpTransport::begin() {
+    if (listener) {
+        return true;
+    }
+
+    listener = new AsyncServer(port);
+    listener->onClient([](void* arg, AsyncClient* client) {
+        static_cast<TcpTransport*>(arg)->onClient(client);
+    }, this);
+    listener->setNoDelay(true);
+    listener->begin();
+    return true;
+}
+
+void TcpTransport::poll() {
+    // AsyncTCP delivers data on its own task; nothing to service here
+}
+
+void TcpTransport::onClient(AsyncClient* client) {
+    uint32_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Connection* conn = allocate();
+        if (conn) {
+            conn->client = client;
+            id = conn->id;
+        }
+    }
+
+    if (id == 0 || server->onConnect(this, id) < 0) {
+        if (id != 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            Connection* conn = find(id);
+            conn->id = 0;
+            conn->client = nullptr;
+        }
+        client->close(true);
+        delete client;
+        return;
+    }
+
+    client->onData([this, id](void* arg, AsyncClient* c, void* data, size_t len) {
+        this->onBytes(id, static_cast<const uint8_t*>(data), len);
+    });
+    client->onAck([this, id](void* arg, AsyncClient* c, size_t len, uint32_t time) {
+        this->onAck(id);
+    });
+    client->onDisconnect([this, id](void* arg, AsyncClient* c) {
+        this->release(id);
+        delete c;
+    });
+}
+
+void TcpTransport::onAck(uint32_t id) {
+    // Acknowledged data frees send buffer space for queued output
+    std::lock_guard<std::mutex> lock(mutex);
+    Connection* conn = find(id);
+    if (!conn || conn->pending.length() == 0) {
+        return;
+    }
+    size_t flushed = 0;
+    if (writeSome(*conn, conn->pending.data(), conn->pending.length(), flushed)) {
+        conn->pending.consume(flushed);
+    }
+}
+
+bool TcpTransport::writeSome(Connection& conn, const char* data, size_t len, size_t& written) {
+    written = 0;
+    if (!conn.client || !conn.client->connected()) {
+        return false;
+    }
+    size_t room = std::min(len, conn.client->space());
+    if (room > 0) {
+        written = conn.client->add(data, room);
+        conn.client->send();
+    }
+    return true;
+}
+
+void TcpTransport::close(uint32_t connectionId) {
+    AsyncClient* client = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Connection* conn = find(connectionId);
+        if (conn) {
+            client = conn->client;
+        }
+    }
+    if (client) {
+        // Not under the lock: AsyncClient::close() runs the onDisconnect
+        // callback synchronously, and that releases the slot
+        client->close();
+    }
+}
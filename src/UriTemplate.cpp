@@ -0,0 +1,162 @@
+#include "UriTemplate.h"
+#include <algorithm>
+
+using namespace mcp;
+
+namespace {
+
+enum class SegmentKind : uint8_t {
+    LITERAL,
+    INTEGER,
+    TEXT
+};
+
+struct Segment {
+    SegmentKind kind;
+    std::string text;  // Literal text or variable name
+};
+
+bool parseSegment(const std::string &segment, Segment &parsed) {
+    if (segment.empty() || segment.front() != '{') {
+        // Variables must fill a whole segment
+        parsed = {SegmentKind::LITERAL, segment};
+        return segment.find_first_of("{}") == std::string::npos;
+    }
+    if (segment.back() != '}') {
+        return false;
+    }
+
+    std::string body = segment.substr(1, segment.size() - 2);
+    size_t colon = body.find(':');
+    std::string name = body.substr(0, colon);
+    std::string type = colon == std::string::npos ? "" : body.substr(colon + 1);
+    if (name.empty() || name.find_first_of("{}") != std::string::npos) {
+        return false;
+    }
+    if (type == "int") {
+        parsed = {SegmentKind::INTEGER, name};
+    } else if (type.empty()) {
+        parsed = {SegmentKind::TEXT, name};
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool isInteger(std::string_view text) {
+    return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+} // namespace
+
+int UriTemplateMatcher::add(const std::string &pattern) {
+    for (size_t i = 0; i < templates.size(); i++) {
+        if (templates[i].pattern == pattern) {
+            return static_cast<int>(i);
+        }
+    }
+
+    // Parse completely first, so a malformed pattern leaves the trie untouched
+    std::vector<Segment> segments;
+    std::vector<std::string> names;
+    size_t start = 0;
+    while (true) {
+        size_t end = pattern.find('/', start);
+        Segment segment;
+        if (!parseSegment(pattern.substr(start, end == std::string::npos ? std::string::npos : end - start),
+                          segment)) {
+            return NO_MATCH;
+        }
+        if (segment.kind != SegmentKind::LITERAL) {
+            if (std::find(names.begin(), names.end(), segment.text) != names.end()) {
+                return NO_MATCH;
+            }
+            names.push_back(segment.text);
+        }
+        segments.push_back(std::move(segment));
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    int32_t node = 0;
+    for (const Segment &segment : segments) {
+        int32_t next = NONE;
+        if (segment.kind == SegmentKind::LITERAL) {
+            auto it = nodes[node].literals.find(segment.text);
+            next = it != nodes[node].literals.end() ? it->second : NONE;
+        } else {
+            next = segment.kind == SegmentKind::INTEGER ? nodes[node].integer : nodes[node].text;
+        }
+
+        if (next == NONE) {
+            next = static_cast<int32_t>(nodes.size());
+            nodes.emplace_back(); // Invalidates references into nodes
+            if (segment.kind == SegmentKind::LITERAL) {
+                nodes[node].literals.emplace(segment.text, next);
+            } else if (segment.kind == SegmentKind::INTEGER) {
+                nodes[node].integer = next;
+            } else {
+                nodes[node].text = next;
+            }
+        }
+        node = next;
+    }
+
+    // Same shape as an existing template under other variable names
+    if (nodes[node].templateId != NONE) {
+        return NO_MATCH;
+    }
+    nodes[node].templateId = static_cast<int32_t>(templates.size());
+    templates.push_back(Template{pattern, std::move(names)});
+    return nodes[node].templateId;
+}
+
+int UriTemplateMatcher::match(const std::string &uri, UriParams &params) const {
+    std::vector<std::string> values;
+    int32_t found = NONE;
+    if (!walk(0, uri, 0, values, found)) {
+        return NO_MATCH;
+    }
+
+    const Template &matched = templates[found];
+    params.clear();
+    for (size_t i = 0; i < values.size(); i++) {
+        params[matched.names[i]] = std::move(values[i]);
+    }
+    return found;
+}
+
+bool UriTemplateMatcher::walk(int32_t node, std::string_view uri, size_t pos, std::vector<std::string> &values,
+                              int32_t &found) const {
+    size_t end = uri.find('/', pos);
+    std::string_view segment = uri.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos);
+
+    auto descend = [&](int32_t next) {
+        if (end == std::string_view::npos) {
+            found = nodes[next].templateId;
+            return found != NONE;
+        }
+        return walk(next, uri, end + 1, values, found);
+    };
+
+    // Most specific first: literal, then {name:int}, then {name}
+    const Node &current = nodes[node];
+    auto literal = current.literals.find(segment);
+    if (literal != current.literals.end() && descend(literal->second)) {
+        return true;
+    }
+    int32_t captures[] = {isInteger(segment) ? current.integer : NONE, segment.empty() ? NONE : current.text};
+    for (int32_t next : captures) {
+        if (next == NONE) {
+            continue;
+        }
+        values.emplace_back(segment);
+        if (descend(next)) {
+            return true;
+        }
+        values.pop_back();
+    }
+    return false;
+}
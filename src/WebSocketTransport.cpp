@@ -0,0 +1,132 @@
+#include "WebSocketTransport.h"
+#include "MCPServer.h"
+#include "FrameParser.h"
+#include "RequestTracer.h"
+#include "Log.h"
+
+using namespace mcp;
+
+WebSocketTransport::WebSocketTransport(AsyncWebSocket& ws) : ws(ws), lastCleanup(0) {}
+
+bool WebSocketTransport::begin() {
+    ws.onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client,
+                      AwsEventType type, void* arg, uint8_t* data, size_t len) {
+        this->onEvent(client, type, arg, data, len);
+    });
+    return true;
+}
+
+void WebSocketTransport::poll() {
+    // Reap closed sockets and cap the list, so refused and evicted clients
+    // do not keep holding TCP buffers
+    if (millis() - lastCleanup >= CLEANUP_INTERVAL) {
+        ws.cleanupClients(MCPServer::MAX_CLIENTS);
+        lastCleanup = millis();
+    }
+}
+
+bool WebSocketTransport::send(uint32_t connectionId, const char* data, size_t len) {
+    AsyncWebSocketClient* client = ws.client(connectionId);
+    if (!client || client->status() != WS_CONNECTED || !client->canSend()) {
+        return false;
+    }
+    client->text(data, len);
+    return true;
+}
+
+bool WebSocketTransport::sendBinary(uint32_t connectionId, const uint8_t* data, size_t len) {
+    AsyncWebSocketClient* client = ws.client(connectionId);
+    if (!client || client->status() != WS_CONNECTED || !client->canSend()) {
+        return false;
+    }
+    client->binary(data, len);
+    return true;
+}
+
+bool WebSocketTransport::ping(uint32_t connectionId, const uint8_t* payload, size_t len) {
+    AsyncWebSocketClient* client = ws.client(connectionId);
+    if (!client || client->status() != WS_CONNECTED) {
+        return false;
+    }
+    // Control frames bypass the message queue, so pings still go out when
+    // the peer has stopped reading
+    client->ping(const_cast<uint8_t*>(payload), len);
+    return true;
+}
+
+void WebSocketTransport::close(uint32_t connectionId) {
+    ws.close(connectionId);
+}
+
+void WebSocketTransport::abort(uint32_t connectionId) {
+    AsyncWebSocketClient* client = ws.client(connectionId);
+    if (client && client->client()) {
+        // Frees the TCP buffers now; WS_EVT_DISCONNECT follows
+        client->client()->abort();
+    }
+}
+
+void WebSocketTransport::onEvent(AsyncWebSocketClient* client, AwsEventType type,
+                                 void* arg, uint8_t* data, size_t len) {
+    switch (type) {
+        case WS_EVT_CONNECT:
+            MCP_LOGD("WebSocket client %u connected", client->id());
+            if (server->onConnect(this, client->id()) < 0) {
+                client->close();
+            }
+            break;
+        case WS_EVT_DISCONNECT:
+            MCP_LOGD("WebSocket client %u disconnected", client->id());
+            partialFrames.erase(client->id());
+            server->onDisconnect(this, client->id());
+            break;
+        case WS_EVT_PONG:
+            server->onPong(this, client->id(), data, len);
+            break;
+        case WS_EVT_ERROR:
+            MCP_LOGW("WebSocket error on client %u", client->id());
+            break;
+        case WS_EVT_DATA:
+            if (len > 0) {
+                onData(client, static_cast<AwsFrameInfo*>(arg), data, len);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void WebSocketTransport::onData(AsyncWebSocketClient* client, AwsFrameInfo* info,
+                                uint8_t* data, size_t len) {
+    // Whole frames are parsed in place from the receive buffer;
+    // frames split across TCP packets are reassembled first.
+    Encoding encoding = info->opcode == WS_BINARY ? Encoding::MSGPACK : Encoding::JSON;
+    if (info->index == 0 && info->len == len) {
+        server->onMessage(this, client->id(), data, len, encoding);
+        return;
+    }
+
+    if (info->num != 0 || info->len > FrameParser::MAX_FRAME_SIZE) {
+        MCP_LOGW("Frame too large or fragmented - dropped");
+        partialFrames.erase(client->id());
+        RequestTracer::getInstance().recordError();
+        return;
+    }
+
+    PooledBuffer& partial = partialFrames[client->id()];
+    if (info->index == 0) {
+        partial = PooledBuffer(info->len);
+    }
+    if (!partial.append(data, len)) {
+        partialFrames.erase(client->id());
+        RequestTracer::getInstance().recordError();
+        return;
+    }
+    if (info->index + len < info->len) {
+        return;
+    }
+
+    server->onMessage(this, client->id(), reinterpret_cast<const uint8_t*>(partial.data()), partial.length(),
+                      encoding);
+    partialFrames.erase(client->id());
+}
@@ -2,72 +2,160 @@
 #include <LittleFS.h>
 #include "NetworkManager.h"
 #include "MCPServer.h"
+#include "MetricsSystem.h"
+#include "MemoryPool.h"
+#include "WebSocketTransport.h"
+#include "TcpTransport.h"
+#include "HttpTransport.h"
+#include "Log.h"
+#include "TaskTopology.h"
+#include "TaskProfiler.h"
 
 using namespace mcp;
 // Global instances
 NetworkManager networkManager;
 MCPServer mcpServer;
 
+// MCP transports; all feed mcpServer's dispatcher
+WebSocketTransport wsTransport(networkManager.getWebSocket());
+TcpTransport tcpTransport(mcpServer.getPort());
+HttpTransport httpTransport(networkManager.getWebServer());
+
+static const uint8_t LED_PIN = 2;
+
 // Task handles
 TaskHandle_t mcpTaskHandle = nullptr;
 
+static const uint32_t METRICS_UPDATE_INTERVAL = 1000; // 1 second
+static const uint32_t METRICS_PERSIST_INTERVAL = 300000; // 5 minutes; bounds flash wear
+static const uint32_t METRICS_STREAM_INTERVAL = 1000;  // Dashboard SSE delta rate
+
 // MCP task function
 void mcpTask(void* parameter) {
+    uint32_t lastMetricsUpdate = 0;
+    uint32_t lastMetricsPersist = millis();
+    uint32_t lastProfile = 0;
     while (true) {
         mcpServer.handleClient();
+
+        // Keep system gauges fresh for /metrics and /api/stats scrapes
+        if (millis() - lastMetricsUpdate >= METRICS_UPDATE_INTERVAL) {
+            MetricsSystem::getInstance().updateSystemMetrics();
+            MetricsSystem::getInstance().summarizeHistory();
+            MemoryPool::getInstance().publishMetrics();
+            lastMetricsUpdate = millis();
+        }
+        if (millis() - lastMetricsPersist >= METRICS_PERSIST_INTERVAL) {
+            MetricsSystem::getInstance().persist();
+            lastMetricsPersist = millis();
+        }
+        if (millis() - lastProfile >= TaskProfiler::SAMPLE_INTERVAL) {
+            TaskProfiler::getInstance().sample();
+            lastProfile = millis();
+        }
+        networkManager.getMetricsStream().poll();
         vTaskDelay(pdMS_TO_TICKS(10));
     }
 }
 
 void setup() {
     Serial.begin(115200);
-    Serial.println("\n\n=== ESP32 MCP Server Starting ===");
-    Serial.println("Initializing...");
-    pinMode(2, OUTPUT);
-    digitalWrite(2, LOW);
+    // Log statements only queue records; this task writes them to Serial
+    Log::getInstance().begin(&Serial);
+    MCP_LOGI("=== ESP32 MCP Server Starting ===");
+    pinMode(LED_PIN, OUTPUT);
+    digitalWrite(LED_PIN, LOW);
     // Initialize LittleFS
     if (LittleFS.begin()) {
-        Serial.println("LittleFS mounted successfully");
+        MCP_LOGI("LittleFS mounted successfully");
     } else {
-        Serial.println("LittleFS mount failed!");
+        MCP_LOGE("LittleFS mount failed!");
+    }
+
+    // Initialize metrics before any subsystem starts recording
+    if (!MetricsSystem::getInstance().begin()) {
+        MCP_LOGE("Metrics system init failed!");
     }
 
     // Initialize network
-    Serial.println("Starting network manager...");
+    MCP_LOGI("Starting network manager...");
+    networkManager.getMetricsStream().setInterval(METRICS_STREAM_INTERVAL);
     networkManager.begin();
 
     // Wait for network connection
-    Serial.println("Waiting for network connection...");
+    MCP_LOGI("Waiting for network connection...");
     while (!networkManager.isConnected()) {
         delay(100);
     }
 
-    Serial.println("\n=== Network Status ===");
-    Serial.print("Connected to: ");
-    Serial.println(networkManager.getSSID());
-    Serial.print("IP Address: ");
-    Serial.println(networkManager.getIPAddress());
-    Serial.println("=====================\n");
+    MCP_LOGI("Connected to: %s, IP Address: %s", networkManager.getSSID().c_str(),
+             networkManager.getIPAddress().c_str());
+
+    // Register onboard LED as a resource and a tool
+    mcpServer.registerResource(MCPResource("LED", "led://status", "boolean", "false", []() {
+        return std::string(digitalRead(LED_PIN) == HIGH ? "true" : "false");
+    }));
+    mcpServer.registerTool(MCPTool{
+        "led_control",
+        "控制ESP32板载LED的开关",
+        R"({"type":"object","properties":{"on":{"type":"boolean","description":"true为打开LED，false为关闭LED"}},"required":["on"]})",
+        [](JsonObjectConst arguments, std::string &text) {
+            if (!arguments["on"].is<bool>()) {
+                text = "参数错误，缺少on字段";
+                return false;
+            }
+            bool on = arguments["on"].as<bool>();
+            digitalWrite(LED_PIN, on ? HIGH : LOW);
+            // Subscribers learn about the change without polling
+            mcpServer.setResourceValue("led://status", on ? "true" : "false");
+            text = on ? "LED已打开" : "LED已关闭";
+            return true;
+        }
+    });
+
+    // The metrics history log (up to 1 MB), read in base64 chunks
+    MCPResource history("Metrics history", "file:///metrics.log", "application/octet-stream", "");
+    history.blob.size = []() {
+        return MetricsSystem::getInstance().getHistorySize();
+    };
+    history.blob.read = [](size_t offset, uint8_t *buffer, size_t len) {
+        return MetricsSystem::getInstance().readHistory(offset, buffer, len);
+    };
+    mcpServer.registerResource(history);
+
+    // Any GPIO's input level, e.g. gpio://4/level
+    mcpServer.registerResourceTemplate(MCPResourceTemplate{
+        "GPIO level",
+        "gpio://{pin:int}/level",
+        "boolean",
+        "Input level of a GPIO pin",
+        [](const UriParams &params, std::string &text) {
+            int pin = atoi(params.at("pin").c_str());
+            if (!GPIO_IS_VALID_GPIO(pin)) {
+                return false;
+            }
+            text = digitalRead(pin) == HIGH ? "true" : "false";
+            return true;
+        }
+    });
 
     // Start MCP server
-    Serial.println("Starting MCP server...");
+    MCP_LOGI("Starting MCP server...");
+    mcpServer.addTransport(&wsTransport);
+    mcpServer.addTransport(&tcpTransport);
+    mcpServer.addTransport(&httpTransport);
     mcpServer.begin(networkManager.isConnected());
 
     // Create MCP task
-    Serial.println("Creating MCP task...");
-    xTaskCreatePinnedToCore(
-        mcpTask,
-        "MCPTask",
-        8192,
-        nullptr,
-        1,
-        &mcpTaskHandle,
-        1  // Run on core 1
-    );
-    Serial.println("Setup complete!");
+    MCP_LOGD("Creating MCP task...");
+    if (!TaskTopology::start(TaskTopology::MCP, mcpTask, nullptr, &mcpTaskHandle)) {
+        MCP_LOGE("Failed to create MCP task!");
+    }
+    MCP_LOGI("Setup complete!");
 }
 
 void loop() {
-    // Handle MCP server
-    mcpServer.handleClient();
+    // All work runs in the tasks laid out in TaskTopology.h; calling
+    // handleClient() here too would race MCPTask over the same queue
+    vTaskDelete(nullptr);
 }
\ No newline at end of file
@@ -182,6 +182,34 @@ bool uLogger::compact(uint64_t maxAge) {
     return true;
 }
 
+size_t uLogger::getFileSize() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!initialized || !openLog("r")) {
+        return 0;
+    }
+
+    size_t size = logFile.size();
+    closeLog();
+    return size;
+}
+
+size_t uLogger::readRaw(size_t offset, uint8_t* buffer, size_t len) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!initialized || !buffer || !openLog("r")) {
+        return 0;
+    }
+
+    size_t count = 0;
+    if (logFile.seek(offset)) {
+        count = logFile.read(buffer, len);
+    }
+
+    closeLog();
+    return count;
+}
+
 bool uLogger::openLog(const char* mode) {
     if (logFile) {
         return true;
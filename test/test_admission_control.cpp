@@ -0,0 +1,145 @@
+#include <unity.h>
+#include "AdmissionControl.h"
+
+using namespace mcp;
+
+static const uint32_t PLENTY_OF_HEAP = 100000;
+
+static AdmissionControl::Config testConfig() {
+    AdmissionControl::Config config = AdmissionControl::DEFAULT_CONFIG;
+    config.maxClients = 2;
+    config.messagesPerSecond = 10;
+    config.burst = 3;
+    config.idleTimeout = 1000;
+    config.minFreeHeap = 40000;
+    config.criticalFreeHeap = 20000;
+    return config;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_rejects_connections_when_full() {
+    AdmissionControl admission(testConfig());
+
+    TEST_ASSERT_TRUE(admission.admitConnection(0, PLENTY_OF_HEAP) == AdmissionControl::Verdict::ADMIT);
+    TEST_ASSERT_TRUE(admission.admitConnection(1, PLENTY_OF_HEAP) == AdmissionControl::Verdict::ADMIT);
+    TEST_ASSERT_TRUE(admission.admitConnection(2, PLENTY_OF_HEAP) == AdmissionControl::Verdict::REJECT_FULL);
+}
+
+void test_sheds_connections_on_low_heap() {
+    AdmissionControl admission(testConfig());
+
+    TEST_ASSERT_TRUE(admission.admitConnection(0, 30000) == AdmissionControl::Verdict::REJECT_LOW_HEAP);
+}
+
+void test_max_clients_is_capped_to_slots() {
+    AdmissionControl::Config config = testConfig();
+    config.maxClients = 200;
+    AdmissionControl admission(config);
+
+    TEST_ASSERT_EQUAL(AdmissionControl::MAX_SLOTS, admission.getConfig().maxClients);
+}
+
+void test_token_bucket_allows_burst_then_limits() {
+    AdmissionControl admission(testConfig());
+    admission.opened(0, 0);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(admission.admitMessage(0, 0, PLENTY_OF_HEAP) == AdmissionControl::Verdict::ADMIT);
+    }
+    TEST_ASSERT_TRUE(admission.admitMessage(0, 0, PLENTY_OF_HEAP) == AdmissionControl::Verdict::REJECT_RATE);
+}
+
+void test_token_bucket_refills_over_time() {
+    AdmissionControl admission(testConfig());
+    admission.opened(0, 0);
+    for (int i = 0; i < 3; i++) {
+        admission.admitMessage(0, 0, PLENTY_OF_HEAP);
+    }
+
+    // 10 msg/s: one token every 100 ms
+    TEST_ASSERT_TRUE(admission.admitMessage(0, 50, PLENTY_OF_HEAP) == AdmissionControl::Verdict::REJECT_RATE);
+    TEST_ASSERT_TRUE(admission.admitMessage(0, 100, PLENTY_OF_HEAP) == AdmissionControl::Verdict::ADMIT);
+
+    // Refill never exceeds the burst size
+    uint32_t later = 60000;
+    int admitted = 0;
+    while (admission.admitMessage(0, later, PLENTY_OF_HEAP) == AdmissionControl::Verdict::ADMIT) {
+        admitted++;
+    }
+    TEST_ASSERT_EQUAL(3, admitted);
+}
+
+void test_buckets_are_per_client() {
+    AdmissionControl admission(testConfig());
+    admission.opened(0, 0);
+    admission.opened(1, 0);
+    for (int i = 0; i < 3; i++) {
+        admission.admitMessage(0, 0, PLENTY_OF_HEAP);
+    }
+
+    TEST_ASSERT_TRUE(admission.admitMessage(0, 0, PLENTY_OF_HEAP) == AdmissionControl::Verdict::REJECT_RATE);
+    TEST_ASSERT_TRUE(admission.admitMessage(1, 0, PLENTY_OF_HEAP) == AdmissionControl::Verdict::ADMIT);
+}
+
+void test_sheds_messages_on_critical_heap() {
+    AdmissionControl admission(testConfig());
+    admission.opened(0, 0);
+
+    TEST_ASSERT_TRUE(admission.admitMessage(0, 0, 10000) == AdmissionControl::Verdict::REJECT_LOW_HEAP);
+}
+
+void test_idle_detection() {
+    AdmissionControl admission(testConfig());
+    admission.opened(0, 0);
+
+    TEST_ASSERT_FALSE(admission.isIdle(0, 999));
+    TEST_ASSERT_TRUE(admission.isIdle(0, 1000));
+
+    // Any message, even a rejected one, counts as activity
+    admission.admitMessage(0, 1500, 10000);
+    TEST_ASSERT_FALSE(admission.isIdle(0, 2000));
+}
+
+void test_idle_timeout_disabled() {
+    AdmissionControl::Config config = testConfig();
+    config.idleTimeout = 0;
+    AdmissionControl admission(config);
+    admission.opened(0, 0);
+
+    TEST_ASSERT_FALSE(admission.isIdle(0, 0xFFFFFFF0));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_rejects_connections_when_full);
+    RUN_TEST(test_sheds_connections_on_low_heap);
+    RUN_TEST(test_max_clients_is_capped_to_slots);
+    RUN_TEST(test_token_bucket_allows_burst_then_limits);
+    RUN_TEST(test_token_bucket_refills_over_time);
+    RUN_TEST(test_buckets_are_per_client);
+    RUN_TEST(test_sheds_messages_on_critical_heap);
+    RUN_TEST(test_idle_detection);
+    RUN_TEST(test_idle_timeout_disabled);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,92 @@
+#include <unity.h>
+#include <string>
+#include "Base64.h"
+
+using namespace mcp;
+
+static std::string encodeInPieces(const std::string &input, size_t piece) {
+    Base64Encoder encoder;
+    std::string text;
+    char out[64];
+    for (size_t pos = 0; pos < input.size(); pos += piece) {
+        size_t len = input.size() - pos < piece ? input.size() - pos : piece;
+        size_t n = encoder.update(reinterpret_cast<const uint8_t *>(input.data() + pos), len, out);
+        text.append(out, n);
+    }
+    size_t n = encoder.finish(out);
+    text.append(out, n);
+    return text;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_rfc4648_vectors() {
+    TEST_ASSERT_EQUAL_STRING("", encodeInPieces("", 16).c_str());
+    TEST_ASSERT_EQUAL_STRING("Zg==", encodeInPieces("f", 16).c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm8=", encodeInPieces("fo", 16).c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm9v", encodeInPieces("foo", 16).c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm9vYg==", encodeInPieces("foob", 16).c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm9vYmE=", encodeInPieces("fooba", 16).c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm9vYmFy", encodeInPieces("foobar", 16).c_str());
+}
+
+void test_all_byte_values() {
+    std::string input;
+    for (int i = 0; i < 256; i++) {
+        input += static_cast<char>(i);
+    }
+    std::string text = encodeInPieces(input, 16);
+
+    TEST_ASSERT_EQUAL(Base64Encoder::encodedLength(256), text.size());
+    TEST_ASSERT_EQUAL_STRING("AAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGxwdHh8g", text.substr(0, 44).c_str());
+    TEST_ASSERT_EQUAL_STRING("8PHy8/T19vf4+fr7/P3+/w==", text.substr(text.size() - 24).c_str());
+}
+
+void test_piece_size_does_not_change_output() {
+    std::string input;
+    for (int i = 0; i < 100; i++) {
+        input += static_cast<char>(i * 37 + 11);
+    }
+    std::string whole = encodeInPieces(input, 16);
+
+    for (size_t piece = 1; piece <= 7; piece++) {
+        TEST_ASSERT_EQUAL_STRING(whole.c_str(), encodeInPieces(input, piece).c_str());
+    }
+}
+
+void test_encoded_length() {
+    TEST_ASSERT_EQUAL(0, Base64Encoder::encodedLength(0));
+    TEST_ASSERT_EQUAL(4, Base64Encoder::encodedLength(1));
+    TEST_ASSERT_EQUAL(4, Base64Encoder::encodedLength(3));
+    TEST_ASSERT_EQUAL(8, Base64Encoder::encodedLength(4));
+    TEST_ASSERT_EQUAL(4096, Base64Encoder::encodedLength(3072));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_rfc4648_vectors);
+    RUN_TEST(test_all_byte_values);
+    RUN_TEST(test_piece_size_does_not_change_output);
+    RUN_TEST(test_encoded_length);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
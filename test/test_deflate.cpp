@@ -0,0 +1,212 @@
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include "Deflate.h"
+
+using namespace mcp;
+
+static Deflate deflater;
+static uint8_t compressed[8192];
+
+// Minimal inflater for single fixed-Huffman blocks, enough to check the encoder;
+// malformed input yields a "<...>" marker that no test expects
+struct BitReader {
+    const uint8_t* data;
+    size_t len;
+    size_t bit;
+
+    uint32_t bits(uint8_t count) {
+        uint32_t value = 0;
+        for (uint8_t i = 0; i < count; i++, bit++) {
+            if (bit / 8 < len) {
+                value |= ((data[bit / 8] >> (bit % 8)) & 1u) << i;
+            }
+        }
+        return value;
+    }
+
+    uint32_t code(uint8_t count) {
+        uint32_t value = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            value = (value << 1) | bits(1);
+        }
+        return value;
+    }
+};
+
+static int decodeSymbol(BitReader& reader) {
+    uint32_t code = reader.code(7);
+    if (code <= 0x17) {
+        return 256 + code;
+    }
+    code = (code << 1) | reader.bits(1);
+    if (code >= 0x30 && code <= 0xBF) {
+        return code - 0x30;
+    }
+    if (code >= 0xC0 && code <= 0xC7) {
+        return 280 + (code - 0xC0);
+    }
+    code = (code << 1) | reader.bits(1);
+    return 144 + (code - 0x190);
+}
+
+static std::string inflate(const uint8_t* data, size_t len) {
+    static const uint16_t lengthBase[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                          35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const uint8_t lengthExtra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                          3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const uint16_t distanceBase[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                            8193, 12289, 16385, 24577};
+    static const uint8_t distanceExtra[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    BitReader reader{data, len, 0};
+    std::string result;
+    if (reader.bits(1) != 1 || reader.bits(2) != 1) {
+        return "<not a final fixed-Huffman block>";
+    }
+    while (reader.bit / 8 < len) {
+        int symbol = decodeSymbol(reader);
+        if (symbol < 256) {
+            result += static_cast<char>(symbol);
+        } else if (symbol == 256) {
+            return result;
+        } else {
+            int index = symbol - 257;
+            size_t length = lengthBase[index] + reader.bits(lengthExtra[index]);
+            int distanceCode = reader.code(5);
+            size_t distance = distanceBase[distanceCode] + reader.bits(distanceExtra[distanceCode]);
+            if (distance > result.size()) {
+                return "<distance before start>";
+            }
+            for (size_t i = 0; i < length; i++) {
+                result += result[result.size() - distance];
+            }
+        }
+    }
+    return "<missing end of block>";
+}
+
+static size_t compress(const std::string& text) {
+    return deflater.compress(reinterpret_cast<const uint8_t*>(text.data()), text.size(),
+                             compressed, sizeof(compressed));
+}
+
+static std::string toolsList(int count) {
+    std::string json = "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":{\"tools\":[";
+    for (int i = 0; i < count; i++) {
+        json += i ? "," : "";
+        json += "{\"name\":\"tool_" + std::to_string(i) + "\",\"description\":\"Reads sensor channel " +
+                std::to_string(i) + "\",\"inputSchema\":{\"type\":\"object\",\"properties\":{}}}";
+    }
+    return json + "]}}";
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_empty_input_is_a_valid_block() {
+    size_t len = compress("");
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_EQUAL_STRING("", inflate(compressed, len).c_str());
+}
+
+void test_known_encoding() {
+    // zlib.compressobj(wbits=-15) output for "a": 4b 04 00
+    size_t len = compress("a");
+    TEST_ASSERT_EQUAL(3, len);
+    TEST_ASSERT_EQUAL_HEX8(0x4B, compressed[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, compressed[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, compressed[2]);
+}
+
+void test_roundtrip_json() {
+    std::string json = toolsList(20);
+    size_t len = compress(json);
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_EQUAL_STRING(json.c_str(), inflate(compressed, len).c_str());
+    // Repetitive JSON should shrink to well under half
+    TEST_ASSERT_TRUE(len * 2 < json.size());
+}
+
+void test_roundtrip_long_runs_and_high_bytes() {
+    std::string data(1000, 'x');
+    for (int i = 0; i < 256; i++) {
+        data += static_cast<char>(i);
+    }
+    data += std::string(300, '\xff');
+    size_t len = compress(data);
+    TEST_ASSERT_TRUE(len > 0);
+    std::string back = inflate(compressed, len);
+    TEST_ASSERT_EQUAL(data.size(), back.size());
+    TEST_ASSERT_EQUAL_MEMORY(data.data(), back.data(), data.size());
+}
+
+void test_matches_stay_inside_window() {
+    // The repeat is further back than the window, so it cannot be referenced
+    std::string block;
+    for (size_t i = 0; i < 64; i++) {
+        block += static_cast<char>('A' + (i * 7) % 26);
+    }
+    std::string filler;
+    unsigned seed = 1;
+    while (filler.size() < Deflate::WINDOW_SIZE + 64) {
+        seed = seed * 1103515245 + 12345;
+        filler += static_cast<char>(seed >> 16);
+    }
+    std::string data = block + filler + block;
+    size_t len = compress(data);
+    TEST_ASSERT_TRUE(len > 0);
+    std::string back = inflate(compressed, len);
+    TEST_ASSERT_EQUAL_MEMORY(data.data(), back.data(), data.size());
+}
+
+void test_output_too_small_returns_zero() {
+    std::string data;
+    unsigned seed = 7;
+    while (data.size() < 200) {
+        seed = seed * 1103515245 + 12345;
+        data += static_cast<char>(seed >> 16);
+    }
+    // Incompressible input grows, so a buffer of the input size is too small
+    size_t len = deflater.compress(reinterpret_cast<const uint8_t*>(data.data()), data.size(),
+                                   compressed, data.size());
+    TEST_ASSERT_EQUAL(0, len);
+}
+
+void test_rejects_oversized_input() {
+    static uint8_t big[Deflate::MAX_INPUT + 1];
+    TEST_ASSERT_EQUAL(0, deflater.compress(big, sizeof(big), compressed, sizeof(compressed)));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty_input_is_a_valid_block);
+    RUN_TEST(test_known_encoding);
+    RUN_TEST(test_roundtrip_json);
+    RUN_TEST(test_roundtrip_long_runs_and_high_bytes);
+    RUN_TEST(test_matches_stay_inside_window);
+    RUN_TEST(test_output_too_small_returns_zero);
+    RUN_TEST(test_rejects_oversized_input);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,244 @@
+#include <unity.h>
+#include <string.h>
+#include "DhcpLease.h"
+
+using namespace mcp;
+
+static const uint8_t MAC[6] = {0x24, 0x6f, 0x28, 0x01, 0x02, 0x03};
+static const uint32_t ADDRESS = 0x6401a8c0;  // 192.168.1.100
+static const uint32_t SERVER = 0x0101a8c0;   // 192.168.1.1
+static const uint32_t XID = 0x12345678;
+
+static uint32_t readXid(const uint8_t *packet) {
+    return static_cast<uint32_t>(packet[4]) << 24 | static_cast<uint32_t>(packet[5]) << 16 |
+           static_cast<uint32_t>(packet[6]) << 8 | packet[7];
+}
+
+// Options start after the fixed BOOTP header and the magic cookie
+static const uint8_t *findOption(const uint8_t *packet, size_t length, uint8_t code) {
+    size_t pos = 240;
+    while (pos + 1 < length && packet[pos] != 255) {
+        if (packet[pos] == 0) {
+            pos++;
+            continue;
+        }
+        if (packet[pos] == code) {
+            return packet + pos;
+        }
+        pos += 2 + packet[pos + 1];
+    }
+    return nullptr;
+}
+
+static void putBigEndian(uint8_t *out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+// A server reply to the request with the given transaction id
+static size_t reply(uint8_t *packet, uint32_t xid, uint8_t type, uint32_t yiaddr, uint32_t lease) {
+    memset(packet, 0, DhcpLease::MAX_REPLY_SIZE);
+    packet[0] = 2;
+    packet[1] = 1;
+    packet[2] = 6;
+    putBigEndian(packet + 4, xid);
+    memcpy(packet + 16, &yiaddr, 4);  // Little-endian host: first octet first
+    memcpy(packet + 28, MAC, sizeof(MAC));
+    const uint8_t cookie[] = {99, 130, 83, 99};
+    memcpy(packet + 236, cookie, sizeof(cookie));
+
+    size_t pos = 240;
+    packet[pos++] = 53;
+    packet[pos++] = 1;
+    packet[pos++] = type;
+    packet[pos++] = 54;
+    packet[pos++] = 4;
+    memcpy(packet + pos, &SERVER, 4);
+    pos += 4;
+    if (type == 5) {
+        packet[pos++] = 51;
+        packet[pos++] = 4;
+        putBigEndian(packet + pos, lease);
+        pos += 4;
+    }
+    packet[pos++] = 255;
+    return pos;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_idle_lease_sends_nothing() {
+    DhcpLease lease;
+    uint8_t request[DhcpLease::REQUEST_SIZE];
+    uint32_t destination = 0;
+
+    TEST_ASSERT_FALSE(lease.isActive());
+    TEST_ASSERT_TRUE(lease.poll(1000, request, destination) == DhcpLease::Action::NONE);
+}
+
+void test_init_reboot_request_keeps_the_address() {
+    DhcpLease lease;
+    lease.start(ADDRESS, MAC, XID, 0);
+    uint8_t request[DhcpLease::REQUEST_SIZE];
+    uint32_t destination = 0;
+
+    TEST_ASSERT_TRUE(lease.poll(0, request, destination) == DhcpLease::Action::SEND);
+    TEST_ASSERT_EQUAL_HEX32(DhcpLease::BROADCAST, destination);
+    TEST_ASSERT_EQUAL_UINT8(1, request[0]);
+    TEST_ASSERT_EQUAL_HEX32(XID, readXid(request));
+    // ciaddr stays empty in INIT-REBOOT; the address goes in option 50
+    uint32_t ciaddr;
+    memcpy(&ciaddr, request + 12, 4);
+    TEST_ASSERT_EQUAL_HEX32(0, ciaddr);
+    TEST_ASSERT_EQUAL_MEMORY(MAC, request + 28, sizeof(MAC));
+
+    const uint8_t *type = findOption(request, sizeof(request), 53);
+    TEST_ASSERT_NOT_NULL(type);
+    TEST_ASSERT_EQUAL_UINT8(3, type[2]);
+    const uint8_t *requested = findOption(request, sizeof(request), 50);
+    TEST_ASSERT_NOT_NULL(requested);
+    uint32_t address;
+    memcpy(&address, requested + 2, 4);
+    TEST_ASSERT_EQUAL_HEX32(ADDRESS, address);
+    TEST_ASSERT_TRUE(lease.isConfirming());
+}
+
+void test_unanswered_request_is_retried() {
+    DhcpLease lease;
+    lease.start(ADDRESS, MAC, XID, 0);
+    uint8_t request[DhcpLease::REQUEST_SIZE];
+    uint32_t destination = 0;
+
+    TEST_ASSERT_TRUE(lease.poll(0, request, destination) == DhcpLease::Action::SEND);
+    TEST_ASSERT_TRUE(lease.poll(DhcpLease::RETRY_INTERVAL - 1, request, destination) == DhcpLease::Action::NONE);
+    TEST_ASSERT_EQUAL_UINT32(1, lease.timeUntilDue(DhcpLease::RETRY_INTERVAL - 1));
+    TEST_ASSERT_TRUE(lease.poll(DhcpLease::RETRY_INTERVAL, request, destination) == DhcpLease::Action::SEND);
+}
+
+void test_ack_confirms_and_schedules_renewal() {
+    DhcpLease lease;
+    lease.start(ADDRESS, MAC, XID, 0);
+    uint8_t request[DhcpLease::REQUEST_SIZE];
+    uint8_t packet[DhcpLease::MAX_REPLY_SIZE];
+    uint32_t destination = 0;
+    lease.poll(0, request, destination);
+
+    size_t length = reply(packet, XID, 5, ADDRESS, 3600);
+    TEST_ASSERT_TRUE(lease.receive(packet, length, 1000) == DhcpLease::Reply::ACK);
+    TEST_ASSERT_FALSE(lease.isConfirming());
+    TEST_ASSERT_TRUE(lease.isActive());
+    TEST_ASSERT_EQUAL_UINT32(3600, lease.getLeaseTime());
+    TEST_ASSERT_EQUAL_HEX32(SERVER, lease.getServer());
+
+    // T1 is half the lease: renew then, unicast to the server with ciaddr set
+    TEST_ASSERT_EQUAL_UINT32(1800000, lease.timeUntilDue(1000));
+    TEST_ASSERT_TRUE(lease.poll(1800999, request, destination) == DhcpLease::Action::NONE);
+    TEST_ASSERT_TRUE(lease.poll(1801000, request, destination) == DhcpLease::Action::SEND);
+    TEST_ASSERT_EQUAL_HEX32(SERVER, destination);
+    uint32_t ciaddr;
+    memcpy(&ciaddr, request + 12, 4);
+    TEST_ASSERT_EQUAL_HEX32(ADDRESS, ciaddr);
+    TEST_ASSERT_NULL(findOption(request, sizeof(request), 50));
+    TEST_ASSERT_TRUE(readXid(request) != XID);
+
+    // The renewal's ACK extends the lease from the time it arrives
+    length = reply(packet, readXid(request), 5, ADDRESS, 3600);
+    TEST_ASSERT_TRUE(lease.receive(packet, length, 1802000) == DhcpLease::Reply::ACK);
+    TEST_ASSERT_EQUAL_UINT32(1800000, lease.timeUntilDue(1802000));
+}
+
+void test_nak_ends_tracking() {
+    DhcpLease lease;
+    lease.start(ADDRESS, MAC, XID, 0);
+    uint8_t request[DhcpLease::REQUEST_SIZE];
+    uint8_t packet[DhcpLease::MAX_REPLY_SIZE];
+    uint32_t destination = 0;
+    lease.poll(0, request, destination);
+
+    size_t length = reply(packet, XID, 6, 0, 0);
+    TEST_ASSERT_TRUE(lease.receive(packet, length, 500) == DhcpLease::Reply::NAK);
+    TEST_ASSERT_FALSE(lease.isActive());
+    TEST_ASSERT_TRUE(lease.poll(10000, request, destination) == DhcpLease::Action::NONE);
+}
+
+void test_foreign_replies_are_ignored() {
+    DhcpLease lease;
+    lease.start(ADDRESS, MAC, XID, 0);
+    uint8_t request[DhcpLease::REQUEST_SIZE];
+    uint8_t packet[DhcpLease::MAX_REPLY_SIZE];
+    uint32_t destination = 0;
+    lease.poll(0, request, destination);
+
+    // Another transaction
+    size_t length = reply(packet, XID + 7, 5, ADDRESS, 3600);
+    TEST_ASSERT_TRUE(lease.receive(packet, length, 100) == DhcpLease::Reply::IGNORED);
+    // Another client
+    length = reply(packet, XID, 5, ADDRESS, 3600);
+    packet[28] ^= 0xff;
+    TEST_ASSERT_TRUE(lease.receive(packet, length, 100) == DhcpLease::Reply::IGNORED);
+    // Another address
+    length = reply(packet, XID, 5, ADDRESS + 1, 3600);
+    TEST_ASSERT_TRUE(lease.receive(packet, length, 100) == DhcpLease::Reply::IGNORED);
+    // Truncated
+    length = reply(packet, XID, 5, ADDRESS, 3600);
+    TEST_ASSERT_TRUE(lease.receive(packet, 243, 100) == DhcpLease::Reply::IGNORED);
+
+    TEST_ASSERT_TRUE(lease.isConfirming());
+}
+
+void test_silent_server_lets_the_lease_expire() {
+    DhcpLease lease;
+    lease.start(ADDRESS, MAC, XID, 0);
+    uint8_t request[DhcpLease::REQUEST_SIZE];
+    uint8_t packet[DhcpLease::MAX_REPLY_SIZE];
+    uint32_t destination = 0;
+    lease.poll(0, request, destination);
+    size_t length = reply(packet, XID, 5, ADDRESS, 80);
+    lease.receive(packet, length, 0);
+
+    // T1 at 40 s renews with the server, T2 at 70 s rebinds with anyone
+    TEST_ASSERT_TRUE(lease.poll(40000, request, destination) == DhcpLease::Action::SEND);
+    TEST_ASSERT_EQUAL_HEX32(SERVER, destination);
+    TEST_ASSERT_TRUE(lease.poll(70000, request, destination) == DhcpLease::Action::SEND);
+    TEST_ASSERT_EQUAL_HEX32(DhcpLease::BROADCAST, destination);
+    TEST_ASSERT_EQUAL_UINT32(DhcpLease::RETRY_INTERVAL, lease.timeUntilDue(70000));
+    TEST_ASSERT_TRUE(lease.poll(74000, request, destination) == DhcpLease::Action::SEND);
+    TEST_ASSERT_TRUE(lease.poll(78000, request, destination) == DhcpLease::Action::SEND);
+    TEST_ASSERT_EQUAL_UINT32(1000, lease.timeUntilDue(79000));  // Expiry comes before the next retry
+    TEST_ASSERT_TRUE(lease.poll(80000, request, destination) == DhcpLease::Action::EXPIRED);
+    TEST_ASSERT_FALSE(lease.isActive());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_idle_lease_sends_nothing);
+    RUN_TEST(test_init_reboot_request_keeps_the_address);
+    RUN_TEST(test_unanswered_request_is_retried);
+    RUN_TEST(test_ack_confirms_and_schedules_renewal);
+    RUN_TEST(test_nak_ends_tracking);
+    RUN_TEST(test_foreign_replies_are_ignored);
+    RUN_TEST(test_silent_server_lets_the_lease_expire);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
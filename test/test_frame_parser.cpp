@@ -0,0 +1,94 @@
+#include <unity.h>
+#include <string>
+#include "FrameParser.h"
+
+using namespace mcp;
+
+static std::string methodOf(const std::string &frame, Encoding encoding = Encoding::JSON) {
+    char method[FrameParser::MAX_METHOD_LENGTH];
+    if (!FrameParser::findMethod(reinterpret_cast<const uint8_t *>(frame.data()), frame.size(), encoding,
+                                 method, sizeof(method))) {
+        return "";
+    }
+    return method;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_finds_top_level_json_method() {
+    TEST_ASSERT_EQUAL_STRING("tools/call",
+                             methodOf(R"({"jsonrpc":"2.0","id":1,"method":"tools/call","params":{}})").c_str());
+    TEST_ASSERT_EQUAL_STRING("resources/read", methodOf(R"({"id":2, "method" : "resources/read"})").c_str());
+}
+
+void test_ignores_nested_keys_and_string_values() {
+    const char *frame = R"({"params":{"method":"nested"},"id":"method","note":"a\"method\"","method":"ping"})";
+    TEST_ASSERT_EQUAL_STRING("ping", methodOf(frame).c_str());
+}
+
+void test_no_method() {
+    TEST_ASSERT_EQUAL_STRING("", methodOf(R"({"jsonrpc":"2.0","id":1,"result":{}})").c_str());
+    TEST_ASSERT_EQUAL_STRING("", methodOf(R"({"method":)").c_str());
+    TEST_ASSERT_EQUAL_STRING("", methodOf(R"(["method","ping"])").c_str());
+}
+
+void test_finds_msgpack_method() {
+    // {"id":1,"params":{"method":"x"},"method":"ping"}
+    const std::string frame("\x83\xa2id\x01\xa6params\x81\xa6method\xa1x\xa6method\xa4ping", 34);
+    TEST_ASSERT_EQUAL_STRING("ping", methodOf(frame, Encoding::MSGPACK).c_str());
+    TEST_ASSERT_EQUAL_STRING("", methodOf(frame.substr(0, 20), Encoding::MSGPACK).c_str());
+}
+
+void test_single_pass_applies_method_filter() {
+    FrameParser parser;
+    JsonDocument doc;
+    const char *frame = R"({"jsonrpc":"2.0","id":3,"method":"resources/read","params":{"uri":"a://b","big":[1,2,3]}})";
+
+    DeserializationError error = parser.parse(reinterpret_cast<const uint8_t *>(frame), strlen(frame), doc);
+
+    TEST_ASSERT_FALSE(error);
+    TEST_ASSERT_EQUAL_STRING("a://b", doc["params"]["uri"].as<const char *>());
+    TEST_ASSERT_TRUE(doc["params"]["big"].isNull());
+    TEST_ASSERT_EQUAL(3, doc["id"].as<int>());
+}
+
+void test_unknown_method_keeps_envelope() {
+    FrameParser parser;
+    JsonDocument doc;
+    const char *frame = R"({"jsonrpc":"2.0","id":4,"method":"nope","params":{"x":1}})";
+
+    TEST_ASSERT_FALSE(parser.parse(reinterpret_cast<const uint8_t *>(frame), strlen(frame), doc));
+    TEST_ASSERT_EQUAL_STRING("nope", doc["method"].as<const char *>());
+    TEST_ASSERT_TRUE(doc["params"].isNull());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_finds_top_level_json_method);
+    RUN_TEST(test_ignores_nested_keys_and_string_values);
+    RUN_TEST(test_no_method);
+    RUN_TEST(test_finds_msgpack_method);
+    RUN_TEST(test_single_pass_applies_method_filter);
+    RUN_TEST(test_unknown_method_keeps_envelope);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
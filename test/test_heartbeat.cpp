@@ -0,0 +1,140 @@
+#include <unity.h>
+#include "Heartbeat.h"
+
+using namespace mcp;
+
+static const Heartbeat::Config CONFIG = {1000, 200, 2};
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_untracked_slot_is_never_pinged() {
+    Heartbeat heartbeat(CONFIG);
+    uint32_t sequence = 0;
+
+    TEST_ASSERT_TRUE(heartbeat.poll(0, 5000, sequence) == Heartbeat::Action::NONE);
+    TEST_ASSERT_TRUE(heartbeat.poll(Heartbeat::MAX_SLOTS, 5000, sequence) == Heartbeat::Action::NONE);
+}
+
+void test_ping_every_interval_when_answered() {
+    Heartbeat heartbeat(CONFIG);
+    heartbeat.opened(0, 0);
+    uint32_t sequence = 0;
+
+    TEST_ASSERT_TRUE(heartbeat.poll(0, 999, sequence) == Heartbeat::Action::NONE);
+    TEST_ASSERT_TRUE(heartbeat.poll(0, 1000, sequence) == Heartbeat::Action::PING);
+    TEST_ASSERT_TRUE(heartbeat.isOutstanding(0));
+    // One ping at a time
+    TEST_ASSERT_TRUE(heartbeat.poll(0, 1100, sequence) == Heartbeat::Action::NONE);
+
+    TEST_ASSERT_TRUE(heartbeat.pong(0, sequence));
+    TEST_ASSERT_FALSE(heartbeat.isOutstanding(0));
+    TEST_ASSERT_TRUE(heartbeat.poll(0, 1999, sequence) == Heartbeat::Action::NONE);
+    TEST_ASSERT_TRUE(heartbeat.poll(0, 2000, sequence) == Heartbeat::Action::PING);
+}
+
+void test_stale_pong_is_ignored() {
+    Heartbeat heartbeat(CONFIG);
+    heartbeat.opened(0, 0);
+    uint32_t first = 0;
+    uint32_t second = 0;
+
+    heartbeat.poll(0, 1000, first);
+    heartbeat.poll(0, 1200, second); // First missed, retried
+    TEST_ASSERT_TRUE(first != second);
+
+    TEST_ASSERT_FALSE(heartbeat.pong(0, first));
+    TEST_ASSERT_TRUE(heartbeat.isOutstanding(0));
+    TEST_ASSERT_TRUE(heartbeat.pong(0, second));
+}
+
+void test_missed_pongs_declare_peer_dead() {
+    Heartbeat heartbeat(CONFIG);
+    heartbeat.opened(3, 0);
+    uint32_t sequence = 0;
+
+    TEST_ASSERT_TRUE(heartbeat.poll(3, 1000, sequence) == Heartbeat::Action::PING);
+    TEST_ASSERT_TRUE(heartbeat.poll(3, 1199, sequence) == Heartbeat::Action::NONE);
+    TEST_ASSERT_TRUE(heartbeat.poll(3, 1200, sequence) == Heartbeat::Action::PING);
+    TEST_ASSERT_TRUE(heartbeat.poll(3, 1400, sequence) == Heartbeat::Action::DEAD);
+    // Reported once, then no longer tracked
+    TEST_ASSERT_TRUE(heartbeat.poll(3, 5000, sequence) == Heartbeat::Action::NONE);
+}
+
+void test_pong_resets_missed_count() {
+    Heartbeat heartbeat(CONFIG);
+    heartbeat.opened(0, 0);
+    uint32_t sequence = 0;
+
+    heartbeat.poll(0, 1000, sequence);
+    heartbeat.poll(0, 1200, sequence);   // One miss
+    TEST_ASSERT_TRUE(heartbeat.pong(0, sequence));
+
+    heartbeat.poll(0, 2200, sequence);
+    TEST_ASSERT_TRUE(heartbeat.poll(0, 2400, sequence) == Heartbeat::Action::PING);
+}
+
+void test_closed_slot_stops_and_reopen_restarts() {
+    Heartbeat heartbeat(CONFIG);
+    heartbeat.opened(1, 0);
+    uint32_t sequence = 0;
+    heartbeat.poll(1, 1000, sequence);
+
+    heartbeat.closed(1);
+    TEST_ASSERT_FALSE(heartbeat.isOutstanding(1));
+    TEST_ASSERT_FALSE(heartbeat.pong(1, sequence));
+    TEST_ASSERT_TRUE(heartbeat.poll(1, 9000, sequence) == Heartbeat::Action::NONE);
+
+    heartbeat.opened(1, 9000);
+    TEST_ASSERT_TRUE(heartbeat.poll(1, 9999, sequence) == Heartbeat::Action::NONE);
+    TEST_ASSERT_TRUE(heartbeat.poll(1, 10000, sequence) == Heartbeat::Action::PING);
+}
+
+void test_zero_interval_disables() {
+    Heartbeat heartbeat({0, 200, 2});
+    heartbeat.opened(0, 0);
+    uint32_t sequence = 0;
+
+    TEST_ASSERT_TRUE(heartbeat.poll(0, 100000, sequence) == Heartbeat::Action::NONE);
+}
+
+void test_survives_millis_wraparound() {
+    Heartbeat heartbeat(CONFIG);
+    heartbeat.opened(0, 0xFFFFFF00);
+    uint32_t sequence = 0;
+
+    TEST_ASSERT_TRUE(heartbeat.poll(0, 0x000002E7, sequence) == Heartbeat::Action::NONE);
+    TEST_ASSERT_TRUE(heartbeat.poll(0, 0x000002E8, sequence) == Heartbeat::Action::PING);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_untracked_slot_is_never_pinged);
+    RUN_TEST(test_ping_every_interval_when_answered);
+    RUN_TEST(test_stale_pong_is_ignored);
+    RUN_TEST(test_missed_pongs_declare_peer_dead);
+    RUN_TEST(test_pong_resets_missed_count);
+    RUN_TEST(test_closed_slot_stops_and_reopen_restarts);
+    RUN_TEST(test_zero_interval_disables);
+    RUN_TEST(test_survives_millis_wraparound);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,273 @@
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include "JsonWriter.h"
+
+using namespace mcp;
+
+static char buffer[1024];
+
+static std::string written(const BufferOutput& out) {
+    return std::string(buffer, out.length());
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_envelope_and_nesting() {
+    BufferOutput out(buffer, sizeof(buffer));
+    JsonWriter<BufferOutput> writer(out);
+    writer.beginObject().rawKey(JsonRpc::ID_KEY).value(uint32_t(7))
+          .key("result").beginObject()
+              .key("content").beginArray()
+                  .beginObject().key("type").value("text").key("text").value("hi").endObject()
+                  .beginObject().endObject()
+              .endArray()
+              .key("isError").value(false)
+          .endObject()
+          .endObject();
+
+    TEST_ASSERT_TRUE(writer.ok());
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"jsonrpc\":\"2.0\",\"id\":7,\"result\":{\"content\":[{\"type\":\"text\",\"text\":\"hi\"},{}],"
+        "\"isError\":false}}",
+        written(out).c_str());
+}
+
+void test_string_escaping() {
+    BufferOutput out(buffer, sizeof(buffer));
+    JsonWriter<BufferOutput> writer(out);
+    writer.value(std::string("a\"b\\c\n\r\t\b\f\x01\x1f/\xc3\xa9", 15));
+
+    TEST_ASSERT_TRUE(writer.ok());
+    TEST_ASSERT_EQUAL_STRING("\"a\\\"b\\\\c\\n\\r\\t\\b\\f\\u0001\\u001f/\xc3\xa9\"", written(out).c_str());
+}
+
+void test_runtime_key_is_escaped() {
+    BufferOutput out(buffer, sizeof(buffer));
+    JsonWriter<BufferOutput> writer(out);
+    writer.beginObject().key("x\"y", 3).null().endObject();
+
+    TEST_ASSERT_EQUAL_STRING("{\"x\\\"y\":null}", written(out).c_str());
+}
+
+void test_numbers() {
+    BufferOutput out(buffer, sizeof(buffer));
+    JsonWriter<BufferOutput> writer(out);
+    writer.beginArray()
+          .value(int32_t(-32603))
+          .value(uint32_t(4294967295u))
+          .value(int64_t(INT64_MIN))
+          .value(uint64_t(0))
+          .value(1.5)
+          .value(NAN)
+          .endArray();
+
+    TEST_ASSERT_EQUAL_STRING("[-32603,4294967295,-9223372036854775808,0,1.5,null]", written(out).c_str());
+}
+
+void test_raw_value_and_null_string() {
+    BufferOutput out(buffer, sizeof(buffer));
+    JsonWriter<BufferOutput> writer(out);
+    const char* missing = nullptr;
+    writer.beginObject().key("a").rawValue("[1,2]", 5).key("b").value(missing).endObject();
+
+    TEST_ASSERT_EQUAL_STRING("{\"a\":[1,2],\"b\":null}", written(out).c_str());
+}
+
+void test_request_id_is_echoed_as_sent() {
+    BufferOutput out(buffer, sizeof(buffer));
+    JsonWriter<BufferOutput> writer(out);
+    writer.beginArray()
+          .value(RequestId("a\"1", 3))
+          .value(RequestId(int64_t(-5000000000)))
+          .value(RequestId())
+          .endArray();
+
+    TEST_ASSERT_EQUAL_STRING("[\"a\\\"1\",-5000000000,null]", written(out).c_str());
+}
+
+void test_overflow_fails_without_partial_token() {
+    char small[16];
+    BufferOutput out(small, sizeof(small));
+    JsonWriter<BufferOutput> writer(out);
+    writer.beginObject().key("message").value("much too long for the buffer").endObject();
+
+    TEST_ASSERT_FALSE(writer.ok());
+    TEST_ASSERT_TRUE(out.length() <= sizeof(small));
+}
+
+void test_counting_matches_written_length() {
+    CountingOutput counter;
+    JsonWriter<CountingOutput> measure(counter);
+    measure.beginObject().rawKey(JsonRpc::ID_KEY).value(uint32_t(1)).key("text").value("tab\there").endObject();
+
+    BufferOutput out(buffer, sizeof(buffer));
+    JsonWriter<BufferOutput> writer(out);
+    writer.beginObject().rawKey(JsonRpc::ID_KEY).value(uint32_t(1)).key("text").value("tab\there").endObject();
+
+    TEST_ASSERT_EQUAL(out.length(), counter.length);
+}
+
+void test_matches_arduinojson_output() {
+    JsonDocument doc;
+    doc["jsonrpc"] = "2.0";
+    doc["id"] = 42;
+    JsonObject error = doc["error"].to<JsonObject>();
+    error["code"] = -32602;
+    error["message"] = "Unknown tool \"x\"\n";
+    std::string expected;
+    serializeJson(doc, expected);
+
+    BufferOutput out(buffer, sizeof(buffer));
+    JsonWriter<BufferOutput> writer(out);
+    writer.beginObject().rawKey(JsonRpc::ID_KEY).value(uint32_t(42))
+          .key("error").beginObject()
+              .key("code").value(int32_t(-32602))
+              .key("message").value("Unknown tool \"x\"\n")
+          .endObject()
+          .endObject();
+
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), written(out).c_str());
+}
+
+// MessagePack sessions get writer output re-parsed into a document and
+// packed (MCPServer::transmitJson); the client must unpack the same message
+static std::string viaMsgPack(const std::string& json) {
+    JsonDocument parsed;
+    TEST_ASSERT_FALSE(deserializeJson(parsed, json));
+    std::string packed;
+    serializeMsgPack(parsed, packed);
+
+    JsonDocument unpacked;
+    TEST_ASSERT_FALSE(deserializeMsgPack(unpacked, packed));
+    std::string result;
+    serializeJson(unpacked, result);
+    return result;
+}
+
+void test_msgpack_round_trip() {
+    BufferOutput out(buffer, sizeof(buffer));
+    JsonWriter<BufferOutput> writer(out);
+    writer.beginObject().rawKey(JsonRpc::ID_KEY).value(uint32_t(7))
+          .key("result").beginObject()
+              .key("content").beginArray()
+                  .beginObject().key("type").value("text").key("text").value("line\n\"quoted\"\t\xc3\xa9").endObject()
+              .endArray()
+              .key("count").value(int64_t(-5000000000))
+              .key("ratio").value(0.5)
+              .key("raw").rawValue("[1,{\"a\":null}]", 14)
+              .key("isError").value(false)
+          .endObject()
+          .endObject();
+    TEST_ASSERT_TRUE(writer.ok());
+
+    std::string json = written(out);
+    TEST_ASSERT_EQUAL_STRING(json.c_str(), viaMsgPack(json).c_str());
+}
+
+void test_msgpack_keeps_request_id_type() {
+    BufferOutput out(buffer, sizeof(buffer));
+    JsonWriter<BufferOutput> writer(out);
+    writer.beginArray()
+          .value(RequestId("7", 1))
+          .value(RequestId(int64_t(7)))
+          .value(RequestId(int64_t(-5000000000)))
+          .value(RequestId())
+          .endArray();
+
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(deserializeJson(doc, viaMsgPack(written(out))));
+    TEST_ASSERT_TRUE(doc[0].is<const char*>());
+    TEST_ASSERT_EQUAL_STRING("7", doc[0].as<const char*>());
+    TEST_ASSERT_TRUE(doc[1].is<int64_t>());
+    TEST_ASSERT_EQUAL(7, doc[1].as<int>());
+    TEST_ASSERT_TRUE(doc[2].as<int64_t>() == int64_t(-5000000000));
+    TEST_ASSERT_TRUE(doc[3].isNull());
+}
+
+// Native benchmark: a tools/call result built as a document tree and
+// serialized, against the same bytes streamed by JsonWriter
+void test_benchmark_against_document() {
+    static const int ITERATIONS = 20000;
+    const std::string text = "LED is on; brightness 128, colour #ff8800, mode \"steady\"";
+    size_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        JsonDocument doc;
+        doc["jsonrpc"] = "2.0";
+        doc["id"] = i;
+        JsonObject result = doc["result"].to<JsonObject>();
+        JsonObject content = result["content"].to<JsonArray>().add<JsonObject>();
+        content["type"] = "text";
+        content["text"] = text;
+        result["isError"] = false;
+        sink += serializeJson(doc, buffer, sizeof(buffer));
+    }
+    auto treeTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        BufferOutput out(buffer, sizeof(buffer));
+        JsonWriter<BufferOutput> writer(out);
+        writer.beginObject().rawKey(JsonRpc::ID_KEY).value(uint32_t(i))
+              .key("result").beginObject()
+                  .key("content").beginArray()
+                      .beginObject().key("type").value("text").key("text").value(text).endObject()
+                  .endArray()
+                  .key("isError").value(false)
+              .endObject()
+              .endObject();
+        sink += out.length();
+    }
+    auto writerTime = std::chrono::steady_clock::now() - start;
+
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+    char report[128];
+    snprintf(report, sizeof(report), "tools/call result: document %lld ns, JsonWriter %lld ns per message (%zu bytes)",
+             static_cast<long long>(duration_cast<nanoseconds>(treeTime).count() / ITERATIONS),
+             static_cast<long long>(duration_cast<nanoseconds>(writerTime).count() / ITERATIONS),
+             sink / (2 * ITERATIONS));
+    TEST_MESSAGE(report);
+    TEST_ASSERT_TRUE(writerTime < treeTime);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_envelope_and_nesting);
+    RUN_TEST(test_string_escaping);
+    RUN_TEST(test_runtime_key_is_escaped);
+    RUN_TEST(test_numbers);
+    RUN_TEST(test_raw_value_and_null_string);
+    RUN_TEST(test_request_id_is_echoed_as_sent);
+    RUN_TEST(test_overflow_fails_without_partial_token);
+    RUN_TEST(test_counting_matches_written_length);
+    RUN_TEST(test_matches_arduinojson_output);
+    RUN_TEST(test_msgpack_round_trip);
+    RUN_TEST(test_msgpack_keeps_request_id_type);
+    RUN_TEST(test_benchmark_against_document);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
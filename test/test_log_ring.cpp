@@ -0,0 +1,138 @@
+#include <unity.h>
+#include <string>
+#include "LogRing.h"
+
+using namespace mcp;
+
+static std::string drainOne(LogRing& ring, uint8_t* level = nullptr) {
+    LogRing::Entry entry;
+    if (!ring.read(entry)) {
+        return "<empty>";
+    }
+    char line[160];
+    LogRing::format(entry, line, sizeof(line));
+    if (level) {
+        *level = entry.level;
+    }
+    ring.consume();
+    return line;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_integer_and_string_arguments() {
+    LogRing ring(1024);
+    TEST_ASSERT_TRUE(ring.write(3, 100, "client %d: %s (%u bytes)", 7, "initialize", 42u));
+
+    uint8_t level = 0;
+    TEST_ASSERT_EQUAL_STRING("client 7: initialize (42 bytes)", drainOne(ring, &level).c_str());
+    TEST_ASSERT_EQUAL(3, level);
+    TEST_ASSERT_EQUAL_STRING("<empty>", drainOne(ring).c_str());
+}
+
+void test_format_flags_and_types() {
+    LogRing ring(1024);
+    ring.write(1, 0, "%5d|%-4s|%08.3f|%x|%c|%%", -12, "ab", 3.14159, 255u, 'z');
+    ring.write(1, 0, "%lld %llu %ld", -5000000000LL, 18000000000000000000ULL, -7L);
+    ring.write(1, 0, "%x", -1);
+
+    TEST_ASSERT_EQUAL_STRING("  -12|ab  |0003.142|ff|z|%", drainOne(ring).c_str());
+    TEST_ASSERT_EQUAL_STRING("-5000000000 18000000000000000000 -7", drainOne(ring).c_str());
+    TEST_ASSERT_EQUAL_STRING("ffffffff", drainOne(ring).c_str());
+}
+
+void test_strings_are_copied() {
+    LogRing ring(1024);
+    char name[16] = "before";
+    ring.write(3, 0, "name=%s", name);
+    strcpy(name, "after");
+
+    TEST_ASSERT_EQUAL_STRING("name=before", drainOne(ring).c_str());
+}
+
+void test_long_strings_are_truncated() {
+    LogRing ring(1024);
+    std::string longText(200, 'x');
+    ring.write(3, 0, "%s!", longText.c_str());
+
+    std::string expected(LogRing::MAX_STRING, 'x');
+    TEST_ASSERT_EQUAL_STRING((expected + "!").c_str(), drainOne(ring).c_str());
+}
+
+void test_missing_arguments_do_not_crash() {
+    LogRing ring(1024);
+    ring.write(3, 0, "%d and %s", 1);
+
+    TEST_ASSERT_EQUAL_STRING("1 and ?", drainOne(ring).c_str());
+}
+
+void test_full_ring_drops_and_counts() {
+    LogRing ring(256);
+    size_t written = 0;
+    while (ring.write(3, 0, "value %d", 1)) {
+        written++;
+    }
+    TEST_ASSERT_TRUE(written > 0);
+    TEST_ASSERT_EQUAL(1, ring.getDropped());
+
+    // Draining frees the space again
+    drainOne(ring);
+    TEST_ASSERT_TRUE(ring.write(3, 0, "value %d", 2));
+}
+
+void test_records_survive_wraparound() {
+    LogRing ring(256);
+    for (int i = 0; i < 500; i++) {
+        TEST_ASSERT_TRUE(ring.write(3, i, "record %d of %s", i, "wrap"));
+        char expected[32];
+        snprintf(expected, sizeof(expected), "record %d of wrap", i);
+        TEST_ASSERT_EQUAL_STRING(expected, drainOne(ring).c_str());
+    }
+    TEST_ASSERT_EQUAL(0, ring.getDropped());
+}
+
+void test_records_drain_in_order() {
+    LogRing ring(1024);
+    for (int i = 0; i < 10; i++) {
+        ring.write(3, i * 10, "n=%d", i);
+    }
+    for (int i = 0; i < 10; i++) {
+        LogRing::Entry entry;
+        TEST_ASSERT_TRUE(ring.read(entry));
+        TEST_ASSERT_EQUAL(i * 10, entry.timestamp);
+        ring.consume();
+    }
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_integer_and_string_arguments);
+    RUN_TEST(test_format_flags_and_types);
+    RUN_TEST(test_strings_are_copied);
+    RUN_TEST(test_long_strings_are_truncated);
+    RUN_TEST(test_missing_arguments_do_not_crash);
+    RUN_TEST(test_full_ring_drops_and_counts);
+    RUN_TEST(test_records_survive_wraparound);
+    RUN_TEST(test_records_drain_in_order);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,130 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include "LogTap.h"
+
+using namespace mcp;
+
+static bool pushText(LogTap &tap, uint8_t level, const char *text) {
+    return tap.push(level, text, strlen(text));
+}
+
+static std::string textOf(const LogTap::Line &line) {
+    return std::string(line.text, line.length);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_lines_come_out_in_order() {
+    LogTap tap(4);
+    pushText(tap, 3, "first");
+    pushText(tap, 2, "second");
+
+    TEST_ASSERT_EQUAL(2, tap.available());
+    TEST_ASSERT_EQUAL_STRING("first", textOf(tap.peek(0)).c_str());
+    TEST_ASSERT_EQUAL(3, tap.peek(0).level);
+    TEST_ASSERT_EQUAL_STRING("second", textOf(tap.peek(1)).c_str());
+    TEST_ASSERT_EQUAL(2, tap.peek(1).level);
+
+    tap.consume(1);
+    TEST_ASSERT_EQUAL(1, tap.available());
+    TEST_ASSERT_EQUAL_STRING("second", textOf(tap.peek(0)).c_str());
+}
+
+void test_full_tap_drops_and_counts() {
+    LogTap tap(2);
+    TEST_ASSERT_TRUE(pushText(tap, 3, "a"));
+    TEST_ASSERT_TRUE(pushText(tap, 3, "b"));
+
+    TEST_ASSERT_FALSE(pushText(tap, 3, "c"));
+    TEST_ASSERT_EQUAL(1, tap.getDropped());
+
+    tap.consume(1);
+    TEST_ASSERT_TRUE(pushText(tap, 3, "d"));
+    TEST_ASSERT_EQUAL_STRING("b", textOf(tap.peek(0)).c_str());
+    TEST_ASSERT_EQUAL_STRING("d", textOf(tap.peek(1)).c_str());
+}
+
+void test_long_line_is_truncated() {
+    LogTap tap(2);
+    std::string text(LogTap::MAX_TEXT + 20, 'x');
+    tap.push(3, text.data(), text.size());
+
+    TEST_ASSERT_EQUAL(LogTap::MAX_TEXT, tap.peek(0).length);
+}
+
+void test_capacity_rounds_up() {
+    LogTap tap(5);
+    TEST_ASSERT_EQUAL(8, tap.getCapacity());
+}
+
+void test_consume_more_than_available() {
+    LogTap tap(4);
+    pushText(tap, 3, "a");
+    tap.consume(10);
+
+    TEST_ASSERT_EQUAL(0, tap.available());
+    TEST_ASSERT_TRUE(pushText(tap, 3, "b"));
+    TEST_ASSERT_EQUAL(1, tap.available());
+}
+
+void test_producer_and_consumer_threads() {
+    static const int COUNT = 100000;
+    LogTap tap(16);
+    std::thread producer([&tap]() {
+        char text[16];
+        for (int i = 0; i < COUNT; i++) {
+            int length = snprintf(text, sizeof(text), "%d", i);
+            while (!tap.push(3, text, length)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    bool ordered = true;
+    while (expected < COUNT) {
+        size_t ready = tap.available();
+        for (size_t i = 0; i < ready; i++) {
+            ordered = ordered && textOf(tap.peek(i)) == std::to_string(expected);
+            expected++;
+        }
+        tap.consume(ready);
+    }
+    producer.join();
+
+    TEST_ASSERT_TRUE(ordered);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_lines_come_out_in_order);
+    RUN_TEST(test_full_tap_drops_and_counts);
+    RUN_TEST(test_long_line_is_truncated);
+    RUN_TEST(test_capacity_rounds_up);
+    RUN_TEST(test_consume_more_than_available);
+    RUN_TEST(test_producer_and_consumer_threads);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
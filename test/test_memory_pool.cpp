@@ -0,0 +1,165 @@
+#include <unity.h>
+#include <vector>
+#include "MemoryPool.h"
+
+using namespace mcp;
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_allocates_from_smallest_fitting_class() {
+    MemoryPool& pool = MemoryPool::getInstance();
+    size_t before = pool.getClassStats(1).inUse;
+
+    void* block = pool.allocate(40); // Too big for 32, fits 64
+    TEST_ASSERT_NOT_NULL(block);
+    TEST_ASSERT_EQUAL(before + 1, pool.getClassStats(1).inUse);
+
+    pool.deallocate(block);
+    TEST_ASSERT_EQUAL(before, pool.getClassStats(1).inUse);
+}
+
+void test_blocks_are_reused() {
+    MemoryPool& pool = MemoryPool::getInstance();
+
+    void* first = pool.allocate(200);
+    pool.deallocate(first);
+    void* second = pool.allocate(200);
+
+    TEST_ASSERT_EQUAL_PTR(first, second);
+    pool.deallocate(second);
+}
+
+void test_high_water_mark() {
+    MemoryPool& pool = MemoryPool::getInstance();
+    void* blocks[4];
+
+    for (auto& block : blocks) {
+        block = pool.allocate(1000);
+    }
+    size_t highWater = pool.getClassStats(3).highWater;
+    for (auto& block : blocks) {
+        pool.deallocate(block);
+    }
+
+    TEST_ASSERT_GREATER_OR_EQUAL(4, highWater);
+    TEST_ASSERT_EQUAL(highWater, pool.getClassStats(3).highWater);
+}
+
+void test_oversize_falls_back_to_heap() {
+    MemoryPool& pool = MemoryPool::getInstance();
+    uint32_t fallbacks = pool.getFallbackCount();
+
+    void* big = pool.allocate(MemoryPool::BLOCK_SIZES[MemoryPool::CLASS_COUNT - 1] + 1);
+    TEST_ASSERT_NOT_NULL(big);
+    TEST_ASSERT_EQUAL(fallbacks + 1, pool.getFallbackCount());
+
+    pool.deallocate(big);
+}
+
+void test_spill_is_limited() {
+    MemoryPool& pool = MemoryPool::getInstance();
+    std::vector<void*> held;
+
+    // Exhaust the 1 KB class: a 1 KB request must not take an 8 KB block
+    while (pool.getClassStats(3).inUse < pool.getClassStats(3).capacity) {
+        held.push_back(pool.allocate(1000));
+    }
+    size_t largest = pool.getClassStats(4).inUse;
+    uint32_t fallbacks = pool.getFallbackCount();
+    void* overflow = pool.allocate(1000);
+    TEST_ASSERT_NOT_NULL(overflow);
+    TEST_ASSERT_EQUAL(largest, pool.getClassStats(4).inUse);
+    TEST_ASSERT_EQUAL(fallbacks + 1, pool.getFallbackCount());
+    pool.deallocate(overflow);
+    for (void* block : held) {
+        pool.deallocate(block);
+    }
+    held.clear();
+
+    // Exhaust the 256-byte class: the next request spills one class up
+    while (pool.getClassStats(2).inUse < pool.getClassStats(2).capacity) {
+        held.push_back(pool.allocate(200));
+    }
+    size_t spilled = pool.getClassStats(3).inUse;
+    void* block = pool.allocate(200);
+    TEST_ASSERT_EQUAL(spilled + 1, pool.getClassStats(3).inUse);
+    pool.deallocate(block);
+    for (void* block : held) {
+        pool.deallocate(block);
+    }
+}
+
+void test_reallocate_preserves_contents() {
+    MemoryPool& pool = MemoryPool::getInstance();
+
+    char* data = static_cast<char*>(pool.allocate(16));
+    strcpy(data, "pooled");
+    data = static_cast<char*>(pool.reallocate(data, 500));
+    TEST_ASSERT_EQUAL_STRING("pooled", data);
+
+    // Shrinking back returns the data to a smaller class
+    data = static_cast<char*>(pool.reallocate(data, 16));
+    TEST_ASSERT_EQUAL_STRING("pooled", data);
+    pool.deallocate(data);
+}
+
+void test_json_document_uses_pool() {
+    MemoryPool& pool = MemoryPool::getInstance();
+    size_t before = pool.getClassStats(3).inUse;
+
+    {
+        JsonDocument doc(&pool);
+        doc["method"] = "resources/read";
+        doc["params"]["uri"] = "test://pool";
+        TEST_ASSERT_EQUAL_STRING("test://pool", doc["params"]["uri"]);
+    }
+
+    TEST_ASSERT_EQUAL(before, pool.getClassStats(3).inUse);
+}
+
+void test_pooled_buffer() {
+    PooledBuffer buffer(64);
+    TEST_ASSERT_TRUE(buffer.valid());
+    TEST_ASSERT_TRUE(buffer.append("hello", 5));
+    TEST_ASSERT_EQUAL(5, buffer.length());
+
+    char filler[64] = {0};
+    TEST_ASSERT_FALSE(buffer.append(filler, sizeof(filler))); // Never grows
+
+    PooledBuffer moved(std::move(buffer));
+    TEST_ASSERT_FALSE(buffer.valid());
+    TEST_ASSERT_EQUAL(5, moved.length());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_allocates_from_smallest_fitting_class);
+    RUN_TEST(test_blocks_are_reused);
+    RUN_TEST(test_high_water_mark);
+    RUN_TEST(test_oversize_falls_back_to_heap);
+    RUN_TEST(test_spill_is_limited);
+    RUN_TEST(test_reallocate_preserves_contents);
+    RUN_TEST(test_json_document_uses_pool);
+    RUN_TEST(test_pooled_buffer);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
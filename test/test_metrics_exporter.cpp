@@ -0,0 +1,163 @@
+#include <unity.h>
+#include <string>
+#include <LittleFS.h>
+#include "MetricsExporter.h"
+
+using namespace mcp;
+
+// Drain an export through a small buffer, as the chunked response does
+static std::string exportAll(MetricsExporter& exporter) {
+    std::string out;
+    uint8_t chunk[16];
+    size_t len;
+    while ((len = exporter.fill(chunk, sizeof(chunk))) > 0) {
+        out.append(reinterpret_cast<const char*>(chunk), len);
+    }
+    return out;
+}
+
+static bool contains(const std::string& text, const char* part) {
+    return text.find(part) != std::string::npos;
+}
+
+void setUp(void) {
+    LittleFS.begin(true);
+    MetricsSystem::getInstance().begin();
+    MetricsSystem::getInstance().resetBootMetrics();
+}
+
+void tearDown(void) {
+    MetricsSystem::getInstance().end();
+    LittleFS.end();
+}
+
+void test_openmetrics_counter_family() {
+    MetricsSystem::getInstance().registerCounter("test.export.requests_total", "Requests");
+    MetricsSystem::getInstance().registerCounter("test.export.hits", "Hits");
+    MetricsSystem::getInstance().incrementCounter("test.export.requests_total", 3);
+    MetricsSystem::getInstance().incrementCounter("test.export.hits");
+
+    MetricsExporter exporter(MetricsExporter::Format::OPENMETRICS);
+    std::string text = exportAll(exporter);
+
+    TEST_ASSERT_TRUE(contains(text, "# TYPE test_export_requests counter\n"));
+    TEST_ASSERT_TRUE(contains(text, "\ntest_export_requests_total 3\n"));
+    TEST_ASSERT_TRUE(contains(text, "# TYPE test_export_hits counter\n"));
+    TEST_ASSERT_TRUE(contains(text, "\ntest_export_hits_total 1\n"));
+    TEST_ASSERT_FALSE(contains(text, "_total_total"));
+}
+
+void test_openmetrics_histogram_and_eof() {
+    MetricsSystem::getInstance().registerHistogram("test.export.latency", "Latency");
+    MetricsSystem::getInstance().recordHistogram("test.export.latency", 10.0);
+    MetricsSystem::getInstance().recordHistogram("test.export.latency", 20.0);
+
+    MetricsExporter exporter(MetricsExporter::Format::OPENMETRICS);
+    std::string text = exportAll(exporter);
+
+    TEST_ASSERT_TRUE(contains(text, "# TYPE test_export_latency histogram\n"));
+    TEST_ASSERT_TRUE(contains(text, "\ntest_export_latency_bucket{le=\"+Inf\"} 2\n"));
+    TEST_ASSERT_TRUE(contains(text, "\ntest_export_latency_count 2\n"));
+    TEST_ASSERT_TRUE(contains(text, "\ntest_export_latency_sum 30\n"));
+    TEST_ASSERT_EQUAL_UINT(text.size() - 6, text.rfind("# EOF\n"));
+    TEST_ASSERT_EQUAL_UINT(text.rfind("# EOF"), text.find("# EOF"));
+}
+
+void test_stats_json_shape() {
+    MetricsSystem::getInstance().registerCounter("test.export.hits", "Hits");
+    MetricsSystem::getInstance().incrementCounter("test.export.hits", 2);
+
+    MetricsExporter exporter(MetricsExporter::Format::STATS_JSON);
+    std::string json = exportAll(exporter);
+
+    TEST_ASSERT_EQUAL_UINT(0, json.find("{\"requests\":{\"total\":"));
+    TEST_ASSERT_TRUE(contains(json, "},\"system\":{\"wifi_signal\":"));
+    TEST_ASSERT_TRUE(contains(json, ",\"metrics\":{"));
+    TEST_ASSERT_TRUE(contains(json, "\"test.export.hits\":2"));
+    TEST_ASSERT_EQUAL_UINT(json.size() - 2, json.rfind("}}"));
+}
+
+void test_delta_holds_only_changed_metrics() {
+    MetricsSystem::getInstance().registerCounter("test.delta.a", "A");
+    MetricsSystem::getInstance().registerCounter("test.delta.b", "B");
+    MetricsSystem::getInstance().incrementCounter("test.delta.a");
+    MetricsSystem::getInstance().incrementCounter("test.delta.b");
+    uint32_t since = MetricsSystem::getInstance().getChangeSequence();
+    MetricsSystem::getInstance().incrementCounter("test.delta.b");
+
+    MetricsExporter exporter(MetricsExporter::Format::METRICS_DELTA, false, since);
+    std::string json = exportAll(exporter);
+
+    std::string header = "{\"seq\":" + std::to_string(since + 1) + ",\"since\":" + std::to_string(since) +
+                         ",\"metrics\":{";
+    TEST_ASSERT_EQUAL_STRING((header + "\"test.delta.b\":2}}").c_str(), json.c_str());
+    TEST_ASSERT_EQUAL_UINT32(since + 1, exporter.getSequence());
+}
+
+void test_delta_without_changes_is_empty() {
+    uint32_t since = MetricsSystem::getInstance().getChangeSequence();
+
+    MetricsExporter exporter(MetricsExporter::Format::METRICS_DELTA, false, since);
+    std::string json = exportAll(exporter);
+
+    std::string expected = "{\"seq\":" + std::to_string(since) + ",\"since\":" + std::to_string(since) +
+                           ",\"metrics\":{}}";
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), json.c_str());
+}
+
+void test_change_during_export_is_sent_again() {
+    MetricsSystem::getInstance().registerCounter("test.delta.a", "A");
+    uint32_t since = MetricsSystem::getInstance().getChangeSequence();
+
+    // Snapshot taken, then the metric changes before the walk reaches it
+    MetricsExporter first(MetricsExporter::Format::METRICS_DELTA, false, since);
+    MetricsSystem::getInstance().incrementCounter("test.delta.a");
+    exportAll(first);
+
+    // The client resumes from the sequence the first export reported
+    MetricsExporter next(MetricsExporter::Format::METRICS_DELTA, false, first.getSequence());
+    std::string json = exportAll(next);
+
+    TEST_ASSERT_TRUE(next.getSequence() > first.getSequence());
+    TEST_ASSERT_TRUE(contains(json, "\"test.delta.a\":"));
+}
+
+void test_since_zero_sends_everything() {
+    MetricsSystem::getInstance().registerCounter("test.delta.a", "A");
+    MetricsSystem::getInstance().registerGauge("test.delta.g", "G");
+
+    MetricsExporter exporter(MetricsExporter::Format::METRICS_DELTA);
+    std::string json = exportAll(exporter);
+
+    TEST_ASSERT_TRUE(contains(json, ",\"since\":0,"));
+    TEST_ASSERT_TRUE(contains(json, "\"test.delta.a\":"));
+    TEST_ASSERT_TRUE(contains(json, "\"test.delta.g\":"));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_openmetrics_counter_family);
+    RUN_TEST(test_openmetrics_histogram_and_eof);
+    RUN_TEST(test_stats_json_shape);
+    RUN_TEST(test_delta_holds_only_changed_metrics);
+    RUN_TEST(test_delta_without_changes_is_empty);
+    RUN_TEST(test_change_during_export_is_sent_again);
+    RUN_TEST(test_since_zero_sends_everything);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
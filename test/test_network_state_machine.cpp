@@ -0,0 +1,206 @@
+#include <unity.h>
+#include "NetworkStateMachine.h"
+
+using namespace mcp;
+
+using S = NetworkStateMachine::State;
+using E = NetworkStateMachine::Event;
+using A = NetworkStateMachine::Action;
+
+// One recorded step: an event (or a timer check when event is NONE) at a
+// point in time, and what the machine must do in response
+struct TraceStep {
+    uint32_t now;
+    E event;
+    uint8_t reason;
+    A expectedAction;
+    S expectedState;
+    uint32_t armTimer;  // Timer the owner arms after the action (0 = none)
+};
+
+static void replay(const TraceStep* steps, size_t count) {
+    NetworkStateMachine machine;
+    for (size_t i = 0; i < count; i++) {
+        const TraceStep& step = steps[i];
+        A action = step.event == E::NONE ? machine.poll(step.now)
+                                         : machine.handle(step.event, step.reason);
+        TEST_ASSERT_EQUAL_MESSAGE(static_cast<int>(step.expectedAction), static_cast<int>(action),
+                                  NetworkStateMachine::eventName(step.event));
+        TEST_ASSERT_EQUAL_MESSAGE(static_cast<int>(step.expectedState), static_cast<int>(machine.getState()),
+                                  NetworkStateMachine::stateName(step.expectedState));
+        if (step.armTimer) {
+            machine.armTimer(step.now, step.armTimer);
+        }
+    }
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_boot_and_connect() {
+    const TraceStep trace[] = {
+        {0,   E::START_STA, 0, A::BEGIN_CONNECT, S::CONNECTING, 10000},
+        {150, E::NONE,      0, A::NONE,          S::CONNECTING, 0},
+        {420, E::GOT_IP,    0, A::ON_CONNECTED,  S::CONNECTED,  0},
+    };
+    replay(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_boot_without_credentials() {
+    const TraceStep trace[] = {
+        {0,    E::START_AP,          0, A::START_AP,      S::AP_MODE,    0},
+        {9000, E::DISCONNECTED,      0, A::NONE,          S::AP_MODE,    0},
+        {9500, E::CREDENTIALS_SAVED, 0, A::BEGIN_CONNECT, S::CONNECTING, 10000},
+        {9900, E::GOT_IP,            0, A::ON_CONNECTED,  S::CONNECTED,  0},
+    };
+    replay(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_connect_timeout_then_backoff_retry() {
+    const TraceStep trace[] = {
+        {0,     E::START_STA, 0, A::BEGIN_CONNECT,     S::CONNECTING,        10000},
+        {9999,  E::NONE,      0, A::NONE,              S::CONNECTING,        0},
+        {10000, E::NONE,      0, A::ON_CONNECT_FAILED, S::CONNECTION_FAILED, 700},
+        {10500, E::NONE,      0, A::NONE,              S::CONNECTION_FAILED, 0},
+        {10700, E::NONE,      0, A::BEGIN_CONNECT,     S::CONNECTING,        10000},
+        {11000, E::GOT_IP,    0, A::ON_CONNECTED,      S::CONNECTED,         0},
+    };
+    replay(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_auth_failure_fails_fast() {
+    const TraceStep trace[] = {
+        {0,   E::START_STA,    0,   A::BEGIN_CONNECT,     S::CONNECTING,        10000},
+        {300, E::DISCONNECTED, 202, A::ON_CONNECT_FAILED, S::CONNECTION_FAILED, 0},
+        {300, E::RETRY,        0,   A::BEGIN_CONNECT,     S::CONNECTING,        10000},
+        {600, E::DISCONNECTED, 201, A::ON_CONNECT_FAILED, S::CONNECTION_FAILED, 0},
+        {600, E::GIVE_UP,      0,   A::START_AP,          S::AP_MODE,           0},
+    };
+    replay(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_link_lost_and_recovered() {
+    const TraceStep trace[] = {
+        {0,    E::START_STA,    0, A::BEGIN_CONNECT, S::CONNECTING,        10000},
+        {400,  E::GOT_IP,       0, A::ON_CONNECTED,  S::CONNECTED,         0},
+        {5000, E::DISCONNECTED, 200, A::ON_LINK_LOST, S::CONNECTION_FAILED, 350},
+        {5350, E::NONE,         0, A::BEGIN_CONNECT, S::CONNECTING,        10000},
+        {5600, E::GOT_IP,       0, A::ON_CONNECTED,  S::CONNECTED,         0},
+    };
+    replay(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_dhcp_lease_while_connected() {
+    const TraceStep trace[] = {
+        {0,    E::START_STA, 0, A::BEGIN_CONNECT, S::CONNECTING, 2000},
+        // Joined on the cached lease, then DHCP confirms or replaces it
+        {300,  E::GOT_IP,    0, A::ON_CONNECTED,  S::CONNECTED,  0},
+        {900,  E::GOT_IP,    0, A::ON_LEASE,      S::CONNECTED,  0},
+    };
+    replay(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_fast_connect_timeout_falls_back_to_scan() {
+    const TraceStep trace[] = {
+        // Cached BSSID/channel attempt gets the short timeout
+        {0,    E::START_STA, 0, A::BEGIN_CONNECT,     S::CONNECTING,        2000},
+        {1999, E::NONE,      0, A::NONE,              S::CONNECTING,        0},
+        {2000, E::NONE,      0, A::ON_CONNECT_FAILED, S::CONNECTION_FAILED, 0},
+        // Owner drops the cache and retries the same network with a scan
+        {2000, E::RETRY,     0, A::BEGIN_CONNECT,     S::CONNECTING,        10000},
+        {4000, E::NONE,      0, A::NONE,              S::CONNECTING,        0},
+        {5200, E::GOT_IP,    0, A::ON_CONNECTED,      S::CONNECTED,         0},
+    };
+    replay(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_fast_connect_rejected_falls_back_to_scan() {
+    const TraceStep trace[] = {
+        {0,    E::START_STA,    0,   A::BEGIN_CONNECT,     S::CONNECTING,        2000},
+        // AP no longer on the cached channel
+        {700,  E::DISCONNECTED, 201, A::ON_CONNECT_FAILED, S::CONNECTION_FAILED, 0},
+        {700,  E::RETRY,        0,   A::BEGIN_CONNECT,     S::CONNECTING,        10000},
+        {900,  E::DISCONNECTED, 8,   A::NONE,              S::CONNECTING,        0},
+        {3100, E::GOT_IP,       0,   A::ON_CONNECTED,      S::CONNECTED,         0},
+    };
+    replay(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_own_disconnect_does_not_fail_new_attempt() {
+    const TraceStep trace[] = {
+        {0,    E::START_STA,         0, A::BEGIN_CONNECT, S::CONNECTING, 10000},
+        {400,  E::GOT_IP,            0, A::ON_CONNECTED,  S::CONNECTED,  0},
+        {9000, E::CREDENTIALS_SAVED, 0, A::BEGIN_CONNECT, S::CONNECTING, 10000},
+        // Leaving the old network for the new one
+        {9010, E::DISCONNECTED,      8, A::NONE,          S::CONNECTING, 0},
+        {9600, E::GOT_IP,            0, A::ON_CONNECTED,  S::CONNECTED,  0},
+    };
+    replay(trace, sizeof(trace) / sizeof(trace[0]));
+}
+
+void test_stale_timer_is_disarmed_by_transition() {
+    NetworkStateMachine machine;
+    machine.handle(E::START_STA);
+    machine.armTimer(0, 1000);
+    machine.handle(E::GOT_IP);
+
+    TEST_ASSERT_FALSE(machine.isTimerArmed());
+    TEST_ASSERT_EQUAL(static_cast<int>(A::NONE), static_cast<int>(machine.poll(5000)));
+    TEST_ASSERT_EQUAL(static_cast<int>(S::CONNECTED), static_cast<int>(machine.getState()));
+}
+
+void test_timer_handles_millis_wraparound() {
+    NetworkStateMachine machine;
+    machine.handle(E::START_STA);
+    machine.armTimer(0xFFFFFF00, 0x200);
+
+    TEST_ASSERT_EQUAL(0x180, machine.timeUntilTimeout(0xFFFFFF80));
+    TEST_ASSERT_EQUAL(static_cast<int>(A::NONE), static_cast<int>(machine.poll(0x000000FF)));
+    TEST_ASSERT_EQUAL(static_cast<int>(A::ON_CONNECT_FAILED), static_cast<int>(machine.poll(0x00000100)));
+}
+
+void test_disconnect_reason_is_recorded() {
+    NetworkStateMachine machine;
+    machine.handle(E::START_STA);
+    machine.handle(E::DISCONNECTED, 202);
+
+    TEST_ASSERT_EQUAL(202, machine.getLastReason());
+    TEST_ASSERT_TRUE(NetworkStateMachine::isAuthFailure(202));
+    TEST_ASSERT_FALSE(NetworkStateMachine::isAuthFailure(201));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_boot_and_connect);
+    RUN_TEST(test_boot_without_credentials);
+    RUN_TEST(test_connect_timeout_then_backoff_retry);
+    RUN_TEST(test_auth_failure_fails_fast);
+    RUN_TEST(test_link_lost_and_recovered);
+    RUN_TEST(test_dhcp_lease_while_connected);
+    RUN_TEST(test_fast_connect_timeout_falls_back_to_scan);
+    RUN_TEST(test_fast_connect_rejected_falls_back_to_scan);
+    RUN_TEST(test_own_disconnect_does_not_fail_new_attempt);
+    RUN_TEST(test_stale_timer_is_disarmed_by_transition);
+    RUN_TEST(test_timer_handles_millis_wraparound);
+    RUN_TEST(test_disconnect_reason_is_recorded);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
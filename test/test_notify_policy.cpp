@@ -0,0 +1,136 @@
+#include <unity.h>
+#include "NotifyPolicy.h"
+
+using namespace mcp;
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_default_notifies_every_change() {
+    NotifyPolicy policy;
+    policy.reset("20.0", 0);
+
+    TEST_ASSERT_TRUE(policy.update("20.1", 10));
+    TEST_ASSERT_FALSE(policy.update("20.1", 20));
+    TEST_ASSERT_TRUE(policy.update("20.0", 30));
+}
+
+void test_absolute_deadband() {
+    NotifyPolicy policy({0.5f, false, 0, 0});
+    policy.reset("20.0", 0);
+
+    TEST_ASSERT_FALSE(policy.update("20.3", 10));
+    TEST_ASSERT_FALSE(policy.update("19.6", 20));
+    TEST_ASSERT_TRUE(policy.update("20.5", 30));
+    // Baseline moved to the notified value
+    TEST_ASSERT_FALSE(policy.update("20.8", 40));
+}
+
+void test_slow_drift_eventually_notifies() {
+    NotifyPolicy policy({1.0f, false, 0, 0});
+    policy.reset("10", 0);
+
+    TEST_ASSERT_FALSE(policy.update("10.4", 10));
+    TEST_ASSERT_FALSE(policy.update("10.8", 20));
+    TEST_ASSERT_TRUE(policy.update("11.2", 30));
+}
+
+void test_percent_deadband() {
+    NotifyPolicy policy({5.0f, true, 0, 0});
+    policy.reset("200", 0);
+
+    TEST_ASSERT_FALSE(policy.update("209", 10));
+    TEST_ASSERT_TRUE(policy.update("210", 20));
+}
+
+void test_non_numeric_values_compare_text() {
+    NotifyPolicy policy({100.0f, false, 0, 0});
+    policy.reset("false", 0);
+
+    TEST_ASSERT_FALSE(policy.update("false", 10));
+    TEST_ASSERT_TRUE(policy.update("true", 20));
+}
+
+void test_min_interval_coalesces_changes() {
+    NotifyPolicy policy({0.0f, false, 1000, 0});
+    policy.reset("1", 0);
+
+    TEST_ASSERT_TRUE(policy.update("2", 1000));
+    TEST_ASSERT_FALSE(policy.update("3", 1100));
+    TEST_ASSERT_FALSE(policy.update("4", 1200));
+    TEST_ASSERT_TRUE(policy.isPending());
+
+    TEST_ASSERT_FALSE(policy.poll(1999));
+    TEST_ASSERT_TRUE(policy.poll(2000));
+    TEST_ASSERT_FALSE(policy.isPending());
+    // The coalesced notification carried "4", the latest value
+    TEST_ASSERT_FALSE(policy.update("4", 3100));
+}
+
+void test_reverted_change_cancels_pending() {
+    NotifyPolicy policy({0.5f, false, 1000, 0});
+    policy.reset("20", 0);
+
+    TEST_ASSERT_TRUE(policy.update("21", 1000));
+    TEST_ASSERT_FALSE(policy.update("25", 1100));
+    TEST_ASSERT_TRUE(policy.isPending());
+    TEST_ASSERT_FALSE(policy.update("21.2", 1200));
+
+    TEST_ASSERT_FALSE(policy.isPending());
+    TEST_ASSERT_FALSE(policy.poll(2500));
+}
+
+void test_heartbeat_after_max_interval() {
+    NotifyPolicy policy({1.0f, false, 0, 5000});
+    policy.reset("20", 0);
+
+    TEST_ASSERT_FALSE(policy.poll(4999));
+    TEST_ASSERT_TRUE(policy.poll(5000));
+    TEST_ASSERT_FALSE(policy.poll(9999));
+    // A real notification restarts the heartbeat period
+    TEST_ASSERT_TRUE(policy.update("22", 9000));
+    TEST_ASSERT_FALSE(policy.poll(13999));
+    TEST_ASSERT_TRUE(policy.poll(14000));
+}
+
+void test_intervals_survive_millis_wraparound() {
+    NotifyPolicy policy({0.0f, false, 1000, 0});
+    policy.reset("1", 0xFFFFFF00);
+
+    TEST_ASSERT_FALSE(policy.update("2", 0xFFFFFF80));
+    TEST_ASSERT_FALSE(policy.poll(0x000002E7));
+    TEST_ASSERT_TRUE(policy.poll(0x000002E8));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_default_notifies_every_change);
+    RUN_TEST(test_absolute_deadband);
+    RUN_TEST(test_slow_drift_eventually_notifies);
+    RUN_TEST(test_percent_deadband);
+    RUN_TEST(test_non_numeric_values_compare_text);
+    RUN_TEST(test_min_interval_coalesces_changes);
+    RUN_TEST(test_reverted_change_cancels_pending);
+    RUN_TEST(test_heartbeat_after_max_interval);
+    RUN_TEST(test_intervals_survive_millis_wraparound);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,115 @@
+#include <unity.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "Pagination.h"
+
+using namespace mcp;
+
+using Registry = std::map<std::string, int>;
+
+// Keys of one page; nextCursor is left in cursor ("" when absent)
+static std::vector<int> page(const Registry &registry, const char *after, size_t size, std::string &cursor) {
+    JsonDocument doc;
+    std::vector<int> values;
+    addPage(registry, after, size, doc.to<JsonObject>(), [&](int value) { values.push_back(value); });
+    cursor = doc["nextCursor"].is<const char *>() ? doc["nextCursor"].as<const char *>() : "";
+    return values;
+}
+
+static Registry letters() {
+    return Registry{{"a", 1}, {"b", 2}, {"c", 3}, {"d", 4}, {"e", 5}};
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_pages_cover_registry_in_order() {
+    Registry registry = letters();
+    std::string cursor;
+
+    std::vector<int> first = page(registry, nullptr, 2, cursor);
+    TEST_ASSERT_EQUAL(2, first.size());
+    TEST_ASSERT_EQUAL(1, first[0]);
+    TEST_ASSERT_EQUAL_STRING("b", cursor.c_str());
+
+    std::vector<int> second = page(registry, cursor.c_str(), 2, cursor);
+    TEST_ASSERT_EQUAL(3, second[0]);
+    TEST_ASSERT_EQUAL_STRING("d", cursor.c_str());
+}
+
+void test_last_page_has_no_cursor() {
+    Registry registry = letters();
+    std::string cursor;
+
+    std::vector<int> last = page(registry, "d", 2, cursor);
+    TEST_ASSERT_EQUAL(1, last.size());
+    TEST_ASSERT_EQUAL(5, last[0]);
+    TEST_ASSERT_EQUAL_STRING("", cursor.c_str());
+
+    // A page that ends exactly at the last entry does not promise more
+    std::vector<int> exact = page(registry, "c", 2, cursor);
+    TEST_ASSERT_EQUAL(2, exact.size());
+    TEST_ASSERT_EQUAL_STRING("", cursor.c_str());
+}
+
+void test_unknown_cursor_resumes_after_its_position() {
+    Registry registry = letters();
+    std::string cursor;
+
+    std::vector<int> middle = page(registry, "bb", 2, cursor);
+    TEST_ASSERT_EQUAL(2, middle.size());
+    TEST_ASSERT_EQUAL(3, middle[0]);
+
+    TEST_ASSERT_EQUAL(0, page(registry, "zzz", 2, cursor).size());
+    TEST_ASSERT_EQUAL_STRING("", cursor.c_str());
+
+    std::vector<int> empty = page(registry, "", 2, cursor);
+    TEST_ASSERT_EQUAL(1, empty[0]);
+}
+
+void test_registry_changing_between_pages() {
+    Registry registry = letters();
+    std::string cursor;
+    page(registry, nullptr, 2, cursor);  // a, b
+
+    // Added before the cursor: not sent again; after it: picked up.
+    // Removing the cursor's own entry does not lose the position.
+    registry["aa"] = 10;
+    registry["ca"] = 11;
+    registry.erase("b");
+
+    std::vector<int> next = page(registry, cursor.c_str(), 2, cursor);
+    TEST_ASSERT_EQUAL(2, next.size());
+    TEST_ASSERT_EQUAL(3, next[0]);
+    TEST_ASSERT_EQUAL(11, next[1]);
+    TEST_ASSERT_EQUAL_STRING("ca", cursor.c_str());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_pages_cover_registry_in_order);
+    RUN_TEST(test_last_page_has_no_cursor);
+    RUN_TEST(test_unknown_cursor_resumes_after_its_position);
+    RUN_TEST(test_registry_changing_between_pages);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,144 @@
+#include <unity.h>
+#include "ReconnectPolicy.h"
+
+using namespace mcp;
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_backoff_window_doubles_up_to_cap() {
+    ExponentialBackoff backoff(500, 4000);
+
+    TEST_ASSERT_EQUAL(500, backoff.window());
+    backoff.next(0);
+    TEST_ASSERT_EQUAL(1000, backoff.window());
+    backoff.next(0);
+    TEST_ASSERT_EQUAL(2000, backoff.window());
+    backoff.next(0);
+    TEST_ASSERT_EQUAL(4000, backoff.window());
+    backoff.next(0);
+    TEST_ASSERT_EQUAL(4000, backoff.window());
+}
+
+void test_backoff_delay_is_within_window() {
+    ExponentialBackoff backoff(500, 60000);
+
+    for (uint32_t i = 0; i < 40; i++) {
+        uint32_t window = backoff.window();
+        uint32_t delay = backoff.next(0xFFFFFFFF - i * 7919);
+        TEST_ASSERT_LESS_OR_EQUAL(window, delay);
+    }
+    TEST_ASSERT_EQUAL(40, backoff.attempts());
+}
+
+void test_backoff_jitter_spreads_delays() {
+    ExponentialBackoff a(500, 60000);
+    ExponentialBackoff b(500, 60000);
+    for (int i = 0; i < 5; i++) {
+        a.next(0);
+        b.next(0);
+    }
+
+    // Same attempt, different random draws: devices do not retry in lockstep
+    TEST_ASSERT_TRUE(a.next(1234) != b.next(98765));
+}
+
+void test_backoff_reset() {
+    ExponentialBackoff backoff(500, 60000);
+    backoff.next(0);
+    backoff.next(0);
+    backoff.reset();
+
+    TEST_ASSERT_EQUAL(0, backoff.attempts());
+    TEST_ASSERT_EQUAL(500, backoff.window());
+}
+
+void test_unknown_credential_scores_neutral() {
+    CredentialRanker ranker;
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.5f, ranker.score(0));
+}
+
+void test_rssi_ewma() {
+    CredentialRanker ranker;
+    ranker.recordRssi(0, -60);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -60.0f, ranker.getStats(0).rssi);
+
+    ranker.recordRssi(0, -80);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -64.0f, ranker.getStats(0).rssi);
+
+    // 0 dBm is reported while not associated and must be ignored
+    ranker.recordRssi(0, 0);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -64.0f, ranker.getStats(0).rssi);
+}
+
+void test_rank_prefers_strong_reliable_network() {
+    CredentialRanker ranker;
+    bool used[CredentialRanker::MAX_CREDENTIALS] = {true, true, true, false};
+    uint8_t order[CredentialRanker::MAX_CREDENTIALS];
+
+    // Slot 0: weak and flaky; slot 1: strong and reliable; slot 2: unknown
+    ranker.recordRssi(0, -85);
+    ranker.recordFailure(0);
+    ranker.recordFailure(0);
+    ranker.recordRssi(1, -50);
+    ranker.recordSuccess(1);
+
+    TEST_ASSERT_EQUAL(3, ranker.rank(used, order));
+    TEST_ASSERT_EQUAL(1, order[0]);
+    TEST_ASSERT_EQUAL(2, order[1]);
+    TEST_ASSERT_EQUAL(0, order[2]);
+}
+
+void test_rank_ties_keep_slot_order() {
+    CredentialRanker ranker;
+    bool used[CredentialRanker::MAX_CREDENTIALS] = {true, true, false, true};
+    uint8_t order[CredentialRanker::MAX_CREDENTIALS];
+
+    TEST_ASSERT_EQUAL(3, ranker.rank(used, order));
+    TEST_ASSERT_EQUAL(0, order[0]);
+    TEST_ASSERT_EQUAL(1, order[1]);
+    TEST_ASSERT_EQUAL(3, order[2]);
+}
+
+void test_history_is_trimmed() {
+    CredentialRanker ranker;
+    for (int i = 0; i < 1200; i++) {
+        ranker.recordSuccess(0);
+    }
+
+    TEST_ASSERT_LESS_OR_EQUAL(CredentialRanker::MAX_HISTORY, ranker.getStats(0).successes);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_backoff_window_doubles_up_to_cap);
+    RUN_TEST(test_backoff_delay_is_within_window);
+    RUN_TEST(test_backoff_jitter_spreads_delays);
+    RUN_TEST(test_backoff_reset);
+    RUN_TEST(test_unknown_credential_scores_neutral);
+    RUN_TEST(test_rssi_ewma);
+    RUN_TEST(test_rank_prefers_strong_reliable_network);
+    RUN_TEST(test_rank_ties_keep_slot_order);
+    RUN_TEST(test_history_is_trimmed);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
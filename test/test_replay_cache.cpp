@@ -0,0 +1,145 @@
+#include <unity.h>
+#include <string.h>
+#include "ReplayCache.h"
+
+using namespace mcp;
+
+static bool storeText(ReplayCache &cache, const RequestId &id, const char *text) {
+    return cache.store(id, text, strlen(text));
+}
+
+static RequestId stringId(const char *text) {
+    return RequestId(text, strlen(text));
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_find_returns_stored_response() {
+    ReplayCache cache(64);
+    TEST_ASSERT_TRUE(storeText(cache, RequestId(7), "{\"id\":7}"));
+
+    const std::string *response = cache.find(RequestId(7));
+    TEST_ASSERT_NOT_NULL(response);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":7}", response->c_str());
+    TEST_ASSERT_NULL(cache.find(RequestId(8)));
+}
+
+void test_evicts_least_recently_used_within_budget() {
+    ReplayCache cache(30);
+    storeText(cache, RequestId(1), "aaaaaaaaaa");
+    storeText(cache, RequestId(2), "bbbbbbbbbb");
+    storeText(cache, RequestId(3), "cccccccccc");
+    TEST_ASSERT_EQUAL(30, cache.bytes());
+
+    cache.find(RequestId(1)); // 2 is now least recently used
+    storeText(cache, RequestId(4), "dddddddddd");
+
+    TEST_ASSERT_NOT_NULL(cache.find(RequestId(1)));
+    TEST_ASSERT_NULL(cache.find(RequestId(2)));
+    TEST_ASSERT_NOT_NULL(cache.find(RequestId(3)));
+    TEST_ASSERT_NOT_NULL(cache.find(RequestId(4)));
+    TEST_ASSERT_EQUAL(30, cache.bytes());
+}
+
+void test_oversized_response_is_not_kept() {
+    ReplayCache cache(8);
+    storeText(cache, RequestId(1), "small");
+
+    TEST_ASSERT_FALSE(storeText(cache, RequestId(2), "far too large"));
+    TEST_ASSERT_NULL(cache.find(RequestId(2)));
+    TEST_ASSERT_NOT_NULL(cache.find(RequestId(1)));
+}
+
+void test_storing_same_id_replaces() {
+    ReplayCache cache(64);
+    storeText(cache, RequestId(5), "first");
+    storeText(cache, RequestId(5), "second");
+
+    TEST_ASSERT_EQUAL(1, cache.size());
+    TEST_ASSERT_EQUAL(6, cache.bytes());
+    TEST_ASSERT_EQUAL_STRING("second", cache.find(RequestId(5))->c_str());
+}
+
+void test_shrinking_budget_evicts() {
+    ReplayCache cache(64);
+    storeText(cache, RequestId(1), "0123456789");
+    storeText(cache, RequestId(2), "0123456789");
+
+    cache.setBudget(15);
+    TEST_ASSERT_EQUAL(1, cache.size());
+    TEST_ASSERT_NOT_NULL(cache.find(RequestId(2)));
+}
+
+void test_clear_empties() {
+    ReplayCache cache(64);
+    storeText(cache, RequestId(1), "x");
+    cache.clear();
+
+    TEST_ASSERT_EQUAL(0, cache.size());
+    TEST_ASSERT_EQUAL(0, cache.bytes());
+    TEST_ASSERT_NULL(cache.find(RequestId(1)));
+}
+
+void test_string_ids_are_distinct() {
+    ReplayCache cache(128);
+    storeText(cache, stringId("req-a"), "{\"id\":\"req-a\"}");
+    storeText(cache, stringId("req-b"), "{\"id\":\"req-b\"}");
+
+    TEST_ASSERT_EQUAL(2, cache.size());
+    TEST_ASSERT_EQUAL_STRING("{\"id\":\"req-a\"}", cache.find(stringId("req-a"))->c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"id\":\"req-b\"}", cache.find(stringId("req-b"))->c_str());
+    TEST_ASSERT_NULL(cache.find(stringId("req-c")));
+}
+
+void test_ids_compare_by_type_and_full_value() {
+    ReplayCache cache(128);
+    storeText(cache, RequestId(1), "number");
+    storeText(cache, RequestId(int64_t(1) << 32 | 1), "wide");
+
+    TEST_ASSERT_NULL(cache.find(stringId("1")));
+    TEST_ASSERT_NULL(cache.find(RequestId()));
+    TEST_ASSERT_EQUAL_STRING("number", cache.find(RequestId(1))->c_str());
+    TEST_ASSERT_EQUAL_STRING("wide", cache.find(RequestId(int64_t(1) << 32 | 1))->c_str());
+}
+
+void test_overlong_string_id_is_invalid() {
+    char text[RequestId::MAX_LENGTH + 2];
+    memset(text, 'x', sizeof(text));
+
+    TEST_ASSERT_TRUE(RequestId(text, RequestId::MAX_LENGTH).isValid());
+    TEST_ASSERT_FALSE(RequestId(text, RequestId::MAX_LENGTH + 1).isValid());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_find_returns_stored_response);
+    RUN_TEST(test_evicts_least_recently_used_within_budget);
+    RUN_TEST(test_oversized_response_is_not_kept);
+    RUN_TEST(test_storing_same_id_replaces);
+    RUN_TEST(test_shrinking_budget_evicts);
+    RUN_TEST(test_clear_empties);
+    RUN_TEST(test_string_ids_are_distinct);
+    RUN_TEST(test_ids_compare_by_type_and_full_value);
+    RUN_TEST(test_overlong_string_id_is_invalid);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,73 @@
+#include <unity.h>
+#include <LittleFS.h>
+#include "MetricsSystem.h"
+#include "RequestTracer.h"
+
+using namespace mcp;
+
+// A trace that went through every phase
+static RequestTrace finishedTrace(const char* method, MCPRequestType type) {
+    RequestTrace trace;
+    trace.begin(0);
+    trace.setMethod(method, type);
+    for (size_t i = 1; i < RequestTrace::PHASE_COUNT; i++) {
+        delayMicroseconds(10);
+        trace.mark(static_cast<TracePhase>(i));
+    }
+    return trace;
+}
+
+void setUp(void) {
+    LittleFS.begin(true);
+    MetricsSystem::getInstance().begin();
+}
+
+void tearDown(void) {
+    MetricsSystem::getInstance().end();
+}
+
+void test_known_method_gets_its_histograms() {
+    RequestTracer::getInstance().complete(finishedTrace("tools/call", MCPRequestType::TOOLS_CALL));
+
+    TEST_ASSERT_TRUE(MetricsSystem::getInstance().hasMetric("mcp.tools_call.handler"));
+    TEST_ASSERT_TRUE(MetricsSystem::getInstance().hasMetric("mcp.tools_call.total"));
+}
+
+void test_unknown_methods_share_other_bucket() {
+    MetricsSystem& metrics = MetricsSystem::getInstance();
+    size_t before = metrics.getMetrics().size();
+
+    // Client-chosen names must not reach the registry
+    char method[16];
+    for (int i = 0; i < 20; i++) {
+        snprintf(method, sizeof(method), "made/up%d", i);
+        RequestTracer::getInstance().complete(finishedTrace(method, MCPRequestType::UNKNOWN));
+    }
+
+    TEST_ASSERT_TRUE(metrics.hasMetric("mcp.other.total"));
+    TEST_ASSERT_FALSE(metrics.hasMetric("mcp.made_up0.total"));
+    TEST_ASSERT_TRUE(metrics.getMetrics().size() <= before + RequestTracer::STAGE_COUNT);
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_known_method_gets_its_histograms);
+    RUN_TEST(test_unknown_methods_share_other_bucket);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,138 @@
+#include <unity.h>
+#include <string.h>
+#include "SessionTable.h"
+
+using namespace mcp;
+
+class FakeTransport : public Transport {
+public:
+    const char *name() const override { return "fake"; }
+    bool begin() override { return true; }
+    bool send(uint32_t, const char *, size_t) override { return true; }
+    void close(uint32_t) override {}
+};
+
+static FakeTransport ws;
+static FakeTransport tcp;
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_open_assigns_lowest_free_slot() {
+    SessionTable table;
+
+    TEST_ASSERT_EQUAL(0, table.open(&ws, 100, 0));
+    TEST_ASSERT_EQUAL(1, table.open(&tcp, 100, 0));
+    TEST_ASSERT_EQUAL(2, table.active());
+
+    table.close(0);
+    TEST_ASSERT_EQUAL(0, table.open(&ws, 101, 0));
+}
+
+void test_full_table_refuses() {
+    SessionTable table;
+    for (uint32_t i = 0; i < SessionTable::CAPACITY; i++) {
+        TEST_ASSERT_EQUAL(i, table.open(&ws, i + 1, 0));
+    }
+
+    TEST_ASSERT_EQUAL(SessionTable::NONE, table.open(&ws, 99, 0));
+}
+
+void test_find_by_transport_and_connection() {
+    SessionTable table;
+    table.open(&ws, 7, 0);
+    table.open(&tcp, 7, 0);
+
+    TEST_ASSERT_EQUAL(0, table.find(&ws, 7));
+    TEST_ASSERT_EQUAL(1, table.find(&tcp, 7));
+    TEST_ASSERT_EQUAL(SessionTable::NONE, table.find(&ws, 8));
+}
+
+void test_get_only_bound_slots() {
+    SessionTable table;
+    table.open(&ws, 1, 0);
+
+    TEST_ASSERT_NOT_NULL(table.get(0));
+    TEST_ASSERT_NULL(table.get(1));
+    TEST_ASSERT_NULL(table.get(SessionTable::CAPACITY));
+}
+
+void test_close_reclaims_all_state() {
+    SessionTable table;
+    int id = table.open(&ws, 1, 0);
+    Session *session = table.get(id);
+    session->initialized = true;
+    session->encoding = Encoding::MSGPACK;
+    session->compress = true;
+    strcpy(session->protocolVersion, "2024-11-05");
+    session->requests = 5;
+    session->subscribe("led://status");
+    session->replay.store(RequestId(1), "{}", 2);
+
+    table.close(id);
+    id = table.open(&ws, 2, 0);
+    session = table.get(id);
+
+    TEST_ASSERT_FALSE(session->initialized);
+    TEST_ASSERT_TRUE(session->encoding == Encoding::JSON);
+    TEST_ASSERT_FALSE(session->compress);
+    TEST_ASSERT_EQUAL_STRING("", session->protocolVersion);
+    TEST_ASSERT_EQUAL(0, session->requests);
+    TEST_ASSERT_EQUAL(0, session->subscriptions.size());
+    TEST_ASSERT_NULL(session->replay.find(RequestId(1)));
+}
+
+void test_subscriptions() {
+    Session session;
+
+    TEST_ASSERT_TRUE(session.subscribe("b://x"));
+    TEST_ASSERT_TRUE(session.subscribe("a://x"));
+    TEST_ASSERT_FALSE(session.subscribe("b://x"));
+    TEST_ASSERT_TRUE(session.isSubscribed("a://x"));
+    TEST_ASSERT_FALSE(session.isSubscribed("c://x"));
+
+    TEST_ASSERT_TRUE(session.unsubscribe("a://x"));
+    TEST_ASSERT_FALSE(session.unsubscribe("a://x"));
+    TEST_ASSERT_EQUAL(1, session.subscriptions.size());
+}
+
+void test_replay_budget_survives_reclaim() {
+    SessionTable table;
+    table.setReplayBudget(4);
+    int id = table.open(&ws, 1, 0);
+    table.close(id);
+    id = table.open(&ws, 2, 0);
+
+    TEST_ASSERT_FALSE(table.get(id)->replay.store(RequestId(1), "too long", 8));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_open_assigns_lowest_free_slot);
+    RUN_TEST(test_full_table_refuses);
+    RUN_TEST(test_find_by_transport_and_connection);
+    RUN_TEST(test_get_only_bound_slots);
+    RUN_TEST(test_close_reclaims_all_state);
+    RUN_TEST(test_subscriptions);
+    RUN_TEST(test_replay_budget_survives_reclaim);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,61 @@
+#include <unity.h>
+#include "StaticAssets.h"
+
+using namespace mcp;
+
+static const String ETAG = "\"3f2a9c1d\"";
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_exact_etag_is_not_modified() {
+    TEST_ASSERT_TRUE(StaticAssets::matchesEtag("\"3f2a9c1d\"", ETAG));
+    TEST_ASSERT_TRUE(StaticAssets::matchesEtag("  \"3f2a9c1d\" ", ETAG));
+}
+
+void test_etag_list_and_weak_tags() {
+    TEST_ASSERT_TRUE(StaticAssets::matchesEtag("\"old\", \"3f2a9c1d\"", ETAG));
+    TEST_ASSERT_TRUE(StaticAssets::matchesEtag("\"old\",W/\"3f2a9c1d\"", ETAG));
+    TEST_ASSERT_TRUE(StaticAssets::matchesEtag("*", ETAG));
+}
+
+void test_other_etag_is_served() {
+    TEST_ASSERT_FALSE(StaticAssets::matchesEtag("\"old\"", ETAG));
+    TEST_ASSERT_FALSE(StaticAssets::matchesEtag("\"x3f2a9c1d\"", ETAG));
+    TEST_ASSERT_FALSE(StaticAssets::matchesEtag("3f2a9c1d", ETAG));
+    TEST_ASSERT_FALSE(StaticAssets::matchesEtag("", ETAG));
+}
+
+void test_unstaged_asset_never_matches() {
+    // Without a manifest assets carry no ETag and are always sent in full
+    TEST_ASSERT_FALSE(StaticAssets::matchesEtag("*", ""));
+    TEST_ASSERT_FALSE(StaticAssets::matchesEtag("\"\"", ""));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_exact_etag_is_not_modified);
+    RUN_TEST(test_etag_list_and_weak_tags);
+    RUN_TEST(test_other_etag_is_served);
+    RUN_TEST(test_unstaged_asset_never_matches);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
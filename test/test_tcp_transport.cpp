@@ -0,0 +1,98 @@
+#include <unity.h>
+#include <WiFi.h>
+#include "MCPServer.h"
+#include "TcpTransport.h"
+
+using namespace mcp;
+
+// On-device test: connects to the transport over the loopback interface
+static const uint16_t PORT = 9100;
+static MCPServer server(PORT);
+static TcpTransport transport(PORT);
+
+// Wait until the transport has accepted a connection (send() succeeds)
+static bool waitAccepted(uint32_t id) {
+    uint32_t start = millis();
+    while (millis() - start < 1000) {
+        if (transport.send(id, "{}", 2)) {
+            return true;
+        }
+        delay(10);
+    }
+    return false;
+}
+
+// Wait until the peer has seen the connection end
+static bool waitClosed(WiFiClient& client) {
+    uint32_t start = millis();
+    while (millis() - start < 1000) {
+        while (client.available()) {
+            client.read();
+        }
+        if (!client.connected()) {
+            return true;
+        }
+        delay(10);
+    }
+    return false;
+}
+
+void setUp(void) {
+    static bool started = false;
+    if (!started) {
+        WiFi.mode(WIFI_STA);  // Brings up the TCP/IP stack
+        server.addTransport(&transport);
+        server.begin(true);
+        started = true;
+    }
+}
+
+void tearDown(void) {
+}
+
+void test_close_live_connection() {
+    WiFiClient client;
+    TEST_ASSERT_TRUE(client.connect(IPAddress(127, 0, 0, 1), PORT));
+    TEST_ASSERT_TRUE(waitAccepted(1));  // Ids are handed out in order
+
+    // AsyncClient::close() runs the disconnect callback in this call
+    transport.close(1);
+
+    TEST_ASSERT_FALSE(transport.send(1, "{}", 2));
+    TEST_ASSERT_TRUE(waitClosed(client));
+}
+
+void test_close_twice_is_harmless() {
+    WiFiClient client;
+    TEST_ASSERT_TRUE(client.connect(IPAddress(127, 0, 0, 1), PORT));
+    TEST_ASSERT_TRUE(waitAccepted(2));
+
+    transport.close(2);
+    transport.close(2);
+
+    TEST_ASSERT_FALSE(transport.send(2, "{}", 2));
+    TEST_ASSERT_TRUE(waitClosed(client));
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_close_live_connection);
+    RUN_TEST(test_close_twice_is_harmless);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,122 @@
+#include <unity.h>
+#include "UriTemplate.h"
+
+using namespace mcp;
+
+static UriTemplateMatcher* matcher = nullptr;
+static UriParams params;
+
+void setUp(void) {
+    matcher = new UriTemplateMatcher();
+    params.clear();
+}
+
+void tearDown(void) {
+    delete matcher;
+}
+
+void test_captures_variables() {
+    int id = matcher->add("sensor://{bus}/{addr}/temperature");
+    TEST_ASSERT_EQUAL(0, id);
+
+    TEST_ASSERT_EQUAL(id, matcher->match("sensor://i2c0/0x48/temperature", params));
+    TEST_ASSERT_EQUAL_STRING("i2c0", params["bus"].c_str());
+    TEST_ASSERT_EQUAL_STRING("0x48", params["addr"].c_str());
+}
+
+void test_rejects_non_matching_uris() {
+    matcher->add("sensor://{bus}/{addr}/temperature");
+
+    TEST_ASSERT_EQUAL(UriTemplateMatcher::NO_MATCH, matcher->match("sensor://i2c0/0x48/humidity", params));
+    TEST_ASSERT_EQUAL(UriTemplateMatcher::NO_MATCH, matcher->match("sensor://i2c0/temperature", params));
+    TEST_ASSERT_EQUAL(UriTemplateMatcher::NO_MATCH, matcher->match("sensor://i2c0/0x48/temperature/x", params));
+    // Variables do not match empty segments
+    TEST_ASSERT_EQUAL(UriTemplateMatcher::NO_MATCH, matcher->match("sensor:///0x48/temperature", params));
+}
+
+void test_integer_capture() {
+    int id = matcher->add("gpio://{pin:int}");
+
+    TEST_ASSERT_EQUAL(id, matcher->match("gpio://13", params));
+    TEST_ASSERT_EQUAL_STRING("13", params["pin"].c_str());
+    TEST_ASSERT_EQUAL(UriTemplateMatcher::NO_MATCH, matcher->match("gpio://13a", params));
+    TEST_ASSERT_EQUAL(UriTemplateMatcher::NO_MATCH, matcher->match("gpio://", params));
+}
+
+void test_most_specific_segment_wins() {
+    int text = matcher->add("led://{name}");
+    int number = matcher->add("led://{index:int}");
+    int literal = matcher->add("led://all");
+
+    TEST_ASSERT_EQUAL(literal, matcher->match("led://all", params));
+    TEST_ASSERT_EQUAL(number, matcher->match("led://3", params));
+    TEST_ASSERT_EQUAL_STRING("3", params["index"].c_str());
+    TEST_ASSERT_EQUAL(text, matcher->match("led://status", params));
+    TEST_ASSERT_EQUAL_STRING("status", params["name"].c_str());
+}
+
+void test_backtracks_out_of_dead_end() {
+    int specific = matcher->add("fs://logs/{file}/size");
+    int general = matcher->add("fs://{dir}/{file}/lines");
+
+    TEST_ASSERT_EQUAL(specific, matcher->match("fs://logs/boot.log/size", params));
+    // "logs" takes the literal branch first, which has no "lines"
+    TEST_ASSERT_EQUAL(general, matcher->match("fs://logs/boot.log/lines", params));
+    TEST_ASSERT_EQUAL_STRING("logs", params["dir"].c_str());
+    TEST_ASSERT_EQUAL_STRING("boot.log", params["file"].c_str());
+    TEST_ASSERT_EQUAL(2u, params.size());
+}
+
+void test_malformed_templates_are_rejected() {
+    TEST_ASSERT_EQUAL(UriTemplateMatcher::NO_MATCH, matcher->add("sensor://{bus"));
+    TEST_ASSERT_EQUAL(UriTemplateMatcher::NO_MATCH, matcher->add("sensor://{}"));
+    TEST_ASSERT_EQUAL(UriTemplateMatcher::NO_MATCH, matcher->add("sensor://x{bus}"));
+    TEST_ASSERT_EQUAL(UriTemplateMatcher::NO_MATCH, matcher->add("sensor://{bus:float}"));
+    TEST_ASSERT_EQUAL(UriTemplateMatcher::NO_MATCH, matcher->add("sensor://{a}/{a}"));
+    TEST_ASSERT_EQUAL(0u, matcher->size());
+}
+
+void test_duplicates() {
+    int id = matcher->add("sensor://{bus}");
+    TEST_ASSERT_EQUAL(id, matcher->add("sensor://{bus}"));
+    // Same shape under another name would be ambiguous
+    TEST_ASSERT_EQUAL(UriTemplateMatcher::NO_MATCH, matcher->add("sensor://{port}"));
+    TEST_ASSERT_EQUAL(1u, matcher->size());
+}
+
+void test_many_templates() {
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_EQUAL(i, matcher->add("dev" + std::to_string(i) + "://{channel:int}/value"));
+    }
+    TEST_ASSERT_EQUAL(57, matcher->match("dev57://4/value", params));
+    TEST_ASSERT_EQUAL_STRING("4", params["channel"].c_str());
+}
+
+int runUnityTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_captures_variables);
+    RUN_TEST(test_rejects_non_matching_uris);
+    RUN_TEST(test_integer_capture);
+    RUN_TEST(test_most_specific_segment_wins);
+    RUN_TEST(test_backtracks_out_of_dead_end);
+    RUN_TEST(test_malformed_templates_are_rejected);
+    RUN_TEST(test_duplicates);
+    RUN_TEST(test_many_templates);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);
+    runUnityTests();
+}
+
+void loop() {
+}
+#else
+int main() {
+    return runUnityTests();
+}
+#endif